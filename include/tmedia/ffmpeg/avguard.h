@@ -18,5 +18,6 @@ extern "C" {
 #define USE_AV_REGISTER_ALL LIBAVFORMAT_VERSION_INT < AV_VERSION_INT(58, 9, 100)
 #define USE_AVCODEC_REGISTER_ALL LIBAVCODEC_VERSION_INT < AV_VERSION_INT(58, 10, 100)
 #define AVFORMAT_CONST_AVIOFORMAT LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(59, 0, 100)
+#define HAS_AVFORMAT_INDEX_GET_ENTRY LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100)
 
 #endif
\ No newline at end of file
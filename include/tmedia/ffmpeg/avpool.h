@@ -0,0 +1,78 @@
+#ifndef TMEDIA_AV_POOL_H
+#define TMEDIA_AV_POOL_H
+
+#include <vector>
+#include <mutex>
+
+extern "C" {
+  #include <libavcodec/avcodec.h>
+  #include <libavutil/frame.h>
+}
+
+/**
+ * Thread-safe free lists of AVPacket and AVFrame objects.
+ * 
+ * Released objects are unreferenced and kept for reuse instead of freed, so
+ * that once playback reaches a steady state, no AVPacket or AVFrame structs
+ * are allocated per packet or frame anymore. The data buffers referenced by
+ * packets and frames are still managed by FFmpeg's own buffer pools.
+ * 
+ * Every object acquired from a pool must be released back into the same pool
+ * before the pool is destroyed.
+*/
+
+class AVPacketPool {
+  private:
+    std::mutex mutex;
+    std::vector<AVPacket*> free_packets;
+
+  public:
+    AVPacketPool() = default;
+    AVPacketPool(const AVPacketPool& pool) = delete;
+    AVPacketPool& operator=(const AVPacketPool& pool) = delete;
+
+    /**
+     * Returns a blank AVPacket, reusing a released packet when available.
+     * throws ffmpeg_error if a new packet could not be allocated
+    */
+    AVPacket* acquire();
+
+    /**
+     * Unreferences the packet and keeps it for reuse. No-op if packet is null
+    */
+    void release(AVPacket* packet) noexcept;
+
+    ~AVPacketPool();
+};
+
+class AVFramePool {
+  private:
+    std::mutex mutex;
+    std::vector<AVFrame*> free_frames;
+
+  public:
+    AVFramePool() = default;
+    AVFramePool(const AVFramePool& pool) = delete;
+    AVFramePool& operator=(const AVFramePool& pool) = delete;
+
+    /**
+     * Returns a blank AVFrame, reusing a released frame when available.
+     * throws ffmpeg_error if a new frame could not be allocated
+    */
+    AVFrame* acquire();
+
+    /**
+     * Unreferences the frame and keeps it for reuse. No-op if frame is null
+    */
+    void release(AVFrame* frame) noexcept;
+
+    /**
+     * Releases every frame in frames, leaving frames empty. The capacity of
+     * frames is kept, so the same vector can be reused between decodes.
+    */
+    void release(std::vector<AVFrame*>& frames) noexcept;
+
+    ~AVFramePool();
+};
+
+#endif
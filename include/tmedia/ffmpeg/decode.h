@@ -11,6 +11,8 @@
  * @copyright Copyright (c) 2023
  */
 
+#include <tmedia/ffmpeg/avpool.h>
+
 #include <vector>
 #include <deque>
 
@@ -23,65 +25,51 @@ extern "C" {
 
 
 /**
- * Clears the AVFrame vector of all it's contents and frees all AVFrame's
- * contained within
- * 
- * @param frame_list 
- * @return void
- */
-void clear_avframe_list(std::vector<AVFrame*>& frame_list);
-
-/**
- * Decode a single video packet given an AVCodecContext
- * 
- * throws ffmpeg_error if any error is detected while decoding the
- * given audio packet, including EAGAIN.
+ * Decode a single packet given an AVCodecContext, appending every decoded
+ * frame onto frames.
  * 
- * Note that while EAGAIN may be thrown in an ffmpeg_error from this function,
- * this only means that the next video AVPacket must be inputted on the next
- * call to decode_video_packet.
+ * Frames are received directly into AVFrames acquired from frame_pool, and
+ * should be released back into frame_pool once the caller is done with them.
+ * Frames already in frames before the call are left untouched.
  * 
- * Note that while a vector is returned, there should really only be one
- * AVFrame video packet returned if no error is thrown.
+ * @returns 0 if frames were decoded, AVERROR(EAGAIN) if the decoder needs
+ * more packets before it can output a frame, or another negative AVERROR if
+ * decoding the packet failed. Nothing is appended onto frames on failure.
+ * If receiving fails after some frames were already received, those frames
+ * are kept and 0 is returned, as the error is reported again by the codec
+ * on the next send or receive.
  * 
- * @returns a vector of the decoded video frames from the given video packet
- * 
- * The caller is responsible for handling the returned AVFrame* allocated objects
+ * EAGAIN is a normal decoder state (such as while buffering B-frames), so it
+ * is reported as a status rather than thrown. Only failing to allocate a
+ * frame throws an ffmpeg_error.
 */
-std::vector<AVFrame*> decode_video_packet(AVCodecContext* video_codec_context, AVPacket* video_packet);
+int decode_packet(AVCodecContext* codec_context, AVPacket* packet, AVFramePool& frame_pool, std::vector<AVFrame*>& frames);
 
 /**
- * Decode a single audio packet given an AVCodecContext
- * 
- * throws ffmpeg_error if any error is detected while decoding the
- * given audio packet, including EAGAIN.
- * 
- * Note that while EAGAIN may be thrown in an ffmpeg_error from this function,
- * this only means that the subsequent AVPacket must be inputted on the next
- * call to decode_audio_packet.
+ * Sends the end of the stream to the given AVCodecContext, then appends every
+ * frame the codec still holds onto frames. Frames are acquired from
+ * frame_pool.
  * 
- * @returns a vector of the decoded audio frames from the given audio packet
- * 
- * The caller is responsible for handling the returned AVFrame* allocated objects
+ * @returns 0 if frames were decoded, AVERROR_EOF if the codec held no more
+ * frames, or another negative AVERROR if the codec could not be drained.
+ * The codec must be flushed with avcodec_flush_buffers before it can decode
+ * packets again.
 */
-std::vector<AVFrame*> decode_audio_packet(AVCodecContext* audio_codec_context, AVPacket* audio_packet);
+int drain_decoder(AVCodecContext* codec_context, AVFramePool& frame_pool, std::vector<AVFrame*>& frames);
 
 /**
  * Reads packets from the given packet_queue until there is a successful
- * decoding of frames of type packet_type
+ * decoding of frames of type packet_type, which are appended onto frames
  * 
  * The packets in packet_queue must come from a stream of the type denoted
- * by the packet_type parameter.
- * 
- * Note that while decode_packet_queue can fail if there are unrecoverable
- * decoding errors, decode_packet_queue will just return an empty vector if 
- * the packet_queue is empty or the packet_queue runs out of packets without
- * yielding decoded frames
- * 
- * The frames returned from decode_packet_queue are of the type packet_type
+ * by the packet_type parameter. Every packet taken from packet_queue is
+ * released into pkt_pool, and decoded frames are acquired from frame_pool.
  * 
- * The caller is responsible for handling the returned AVFrame* allocated objects
+ * @returns 0 if frames were decoded, AVERROR(EAGAIN) if the packet_queue ran
+ * out of packets without yielding decoded frames, or another negative
+ * AVERROR if decoding a packet failed. The failed packet is consumed, so
+ * decoding can be retried with the rest of the packet_queue.
 */
-std::vector<AVFrame*> decode_packet_queue(AVCodecContext* codec_context, std::deque<AVPacket*>& packet_queue, enum AVMediaType packet_type);
+int decode_packet_queue(AVCodecContext* codec_context, std::deque<AVPacket*>& packet_queue, enum AVMediaType packet_type, AVPacketPool& pkt_pool, AVFramePool& frame_pool, std::vector<AVFrame*>& frames);
 
 #endif
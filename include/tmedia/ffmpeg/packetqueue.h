@@ -0,0 +1,98 @@
+#ifndef TMEDIA_PACKET_QUEUE_H
+#define TMEDIA_PACKET_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+
+#include <tmedia/ffmpeg/avpool.h>
+
+extern "C" {
+  #include <libavcodec/avcodec.h>
+}
+
+/**
+ * Bounded, blocking queue of AVPacket's used to hand demuxed packets from a
+ * single demuxing thread to the thread decoding a specific stream.
+ *
+ * Every flush of the queue (such as when the demuxer seeks) increments the
+ * queue's serial. Producers pass the serial they last observed when pushing,
+ * and packets pushed with an outdated serial are dropped. Consumers receive the
+ * serial of every popped packet, so that they can tell when their decoder
+ * must be reset.
+ *
+ * There should only be one producer and one consumer for each PacketQueue.
+ * 
+ * Packets dropped or discarded by the queue are released into the queue's
+ * AVPacketPool, which should be the pool the producer acquires packets from.
+*/
+class PacketQueue {
+  private:
+    std::deque<AVPacket*> m_packets;
+    std::shared_ptr<AVPacketPool> m_pkt_pool;
+    std::size_t m_max_packets;
+    int m_serial;
+    bool m_eof;
+    bool m_closed;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    void clear() noexcept; // mutex must be held
+
+  public:
+    PacketQueue(std::size_t max_packets, std::shared_ptr<AVPacketPool> pkt_pool);
+
+    /**
+     * Push a packet onto the back of the queue, waiting at most milliseconds
+     * for space to become available.
+     *
+     * On success, the PacketQueue takes ownership of the packet. If the given
+     * serial is outdated or the queue has been closed, the packet is released
+     * and true is returned, since the packet should not be retried.
+     *
+     * On failure, ownership of the packet remains with the caller.
+    */
+    bool try_push(AVPacket* packet, int serial, int milliseconds);
+
+    /**
+     * Pop a packet from the front of the queue, waiting at most milliseconds
+     * for a packet to become available.
+     *
+     * On success, the caller takes ownership of the returned packet and serial
+     * is set to the serial the packet was pushed with.
+    */
+    bool try_pop(AVPacket*& packet, int& serial, int milliseconds);
+
+    /**
+     * Release all queued packets, clear the end of file flag, and increment the
+     * serial of the queue.
+    */
+    void flush();
+
+    /**
+     * Mark that the producer has no more packets to give for the given serial.
+     * No-op if the serial is outdated.
+    */
+    void set_eof(int serial);
+
+    /**
+     * Releases all queued packets and permanently drops any further pushed
+     * packets. Used once a consumer no longer needs its stream.
+    */
+    void close();
+
+    int get_serial();
+
+    /**
+     * Returns if the producer reached the end of file and every packet has
+     * already been popped.
+    */
+    bool finished();
+
+    ~PacketQueue();
+};
+
+#endif
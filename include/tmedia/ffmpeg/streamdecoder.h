@@ -4,6 +4,8 @@
 #include <vector>
 #include <deque>
 #include <mutex>
+#include <memory>
+#include <tmedia/ffmpeg/avpool.h>
 #include <tmedia/util/defines.h>
 
 extern "C" {
@@ -24,8 +26,9 @@ extern "C" {
  * AVFormatContext which is used to create it.
  * 
  * Note that a StreamDecoder is not responsible for putting the packets needed
- * for decoding into its own packet queue. This is the responsibility of the
- * MediaDecoder class described in tmedia/media/mediadecoder.h
+ * for decoding into its own packet queue. Packets are read by the
+ * MediaDecoder class described in tmedia/media/mediadecoder.h, and given to
+ * the StreamDecoder by MediaFetcher::decode_next_frames
 */
 class StreamDecoder {
   private:
@@ -33,13 +36,56 @@ class StreamDecoder {
     AVStream* stream;
     const AVCodec* decoder;
     AVCodecContext* codec_context;
+    int thread_count; // as requested, before FFmpeg resolves 0 to a count
+    int thread_type; // as requested, before FFmpeg picks what the codec supports
+    bool drained; // sent the end of the stream since the last reset
+    int nb_failed_packets; // consecutive packets which failed to decode, across calls to decode_next
     std::deque<AVPacket*> packet_queue;
     std::mutex queue_mutex; // currently unused
+    std::shared_ptr<AVPacketPool> pkt_pool;
+    AVFramePool frame_pool;
 
   public:
-    StreamDecoder(AVFormatContext* fmt_ctx, enum AVMediaType media_type);
+    /**
+     * thread_count is the number of threads the codec may decode with, where
+     * 0 lets FFmpeg choose based on the number of available cores.
+     * thread_type holds the FF_THREAD_FRAME and FF_THREAD_SLICE flags the
+     * codec may use, where frame threading is preferred if both are given and
+     * the codec supports it.
+     * 
+     * Decoded packets are released into pkt_pool.
+    */
+    StreamDecoder(AVFormatContext* fmt_ctx, enum AVMediaType media_type, int thread_count, int thread_type, std::shared_ptr<AVPacketPool> pkt_pool);
     void reset() noexcept;
-    std::vector<AVFrame*> decode_next();
+
+    /**
+     * Decodes packets from the front of the packet queue until frames are
+     * decoded, appending them onto frames.
+     * 
+     * Returns 0 if frames were decoded, or AVERROR(EAGAIN) if the packet
+     * queue ran out of packets first. Packets which fail to decode are
+     * skipped, and an ffmpeg_error is only thrown once too many packets fail
+     * in a row. Failures are counted across calls, as packets are usually
+     * pushed one at a time, and the count starts over on reset.
+     * 
+     * Decoded frames must be given back through release_frames.
+    */
+    int decode_next(std::vector<AVFrame*>& frames);
+
+    /**
+     * Signals the end of the stream to the codec and appends every frame it
+     * still holds onto frames. Should be called once no more packets will be
+     * pushed, as codecs hold frames back until then (a frame threaded codec
+     * holds up to one frame per thread).
+     * 
+     * Returns 0 if frames were decoded, or AVERROR_EOF if the codec held no
+     * more frames. Packets can only be decoded again after reset.
+    */
+    int drain(std::vector<AVFrame*>& frames);
+
+    TMEDIA_ALWAYS_INLINE inline void release_frames(std::vector<AVFrame*>& frames) noexcept {
+      this->frame_pool.release(frames);
+    }
 
     TMEDIA_ALWAYS_INLINE inline double get_average_frame_rate_sec() const noexcept {
       return av_q2d(this->stream->avg_frame_rate);
@@ -65,10 +111,52 @@ class StreamDecoder {
       return av_q2d(this->stream->time_base);
     }
 
+    TMEDIA_ALWAYS_INLINE inline AVStream* get_stream() const noexcept {
+      return this->stream;
+    }
+
     TMEDIA_ALWAYS_INLINE inline AVCodecContext* get_codec_context() const noexcept {
       return this->codec_context;
     }
     
+    TMEDIA_ALWAYS_INLINE inline int get_thread_count() const noexcept {
+      return this->codec_context->thread_count;
+    }
+
+    /**
+     * Reopens the codec so that frames are decoded at 1/(2^lowres) of the
+     * stream's resolution in each dimension, which skips most of the decoding
+     * work for the discarded detail. lowres is clamped to the maximum the
+     * codec supports, which is 0 for most codecs.
+     * 
+     * The codec's width and height reflect the reduced resolution afterwards.
+     * Should only be called before decoding, as the codec's state is lost.
+    */
+    void set_lowres(int lowres);
+
+    TMEDIA_ALWAYS_INLINE inline int get_lowres() const noexcept {
+      return this->codec_context->lowres;
+    }
+
+    TMEDIA_ALWAYS_INLINE inline int get_max_lowres() const noexcept {
+      return this->decoder->max_lowres;
+    }
+
+    /**
+     * Returns the threading mode FFmpeg chose when opening the codec, being
+     * "frame", "slice", or "none" when decoding on a single thread
+    */
+    const char* get_thread_type_str() const noexcept;
+
+    /**
+     * Set which frames the codec may skip decoding and loop filtering for.
+     * Takes effect from the next decoded packet.
+    */
+    TMEDIA_ALWAYS_INLINE inline void set_discard(enum AVDiscard skip_frame, enum AVDiscard skip_loop_filter) noexcept {
+      this->codec_context->skip_frame = skip_frame;
+      this->codec_context->skip_loop_filter = skip_loop_filter;
+    }
+
     TMEDIA_ALWAYS_INLINE inline bool has_packets() const {
       return !this->packet_queue.empty();
     }
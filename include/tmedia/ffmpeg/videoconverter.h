@@ -4,6 +4,8 @@
 
 #include <tmedia/util/defines.h>
 
+#include <cstdint>
+
 extern "C" {
   #include <libavutil/frame.h>
   #include <libswscale/swscale.h>
@@ -22,6 +24,12 @@ class VideoConverter {
     int m_dst_width;
     int m_dst_height;
     enum AVPixelFormat m_dst_pix_fmt;
+    bool m_row_decimation;
+    int m_src_row_step; // source rows advanced per row read by m_context
+    bool m_luma_only; // only the luma plane of the source is read, as GRAY8
+    bool m_src_full_range;
+
+    void reset_context(); // rebuilds m_context from the current parameters
   public:
     VideoConverter(int dst_width,
             int dst_height,
@@ -33,9 +41,28 @@ class VideoConverter {
     /**
      * 
      * The returned video frame must be freed by the caller with av_frame_free.
+     * 
+     * If the frame's dimensions or pixel format differ from the converter's
+     * source parameters, the converter adopts the frame's parameters first.
     */
     AVFrame* convert_video_frame(AVFrame* original);
 
+    /**
+     * Converts directly into a caller-owned buffer instead of allocating a new
+     * frame. The destination pixel format must be packed (single plane), and
+     * dst must hold at least dst_linesize * get_dst_height() bytes.
+    */
+    void convert_video_frame(AVFrame* original, uint8_t* dst, int dst_linesize);
+
+    /**
+     * When enabled, sources much taller than the destination are decimated
+     * by only reading every nth row, so that scaling does work proportional
+     * to the destination rather than to the source. Rows are skipped without
+     * filtering, trading some aliasing for speed.
+    */
+    void set_row_decimation(bool row_decimation);
+    TMEDIA_ALWAYS_INLINE inline int get_src_row_step() { return this->m_src_row_step; }
+
     TMEDIA_ALWAYS_INLINE inline int get_src_width() { return this->m_src_width; }
     TMEDIA_ALWAYS_INLINE inline int get_src_height() { return this->m_src_height; }
     TMEDIA_ALWAYS_INLINE inline enum AVPixelFormat get_src_pix_fmt() { return this->m_src_pix_fmt; }
@@ -49,6 +76,14 @@ class VideoConverter {
     */
     void reset_dst_size(int dst_width, int dst_height);
 
+    /**
+     * No-op if the destination pixel format is already dst_pix_fmt.
+     * 
+     * Converting 8-bit planar YUV sources to AV_PIX_FMT_GRAY8 only reads and
+     * scales the source's luma plane.
+    */
+    void reset_dst_pix_fmt(enum AVPixelFormat dst_pix_fmt);
+
     ~VideoConverter();
 };
 
@@ -0,0 +1,24 @@
+#ifndef TMEDIA_BOX_FILTER_H
+#define TMEDIA_BOX_FILTER_H
+
+#include <cstdint>
+
+/**
+ * Resizes an image of interleaved 8-bit channels (such as RGB24 or GRAY8)
+ * with a box filter, where every destination pixel is the rounded average of
+ * the block of source pixels it covers.
+ * 
+ * The filter is separable: the source rows covered by a destination row are
+ * first summed into a row of integer accumulators, with SIMD kernels
+ * (AVX2, SSE2 or NEON, whichever the build targets), and then the columns of
+ * the accumulators covered by each destination pixel are summed and divided.
+ * The source columns and rows covered by every destination pixel are
+ * computed once per call with integer math.
+ * 
+ * Destination pixels cover at least one source pixel, so enlarging an image
+ * repeats source pixels.
+*/
+void box_filter(const std::uint8_t* src, int src_width, int src_height, int channels,
+  std::uint8_t* dst, int dst_width, int dst_height);
+
+#endif
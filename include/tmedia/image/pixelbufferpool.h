@@ -0,0 +1,49 @@
+#ifndef TMEDIA_PIXEL_BUFFER_POOL_H
+#define TMEDIA_PIXEL_BUFFER_POOL_H
+
+#include <tmedia/image/color.h>
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Recycles the pixel buffers backing PixelData instances, so that frames
+ * produced at a steady rate and size stop allocating once every buffer in
+ * flight has been created.
+ * 
+ * A buffer is only handed out again once every PixelData referencing it has
+ * been destroyed, so recycled buffers never alter an existing PixelData.
+ * 
+ * Pixel is RGB24 for color buffers or std::uint8_t for gray buffers.
+ * 
+ * Not thread-safe, although the PixelData instances built from acquired
+ * buffers may be shared across threads as usual.
+*/
+template <typename Pixel>
+class PixelBufferPool {
+  private:
+    std::vector<std::shared_ptr<std::vector<Pixel>>> m_buffers;
+    std::size_t m_capacity;
+
+  public:
+    /**
+     * At most capacity buffers are kept for reuse. Buffers acquired while
+     * every kept buffer is in use are not kept.
+    */
+    PixelBufferPool(std::size_t capacity);
+
+    /**
+     * Returns a buffer of exactly nb_pixels pixels, which is not referenced
+     * anywhere else. The contents of the buffer are unspecified.
+    */
+    std::shared_ptr<std::vector<Pixel>> acquire(std::size_t nb_pixels);
+
+    std::size_t size() const noexcept;
+};
+
+extern template class PixelBufferPool<RGB24>;
+extern template class PixelBufferPool<std::uint8_t>;
+
+#endif
@@ -42,14 +42,21 @@ typedef RGB24 FillFunction(int row, int col);
  * to the internal image data instead of copying every pixel in the bitmap.
  * The internal image data will be uninitialized once the final reference to
  * the given internal bitmap is erased.
+ * 
+ * A PixelData either stores RGB24 colors, or only 8-bit gray values when
+ * constructed from a gray buffer (see is_gray). Gray PixelData is meant for
+ * output modes which only use the brightness of each pixel, and reads through
+ * at() as the equivalent gray RGB24 color.
 */
 class PixelData {
   private:
     std::shared_ptr<std::vector<RGB24>> pixels;
+    std::shared_ptr<std::vector<std::uint8_t>> gray_pixels; // non-null only for gray PixelData
     int m_width;
     int m_height;
 
     void init_from_avframe(AVFrame* video_frame);
+    PixelData scale_gray(double amount, int new_width, int new_height, ScalingAlgo scaling_algorithm) const;
   public:
 
     PixelData() : pixels(std::make_shared<std::vector<RGB24>>()), m_width(0), m_height(0) {}
@@ -57,6 +64,7 @@ class PixelData {
     PixelData(const std::vector< std::vector<uint8_t> >& raw_grayscale_data);
     PixelData(const std::vector<RGB24>& colors, int width, int height);
     PixelData(std::shared_ptr<std::vector<RGB24>> colors, int width, int height);
+    PixelData(std::shared_ptr<std::vector<std::uint8_t>> grays, int width, int height);
     PixelData(int width, int height);
     PixelData(AVFrame* video_frame);
     PixelData(const PixelData& pix_data);
@@ -64,6 +72,18 @@ class PixelData {
 
     PixelData scale(double amount, ScalingAlgo scaling_algorithm) const;
     PixelData bound(int width, int height, ScalingAlgo scaling_algorithm) const;
+
+    /**
+     * Returns a copy of the width by height pixels starting at row and col,
+     * which must lie within the PixelData
+    */
+    PixelData crop(int row, int col, int width, int height) const;
+
+    /**
+     * Returns the PixelData box filtered to exactly width by height pixels,
+     * without preserving its aspect ratio
+    */
+    PixelData resize(int width, int height) const;
     
     void operator=(const PixelData& pix_data);
     void operator=(PixelData&& pix_data);
@@ -83,13 +103,28 @@ class PixelData {
       return row >= 0 && col >= 0 && row < this->m_height && col < this->m_width;
     }
 
-    TMEDIA_ALWAYS_INLINE inline const RGB24& at(int row, int col) const {
+    TMEDIA_ALWAYS_INLINE inline bool is_gray() const {
+      return this->gray_pixels != nullptr;
+    }
+
+    TMEDIA_ALWAYS_INLINE inline RGB24 at(int row, int col) const {
+      if (this->gray_pixels) return RGB24((*this->gray_pixels)[row * this->m_width + col]);
       return (*this->pixels)[row * this->m_width + col];
     }
 
+    /**
+     * Only valid for PixelData which is not gray
+    */
     TMEDIA_ALWAYS_INLINE inline const std::vector<RGB24>& data() const {
       return (*this->pixels);
     }
+
+    /**
+     * Only valid for gray PixelData
+    */
+    TMEDIA_ALWAYS_INLINE inline const std::vector<std::uint8_t>& gray_data() const {
+      return (*this->gray_pixels);
+    }
 };
 
 RGB24 get_avg_color_from_area(const PixelData& data, int row, int col, int width, int height);
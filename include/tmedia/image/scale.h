@@ -97,4 +97,47 @@ inline Dim2 bound_dims(int src_width, int src_height, int max_width, int max_hei
   }
 }
 
+/**
+ * The part of a frame shown within a box of character cells, and where in the
+ * box it is shown, when every cell shows cell_pixels pixels of the frame
+*/
+struct FrameFit {
+  int src_row; // first row of the frame shown
+  int src_col; // first column of the frame shown
+  int width; // in pixels
+  int height; // in pixels
+  int row; // offset in cells of the shown pixels from the top of the box
+  int col; // offset in cells of the shown pixels from the left of the box
+  int cells_width;
+  int cells_height;
+};
+
+/**
+ * Returns where a frame is shown within a box of box_width by box_height
+ * cells, where every cell shows cell_pixels pixels of the frame.
+ * 
+ * Frames are produced at a size which fits in the box (see
+ * MediaFetcher::req_dims and MediaFetcher::req_cell_pixels), so they are only
+ * centered in the box and never scaled. A frame which does not fit, such as
+ * one produced before the box or the output mode changed, is cropped around
+ * its center until frames of the new size arrive.
+ * 
+ * cell_pixels must be positive in both dimensions.
+*/
+inline FrameFit fit_frame(int frame_width, int frame_height, Dim2 cell_pixels, int box_width, int box_height) {
+  box_width = std::max(box_width, 0);
+  box_height = std::max(box_height, 0);
+
+  FrameFit fit;
+  fit.width = std::min(frame_width, box_width * cell_pixels.width);
+  fit.height = std::min(frame_height, box_height * cell_pixels.height);
+  fit.src_col = (frame_width - fit.width) / 2;
+  fit.src_row = (frame_height - fit.height) / 2;
+  fit.cells_width = (fit.width + cell_pixels.width - 1) / cell_pixels.width;
+  fit.cells_height = (fit.height + cell_pixels.height - 1) / cell_pixels.height;
+  fit.col = (box_width - fit.cells_width) / 2;
+  fit.row = (box_height - fit.cells_height) / 2;
+  return fit;
+}
+
 #endif
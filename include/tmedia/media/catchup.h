@@ -0,0 +1,51 @@
+#ifndef TMEDIA_CATCHUP_H
+#define TMEDIA_CATCHUP_H
+
+/**
+ * Decides how aggressively a video decoder should discard frames while
+ * decoding lags behind the playback clock.
+ * 
+ * The returned level starts at 0 (decode everything) and escalates one level
+ * at a time up to MAX_LEVEL while the lag stays above ESCALATE_LAG_FRAMES
+ * frame durations. Once the decoder has been on time for RELAX_SECS of
+ * presentation time, the level relaxes one level at a time. The streak is
+ * measured in time rather than in frames, since the higher levels decode
+ * only a few frames per second (only keyframes at MAX_LEVEL within tmedia),
+ * and relaxing would otherwise take much longer the more is discarded.
+ * 
+ * What each level discards is up to the caller. Within tmedia, levels map to
+ * the AVDiscard values of the decoder's AVCodecContext in video_thread.cpp.
+*/
+class CatchupController {
+  private:
+    int m_level;
+    double m_streak_start_pts; // presentation time the decoder has been on time since, or NAN
+    int m_frames_since_change;
+
+  public:
+    static constexpr int MAX_LEVEL = 3;
+    static constexpr double ESCALATE_LAG_FRAMES = 3.0;
+    static constexpr double RELAX_LAG_FRAMES = 1.0;
+    static constexpr double RELAX_SECS = 1.0;
+
+    // frames to wait after changing levels before escalating again, giving
+    // the new level time to take effect
+    static constexpr int SETTLE_FRAMES = 6;
+
+    CatchupController();
+
+    /**
+     * Report the lag of the most recently decoded frame, being the current
+     * playback time minus the frame's presentation time (negative when the
+     * frame is early), along with the frame's presentation time. Returns the
+     * discard level to decode with from now on.
+     *
+     * Presentation times must not decrease until the next reset.
+    */
+    int update(double lag_secs, double frame_duration_secs, double frame_pts_secs);
+
+    int level() const noexcept;
+    void reset() noexcept;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef TMEDIA_FRAME_QUEUE_H
+#define TMEDIA_FRAME_QUEUE_H
+
+#include <tmedia/image/pixeldata.h>
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <optional>
+#include <cstddef>
+
+struct CellFrame;
+
+/**
+ * Lookahead queue of converted video frames, each tagged with the timestamp
+ * (in seconds) at which it should start being presented.
+ *
+ * A producer decodes and pushes frames ahead of the playback clock while a
+ * presenter pops whichever frame is due at the clock's current time, so short
+ * decoding stalls are absorbed by the frames already queued.
+ *
+ * The queue is lock-free for exactly one producer thread and one presenter
+ * thread: frames are kept in a fixed ring of slots, handed over through
+ * atomic head and tail indices, so neither side ever waits on the other.
+ * Pushing or popping a frame only copies its PixelData handle.
+ *
+ * The slot of the frame popped last is held until another frame is popped,
+ * so that the producer can read back the frame being presented (see
+ * presented) without it being overwritten.
+ *
+ * Clearing the queue increments its serial. Frames are pushed with the serial
+ * the producer read before decoding them, and frames pushed with an outdated
+ * serial are dropped by the presenter, so that frames converted before a
+ * clear are never presented after it.
+ *
+ * Frames can be pushed along with the cells the producer already rendered
+ * from them (see CellFrame), which are handed over with the frame.
+ *
+ * Frames must be pushed in presentation order.
+*/
+class FrameQueue {
+  private:
+    struct QueuedFrame {
+      PixelData frame;
+      std::shared_ptr<const CellFrame> cells;
+      double pts;
+      unsigned int serial;
+    };
+
+    static constexpr std::size_t NO_SLOT = static_cast<std::size_t>(-1);
+
+    std::vector<QueuedFrame> m_slots;
+    std::size_t m_capacity;
+    std::atomic<std::size_t> m_head; // count of frames popped, written by the presenter
+    std::atomic<std::size_t> m_tail; // count of frames pushed, written by the producer
+    std::atomic<std::size_t> m_held; // slot of the frame popped last, or NO_SLOT
+    std::atomic<unsigned int> m_serial; // written by the presenter
+
+    /**
+     * Pops frames with an outdated serial off the front of the queue.
+     * Presenter only.
+    */
+    void drop_outdated() noexcept;
+
+    /**
+     * Pops the frame at the front of the queue, which must exist, and holds
+     * its slot. Presenter only.
+    */
+    PixelData pop_held() noexcept;
+
+  public:
+    FrameQueue(std::size_t capacity);
+
+    // Producer
+
+    /**
+     * Producers should stop decoding once the queue is full. Pushing one
+     * frame into a full queue is still allowed, as a single packet can decode
+     * into multiple frames.
+    */
+    bool full() const noexcept;
+
+    /**
+     * The serial to push the frames decoded from now on with
+    */
+    unsigned int serial() const noexcept;
+
+    /**
+     * Returns false, without pushing the frame, if no slot is free
+    */
+    bool push(const PixelData& frame, double pts, unsigned int serial, std::shared_ptr<const CellFrame> cells = nullptr);
+
+    /**
+     * Returns the frame popped last by the presenter, if any.
+     * Producer only.
+    */
+    std::optional<PixelData> presented() const;
+
+    // Presenter
+
+    bool empty() noexcept;
+    std::size_t size() const noexcept;
+
+    /**
+     * The timestamp of the earliest queued frame, if any
+    */
+    std::optional<double> front_pts() noexcept;
+
+    /**
+     * The cells pushed along with the frame popped last, if any.
+     * Presenter only.
+    */
+    std::shared_ptr<const CellFrame> popped_cells() const;
+
+    /**
+     * Pops every frame whose timestamp is at or before time, returning the
+     * latest of them. Frames that are skipped over this way were never
+     * presented in time, and are simply dropped.
+     *
+     * Returns an empty optional if no frame is due yet.
+    */
+    std::optional<PixelData> pop_due(double time);
+
+    /**
+     * Pops the earliest frame regardless of its timestamp.
+     * Make sure to check that the queue is not empty first!
+    */
+    PixelData pop_front();
+
+    /**
+     * Drops every queued frame, and every frame still to be pushed with the
+     * current serial
+    */
+    void clear() noexcept;
+};
+
+#endif
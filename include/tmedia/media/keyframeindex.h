@@ -0,0 +1,76 @@
+#ifndef TMEDIA_KEYFRAME_INDEX_H
+#define TMEDIA_KEYFRAME_INDEX_H
+
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Sorted set of the keyframe timestamps of a single stream, in that stream's
+ * time base.
+ * 
+ * An index may be built incrementally (such as by scanning a file from start
+ * to end), so it also tracks how far into the stream it has been indexed.
+ * Lookups past the indexed portion fail rather than returning a keyframe
+ * which may be far earlier than a keyframe not yet indexed.
+*/
+class KeyframeIndex {
+  private:
+    std::vector<int64_t> m_keyframes;
+    int64_t m_indexed_until;
+    bool m_complete;
+
+  public:
+    KeyframeIndex();
+
+    /**
+     * Timestamps may be inserted in any order, though inserting in ascending
+     * order is fastest. Duplicate timestamps are ignored.
+     * 
+     * Inserting a keyframe does not extend the indexed portion of the
+     * stream, as keyframes before it may still be missing. That is up to
+     * set_indexed_until.
+    */
+    void insert(int64_t keyframe_ts);
+
+    /**
+     * Marks that every keyframe at or before ts has been inserted
+    */
+    void set_indexed_until(int64_t ts);
+
+    /**
+     * Marks that every keyframe of the stream has been inserted
+    */
+    void set_complete();
+
+    bool is_complete() const noexcept;
+
+    /**
+     * The timestamp every keyframe at or before has been inserted, or
+     * INT64_MIN if nothing has been indexed yet
+    */
+    int64_t get_indexed_until() const noexcept;
+    std::size_t size() const noexcept;
+
+    /**
+     * Returns the timestamp of the latest keyframe at or before ts.
+     * 
+     * Returns an empty optional if there is no such keyframe, or if ts lies
+     * past the indexed portion of the stream.
+    */
+    std::optional<int64_t> floor(int64_t ts) const;
+
+    /**
+     * Returns the timestamp of the keyframe closest to ts, preferring the
+     * earlier keyframe on ties.
+     * 
+     * Returns an empty optional if the index has no keyframes, or if ts lies
+     * past the indexed portion of the stream.
+    */
+    std::optional<int64_t> nearest(int64_t ts) const;
+
+    void clear() noexcept;
+};
+
+#endif
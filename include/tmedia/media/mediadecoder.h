@@ -3,6 +3,8 @@
 
 
 #include <tmedia/ffmpeg/streamdecoder.h>
+#include <tmedia/ffmpeg/avpool.h>
+#include <tmedia/media/keyframeindex.h>
 #include <tmedia/ffmpeg/boiler.h>
 #include <tmedia/ffmpeg/avguard.h>
 #include <tmedia/util/defines.h>
@@ -10,6 +12,7 @@
 
 #include <vector>
 #include <array>
+#include <memory>
 #include <string>
 #include <set>
 #include <filesystem>
@@ -28,17 +31,81 @@ extern "C" {
 class MediaDecoder {
   private:
     AVFormatContext* fmt_ctx;
+    const std::shared_ptr<AVPacketPool> pkt_pool; // must outlive decs
     std::array<std::unique_ptr<StreamDecoder>, AVMEDIA_TYPE_NB> decs;
     MediaType media_type;
-
-    int fetch_next(int requested_packet_count);
   public:
     const std::filesystem::path path;
 
-    MediaDecoder(const std::filesystem::path& file_path, const std::set<enum AVMediaType>& requested_streams);
+    /**
+     * decode_threads is passed to every opened StreamDecoder, where 0 lets
+     * FFmpeg choose the thread count automatically
+    */
+    MediaDecoder(const std::filesystem::path& file_path, const std::set<enum AVMediaType>& requested_streams, int decode_threads);
+
+    /**
+     * Reads the next packet from the file which belongs to one of this
+     * MediaDecoder's stream decoders into packet, and sets media_type to the
+     * type of the stream the packet belongs to.
+     * 
+     * The packet is not given to the stream decoder, so that a single thread
+     * can demux the file while other threads decode each stream through
+     * get_stream_decoder.
+     * 
+     * Returns 0 on success, or a negative AVERROR once the end of the file
+     * has been reached or reading failed.
+     * 
+     * Not Thread-Safe with seek or seek_keyframe
+    */
+    int read_packet(AVPacket* packet, enum AVMediaType& media_type);
+
+    /**
+     * The pool every packet read from this MediaDecoder should be acquired
+     * from, and released into once decoded or discarded.
+     * 
+     * Thread-Safe
+    */
+    TMEDIA_ALWAYS_INLINE inline const std::shared_ptr<AVPacketPool>& get_packet_pool() const noexcept {
+      return this->pkt_pool;
+    }
 
-    std::vector<AVFrame*> next_frames(enum AVMediaType media_type); // Not Thread-Safe
-    int jump_to_time(double target_time); // Not Thread-Safe
+    /**
+     * Seeks the underlying file to the closest position before target_time
+     * without decoding or resetting any stream decoders.
+     * 
+     * Not Thread-Safe with read_packet
+    */
+    int seek(double target_time);
+
+    /**
+     * Seeks the underlying file to exactly the keyframe of the given stream
+     * at keyframe_ts (in the stream's time base), such as a keyframe found
+     * through a KeyframeIndex. Stream decoders are not reset.
+     * 
+     * Not Thread-Safe with read_packet
+    */
+    int seek_keyframe(enum AVMediaType media_type, int64_t keyframe_ts);
+
+    /**
+     * Inserts the keyframes which the container's own index lists for the
+     * given stream into index.
+     * 
+     * Returns true if the container's index should cover the entire stream,
+     * in which case the inserted keyframes are marked as indexed. Some formats
+     * only index packets as they are read (AVFMT_GENERIC_INDEX), in which
+     * case false is returned, the indexed portion of index is left as it was,
+     * and the stream should be scanned instead.
+     * 
+     * Must be called before any packets are read.
+    */
+    bool read_container_keyframes(enum AVMediaType media_type, KeyframeIndex& index);
+
+    /**
+     * Make sure to check with has_stream_decoder first!
+    */
+    TMEDIA_ALWAYS_INLINE inline StreamDecoder& get_stream_decoder(enum AVMediaType media_type) {
+      return *(this->decs[media_type]);
+    }
     
     TMEDIA_ALWAYS_INLINE inline double get_duration() const noexcept {
       return this->fmt_ctx->duration / AV_TIME_BASE;
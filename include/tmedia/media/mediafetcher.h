@@ -4,12 +4,18 @@
 #include <tmedia/media/mediaclock.h>
 #include <tmedia/image/pixeldata.h>
 #include <tmedia/media/mediadecoder.h>
+#include <tmedia/media/framequeue.h>
+#include <tmedia/media/triplebuffer.h>
+#include <tmedia/media/keyframeindex.h>
+#include <tmedia/ffmpeg/packetqueue.h>
 #include <tmedia/audio/blocking_audioringbuffer.h>
 #include <tmedia/image/scale.h>
 #include <tmedia/audio/audio_visualizer.h>
 #include <tmedia/util/defines.h>
 
 #include <memory>
+#include <array>
+#include <vector>
 #include <string>
 #include <mutex>
 #include <atomic>
@@ -24,6 +30,9 @@ extern "C" {
 #include <libavutil/avutil.h>
 }
 
+class CellRenderer;
+struct CellFrame;
+
 /**
    * Locking Heirarchy:
    * 
@@ -35,6 +44,16 @@ extern "C" {
    * resume_notify_mutex - Mutex specifically for the resume_cond to tell sleeping
    * threads that the MediaFetcher has been resumed.
    * 
+   * frame_notify_mutex - Mutex specifically for the frame_cond to wake the
+   * thread presenting frames once a new frame is ready to be presented.
+   * 
+   * slot_notify_mutex - Mutex specifically for the slot_cond to wake the video
+   * thread once a slot in the full lookahead queue has been freed.
+   * 
+   * The mutexes internal to each PacketQueue in pkt_queues are always locked
+   * after alter_mutex if both are held, and are never held while locking
+   * alter_mutex.
+   * 
    * The locking heirarchy for the mutexes specific to condition variables are not as
    * important, as std::scoped_lock can avoid deadlocks anyway if multiple mutexes are
    * passed at once, and cond-paired mutexes should only be used in closed scopes
@@ -52,9 +71,13 @@ class MediaFetcher {
     std::thread video_thread;
     std::thread audio_thread;
     std::thread duration_checking_thread;
+    std::thread demux_thread;
+    std::thread keyframe_indexing_thread;
     void video_fetching_thread_func();
     void audio_dispatch_thread_func();
     void duration_checking_thread_func();
+    void demux_thread_func();
+    void keyframe_indexing_thread_func();
 
     void frame_video_fetching_func();
     void frame_image_fetching_func();
@@ -62,35 +85,216 @@ class MediaFetcher {
 
     void audio_fetching_thread_func();
 
+    /**
+     * Pops packets of the given media type from pkt_queues into the
+     * corresponding stream decoder of mdec until frames are decoded, or until
+     * no packet could be popped within milliseconds. Once the packet queue is
+     * finished, the stream decoder is drained of the frames it held back.
+     * 
+     * If the packet queue was flushed since serial was last updated, the
+     * stream decoder is reset before decoding, and serial is updated to the
+     * serial of the packet queue. This is how decoding threads find out that
+     * a jump has been made.
+     * 
+     * Decoded frames are appended onto frames, which must be empty, and must
+     * be given back through the stream decoder's release_frames
+    */
+    void decode_next_frames(enum AVMediaType media_type, int& serial, int milliseconds, std::vector<AVFrame*>& frames);
+
+    /**
+     * Lowers the video decoder's resolution as far as its codec allows while
+     * the decoded frames still cover what is rendered into target_dims
+     * pixels. Must be called before decoding starts.
+    */
+    void init_lowres_decoding(Dim2 target_dims);
+    bool lowres_decoding; // also decimate video frames before scaling
+
     MediaClock clock;
     const std::filesystem::path path;
     
     std::atomic<bool> in_use;
     std::optional<std::string> error;
 
-    int msg_video_jump_curr_time;
+    /**
+     * One PacketQueue for each stream decoded in mdec. Filled only by the
+     * demux thread, and each drained only by the thread decoding its stream.
+    */
+    std::array<std::unique_ptr<PacketQueue>, AVMEDIA_TYPE_NB> pkt_queues;
+    int msg_demux_jump_curr_time;
+    std::optional<int64_t> msg_demux_jump_keyframe; // exact video keyframe to seek to for the requested jump
+    int64_t msg_index_until; // video timestamp the keyframe indexing thread is asked to index up to
+    bool jumped_since_present; // the presented frame predates the latest jump
+
+    /**
+     * Converted video frames decoded ahead of the clock by the video thread,
+     * moved into frame by present_frame once they are due. Lock-free, with
+     * the video thread as its producer and the thread calling present_frame
+     * as its presenter.
+    */
+    FrameQueue frame_queue;
+
+    /**
+     * Frames which are presented as soon as they are published, rather than
+     * at a timestamp: images, cover art, audio visualizations, and paused
+     * video frames resized to a new frame size. Lock-free, published by the
+     * video thread and consumed by present_frame.
+    */
+    TripleBuffer<PixelData> still_frames;
+
+    /**
+     * Keyframes of the video stream, used by the demux thread to seek
+     * straight to the keyframe preceding a jump. Read from the container's
+     * index when possible. Otherwise, filled in by the demux thread from the
+     * packets it reads, and by the keyframe indexing thread once a jump lands
+     * past the indexed part of the stream. Guarded by alter_mutex.
+    */
+    KeyframeIndex kf_index;
+
+    /**
+     * Asks the keyframe indexing thread to index the video stream up to
+     * target_time, if the index does not reach that far yet.
+     * alter_mutex must be locked
+    */
+    void request_keyframe_index(double target_time);
+
+    std::atomic<int> nb_dropped_frames; // decoded, but too late to convert
+    std::atomic<int> nb_skipped_frames; // discarded by the decoder to catch up
+
     std::mutex ex_noti_mtx;
     std::condition_variable exit_cond;
 
     std::mutex resume_notify_mutex;
     std::condition_variable resume_cond;
-    int msg_audio_jump_curr_time;
+
+    std::mutex frame_notify_mutex;
+    std::condition_variable frame_cond;
+
+    /**
+     * Wakes the thread waiting in wait_for_frame. Called by the video thread
+     * after it publishes a still frame or pushes a frame into the lookahead
+     * queue.
+    */
+    void notify_frame();
+
+    std::mutex slot_notify_mutex;
+    std::condition_variable slot_cond;
+
+    /**
+     * Wakes the video thread waiting on a full lookahead queue. Called by the
+     * thread calling present_frame after it frees a slot in the queue.
+    */
+    void notify_slot();
 
   public:
 
     MediaType media_type;
     const std::unique_ptr<MediaDecoder> mdec;
     std::unique_ptr<BlockingAudioRingBuffer> audio_buffer;
+
+    /**
+     * The frame to render, updated by present_frame. Only to be used by the
+     * thread calling present_frame, as producers hand frames over through
+     * frame_queue and still_frames instead.
+    */
     PixelData frame;
 
+    /**
+     * The cells rendered from frame by the video thread, or nullptr if frame
+     * was not rendered ahead of time. Updated by present_frame along with
+     * frame, and only to be used by the same thread.
+    */
+    std::shared_ptr<const CellFrame> frame_cells;
+
     std::mutex alter_mutex;
     std::optional<Dim2> req_dims;
 
+    /**
+     * The pixels shown within each character cell by the current output mode,
+     * such as two rows of pixels per cell for half-block output. Frames are
+     * sized to req_dims cells of this many pixels each.
+    */
+    Dim2 req_cell_pixels;
+
+    /**
+     * Renders video frames into the cells of the current output mode as soon
+     * as they are converted, so that presenting them only has to print them.
+     * nullptr when the output mode is only rendered by the presenting thread.
+     * Guarded by alter_mutex.
+    */
+    std::shared_ptr<const CellRenderer> cell_renderer;
+
     static constexpr int VISUALIZE_VIDEO = 1 << 0;
     static constexpr int IGNORE_ATTACHED_PIC = 1 << 1;
+    static constexpr int GRAYSCALE_VIDEO = 1 << 2; // only the luma of video frames is needed
     std::atomic<int> flags;
 
-    MediaFetcher(const std::filesystem::path& path, const std::set<enum AVMediaType>& requested_streams);
+    /**
+     * If lowres_target is given, video is decoded at reduced resolution for
+     * output onto that many pixels, which is the number of character cells
+     * times req_cell_pixels (see --lowres)
+    */
+    MediaFetcher(const std::filesystem::path& path, const std::set<enum AVMediaType>& requested_streams, int decode_threads, const std::optional<Dim2>& lowres_target);
+
+    /**
+     * Updates frame to the latest still frame published, or to the latest
+     * frame in the video lookahead queue which is due at the current playback
+     * time. If no frame has been presented yet or since the last jump, the
+     * earliest queued frame is presented immediately.
+     * 
+     * Handing over frames never waits on the video thread, but reading the
+     * playback time is not thread-safe, so lock alter_mutex first
+    */
+    void present_frame(double currsystime);
+
+    /**
+     * Waits until the system time until_systime, returning early once
+     * present_frame has a new frame to present: when a still frame is
+     * published, when the earliest queued video frame becomes due, or when
+     * the first frame after a jump is queued. Also returns once the
+     * MediaFetcher is dispatched to exit.
+     * 
+     * Only to be called by the thread calling present_frame, without
+     * alter_mutex held
+    */
+    void wait_for_frame(double until_systime);
+
+    /**
+     * Moves the clock ahead to the timestamp of the earliest queued video
+     * frame, so that present_frame presents it right away. When no video
+     * frame is queued and none are still to be decoded, such as for audio or
+     * once all video has been decoded, the clock moves ahead by fallback_secs
+     * instead.
+     *
+     * Together with wait_for_queued_frame, this plays media as fast as it
+     * can be decoded and rendered rather than in real time (see --headless).
+     *
+     * Not thread-safe, lock alter_mutex first
+    */
+    void skip_to_next_frame(double currsystime, double fallback_secs);
+
+    /**
+     * Waits until the system time until_systime, returning early once a
+     * video frame is queued or a still frame is published, regardless of
+     * when they are due. Also returns once the MediaFetcher is dispatched to
+     * exit.
+     *
+     * Only to be called by the thread calling present_frame, without
+     * alter_mutex held
+    */
+    void wait_for_queued_frame(double until_systime);
+
+    /**
+     * Counts of video frames which were decoded too late to be presented, and
+     * of video frames which the decoder skipped to catch up to the clock.
+     * Thread-Safe
+    */
+    TMEDIA_ALWAYS_INLINE inline int get_dropped_frames() const noexcept {
+      return this->nb_dropped_frames;
+    }
+
+    TMEDIA_ALWAYS_INLINE inline int get_skipped_frames() const noexcept {
+      return this->nb_skipped_frames;
+    }
 
     void begin(double currsystime); // Only to be called by owning thread
     void join(double currsystime); // Only to be called by owning thread after in_use is set to false
@@ -166,6 +370,23 @@ class MediaFetcher {
      * alter_mutex must be locked first before calling for thread safety
      */
     int jump_to_time(double target_time, double currsystime);
+
+    /**
+     * @brief Moves the MediaFetcher's playback to the indexed video keyframe
+     * nearest to target_time, so that the frame at the landing time can be
+     * shown without decoding any frames in between.
+     * 
+     * Meant for rapid successive jumps, where the exact landing time matters
+     * less than responsiveness. Falls back to jump_to_time when there is no
+     * indexed keyframe near target_time.
+     * 
+     * @param target_time The approximate time to jump to (must be reachable)
+     * @param currsystime The current system time
+     * @returns The time that playback actually jumped to
+     * 
+     * alter_mutex must be locked first before calling for thread safety
+    */
+    double scrub_to_time(double target_time, double currsystime);
 };
 
 
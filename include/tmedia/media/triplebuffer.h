@@ -0,0 +1,73 @@
+#ifndef TMEDIA_TRIPLE_BUFFER_H
+#define TMEDIA_TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+
+/**
+ * Lock-free handoff of the latest value from a single producer thread to a
+ * single consumer thread.
+ *
+ * The producer writes into back() and publishes it, while the consumer reads
+ * front() after consuming the latest published value. Publishing and
+ * consuming each swap a slot with the middle slot through one atomic
+ * exchange, so neither side ever waits for the other, and values published
+ * faster than they are consumed are simply overwritten.
+*/
+template <typename T>
+class TripleBuffer {
+  private:
+    static constexpr unsigned int SLOT_MASK = 0x3;
+    static constexpr unsigned int FRESH = 0x4; // the middle slot holds an unconsumed value
+
+    std::array<T, 3> m_slots;
+    std::atomic<unsigned int> m_middle;
+    unsigned int m_back; // only used by the producer
+    unsigned int m_front; // only used by the consumer
+
+  public:
+    TripleBuffer() : m_middle(1), m_back(0), m_front(2) {}
+
+    /**
+     * The slot the producer writes the next value into. Only to be used by
+     * the producer.
+    */
+    T& back() noexcept {
+      return this->m_slots[this->m_back];
+    }
+
+    /**
+     * Hands the value written into back() to the consumer. back() then
+     * refers to another slot, holding an older value.
+    */
+    void publish() noexcept {
+      this->m_back = this->m_middle.exchange(this->m_back | FRESH, std::memory_order_acq_rel) & SLOT_MASK;
+    }
+
+    /**
+     * Moves the latest published value into front(), returning if there was a
+     * value published since the last call. Only to be used by the consumer.
+    */
+    bool consume() noexcept {
+      if (!(this->m_middle.load(std::memory_order_acquire) & FRESH)) return false;
+      this->m_front = this->m_middle.exchange(this->m_front, std::memory_order_acq_rel) & SLOT_MASK;
+      return true;
+    }
+
+    /**
+     * Returns if a value was published since the last call to consume,
+     * without consuming it. Only to be used by the consumer.
+    */
+    bool fresh() const noexcept {
+      return this->m_middle.load(std::memory_order_acquire) & FRESH;
+    }
+
+    /**
+     * The latest value consumed. Only to be used by the consumer.
+    */
+    const T& front() const noexcept {
+      return this->m_slots[this->m_front];
+    }
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef TMEDIA_ANSI_FRAME_H
+#define TMEDIA_ANSI_FRAME_H
+
+#include <tmedia/util/defines.h>
+
+#include <vector>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Color value of an AnsiCell using the terminal's default color
+*/
+inline constexpr std::uint32_t ANSI_DEFAULT_COLOR = 0xFFFFFFFF;
+
+/**
+ * Reduces a 24-bit color packed as 0xRRGGBB to the given number of bits per
+ * channel, in [1, 8], rounding each channel to the middle of its reduced
+ * step. Nearby colors then encode as the same color, so that fewer color
+ * changes are written.
+*/
+TMEDIA_ALWAYS_INLINE inline std::uint32_t ansi_reduce_color(std::uint32_t color, int bits) {
+  const int dropped = 8 - bits;
+  if (dropped <= 0) return color;
+  const std::uint32_t channel_mask = (0xFFu << dropped) & 0xFFu;
+  const std::uint32_t channel_round = (1u << dropped) >> 1;
+  return (color & (channel_mask * 0x010101u)) | (channel_round * 0x010101u);
+}
+
+/**
+ * A single terminal cell printed through ANSI escape sequences.
+ * 
+ * fg and bg are 24-bit colors packed as 0xRRGGBB, or ANSI_DEFAULT_COLOR.
+*/
+struct AnsiCell {
+  std::uint32_t codepoint;
+  std::uint32_t fg;
+  std::uint32_t bg;
+};
+
+TMEDIA_ALWAYS_INLINE inline bool operator==(const AnsiCell& a, const AnsiCell& b) {
+  return a.codepoint == b.codepoint && a.fg == b.fg && a.bg == b.bg;
+}
+
+TMEDIA_ALWAYS_INLINE inline bool operator!=(const AnsiCell& a, const AnsiCell& b) {
+  return !(a == b);
+}
+
+/**
+ * Encodes cells into 24-bit color ANSI escape sequences in a reused byte
+ * buffer, which is then written to the terminal all at once.
+ * 
+ * Color changes are only emitted when a cell's colors differ from the previous
+ * cell's, so runs of repeated colors cost one byte per ASCII cell.
+ * 
+ * The cursor position and attributes are saved when a frame begins and
+ * restored when it ends, so that a frame can be written after curses
+ * refreshes without disturbing curses' idea of the cursor.
+*/
+class AnsiFrame {
+  private:
+    std::vector<char> m_bytes;
+    std::size_t m_size;
+    std::uint32_t m_fg;
+    std::uint32_t m_bg;
+    int m_nb_cells;
+    int m_nb_images;
+    bool m_synchronized;
+
+    char* reserve(std::size_t nb_bytes);
+    void append(const char* str, std::size_t len);
+    void move_cursor(int row, int col);
+
+  public:
+    AnsiFrame();
+
+    /**
+     * Clears the buffer and begins a new frame. If synchronized, the frame is
+     * wrapped in synchronized update markers so that the terminal presents
+     * it all at once.
+    */
+    void begin_frame(bool synchronized);
+
+    /**
+     * Append count cells starting at the given zero-based row and column of
+     * the screen
+    */
+    void put_cells(int row, int col, const AnsiCell* cells, int count);
+
+    /**
+     * Append an already encoded graphics protocol image, placed with its top
+     * left corner at the given zero-based row and column of the screen
+    */
+    void put_image(int row, int col, std::string_view encoded);
+
+    void end_frame();
+
+    /**
+     * Writes the ended frame to the given file descriptor and clears the
+     * buffer. Nothing is written if no cells or images were put into the
+     * frame.
+     * 
+     * Returns false if the frame could not be fully written.
+    */
+    bool flush(int fd);
+
+    TMEDIA_ALWAYS_INLINE inline const char* data() const { return this->m_bytes.data(); }
+    TMEDIA_ALWAYS_INLINE inline std::size_t size() const { return this->m_size; }
+    TMEDIA_ALWAYS_INLINE inline int get_nb_cells() const { return this->m_nb_cells; }
+    TMEDIA_ALWAYS_INLINE inline int get_nb_images() const { return this->m_nb_images; }
+};
+
+/**
+ * Writes all of the given bytes to fd, retrying on partial writes and
+ * interruptions. Returns false if the bytes could not be fully written.
+*/
+bool term_write_all(int fd, const char* bytes, std::size_t size);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TMEDIA_KITTY_GFX_H
+#define TMEDIA_KITTY_GFX_H
+
+#include <tmedia/image/pixeldata.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Encodes PixelData as images of the kitty terminal graphics protocol.
+ * 
+ * Frames are sent as raw 24-bit RGB, compressed with zlib when tmedia is
+ * built with it (TMEDIA_ZLIB), and base64 encoded into chunks of at most 4096
+ * bytes as the protocol requires.
+ * 
+ * Every frame is transmitted and placed under the same image and placement
+ * id, so that the terminal replaces the previous frame in place instead of
+ * storing a new image for every frame.
+*/
+class KittyEncoder {
+  private:
+    std::vector<std::uint8_t> m_rgb;
+    std::vector<std::uint8_t> m_payload;
+
+  public:
+    /**
+     * Appends the commands transmitting frame as image image_id and placing
+     * it at the cursor, scaled to cover cols columns and rows rows of cells,
+     * to out. The cursor is not moved by the placement.
+    */
+    void encode(const PixelData& frame, std::uint32_t image_id, int cols, int rows, std::string& out);
+};
+
+/**
+ * Appends the command deleting image image_id, along with its placements and
+ * stored data, to out
+*/
+void kitty_delete_image(std::uint32_t image_id, std::string& out);
+
+/**
+ * Appends the base64 encoding of the given bytes to out
+*/
+void base64_encode(const std::uint8_t* bytes, std::size_t size, std::string& out);
+
+#endif
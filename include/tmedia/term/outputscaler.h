@@ -0,0 +1,75 @@
+#ifndef TMEDIA_OUTPUT_SCALER_H
+#define TMEDIA_OUTPUT_SCALER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Decides how far to lower the size and color depth of the video written to
+ * the terminal while the terminal cannot take in output as fast as it is
+ * written, such as over a slow SSH connection.
+ * 
+ * Every refresh reports how long writing its output blocked. The level
+ * starts at 0 (full size and color) and escalates one level at a time up to
+ * MAX_LEVEL while the smoothed output time stays above the output budget,
+ * each level drawing the video onto fewer cells (get_scale) or with fewer
+ * bits per color channel (get_color_bits). The level relaxes one level at a
+ * time once the output time, grown by how many more cells the lower level
+ * draws, would have stayed within RELAX_BUDGET_FRACTION of the budget for
+ * RELAX_STREAK consecutive refreshes.
+ * 
+ * The bytes written and the time blocked are also totalled for reporting.
+*/
+class OutputScaler {
+  private:
+    int m_level;
+    double m_avg_output_secs;
+    int m_relax_streak;
+    int m_refreshes_since_change;
+
+    std::uint64_t m_refreshes;
+    std::uint64_t m_bytes;
+    double m_blocked_secs;
+
+  public:
+    static constexpr int MAX_LEVEL = 5;
+    static constexpr double RELAX_BUDGET_FRACTION = 0.75;
+    static constexpr int RELAX_STREAK = 48;
+    static constexpr double SMOOTHING = 0.25; // weight of each refresh in the smoothed output time
+
+    // refreshes to wait after changing levels before escalating again, giving
+    // the new level time to take effect
+    static constexpr int SETTLE_REFRESHES = 12;
+
+    OutputScaler();
+
+    /**
+     * Report the seconds a refresh was blocked writing its output to the
+     * terminal, and how many bytes of output were counted. Returns the level
+     * to output with from now on.
+    */
+    int update(double output_secs, std::size_t bytes, double budget_secs);
+
+    int level() const noexcept;
+
+    /**
+     * The fraction of the available cells to draw video frames onto at the
+     * current level, in (0, 1]
+    */
+    double get_scale() const noexcept;
+
+    /**
+     * The bits per color channel to write 24-bit colors with at the current
+     * level, in [1, 8]
+    */
+    int get_color_bits() const noexcept;
+
+    std::uint64_t get_refreshes() const noexcept;
+    std::uint64_t get_bytes() const noexcept;
+    double get_blocked_secs() const noexcept;
+
+    void reset_stats() noexcept;
+    void reset() noexcept; // also resets the statistics
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef TMEDIA_SIXEL_H
+#define TMEDIA_SIXEL_H
+
+#include <tmedia/image/pixeldata.h>
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * The number of levels of each channel in the palette of SixelEncoder
+*/
+inline constexpr int SIXEL_PALETTE_SIDE = 6;
+inline constexpr int SIXEL_PALETTE_SIZE = SIXEL_PALETTE_SIDE * SIXEL_PALETTE_SIDE * SIXEL_PALETTE_SIDE;
+
+/**
+ * Encodes PixelData as DEC Sixel graphics.
+ * 
+ * Pixels are quantized to a fixed 6x6x6 color cube, ordered dithered against a
+ * 4x4 Bayer matrix so that the cube's banding is not visible. The dithered
+ * level of every channel value at every position of the matrix is
+ * precomputed on construction. Since the palette is fixed, quantizing needs
+ * no pass over the frame to build a palette, and unchanged pixels keep their
+ * colors between frames.
+ * 
+ * Each band of 6 rows is written as one run-length encoded row of sixels for
+ * each color used in the band, and only colors used by the frame get color
+ * registers.
+ * 
+ * Pixels with no sixel set are left transparent, so every pixel of the image
+ * must be set, which the color cube guarantees.
+*/
+class SixelEncoder {
+  private:
+    std::array<std::array<std::uint8_t, 256>, 16> m_levels; // by dither matrix position, then channel value
+    std::vector<std::uint8_t> m_indices; // palette index of each pixel in the frame
+    std::vector<std::uint8_t> m_band_bits; // sixel bits of each column, for each color used in a band
+    std::array<std::int16_t, SIXEL_PALETTE_SIZE> m_band_slots; // row of each color in m_band_bits, or -1
+    std::vector<std::uint8_t> m_band_colors;
+
+    void write_band(int band_row, int width, int height, std::string& out);
+
+  public:
+    SixelEncoder();
+
+    /**
+     * Appends the complete sixel image of frame, from its device control
+     * string introducer to its string terminator, to out
+    */
+    void encode(const PixelData& frame, std::string& out);
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef TMEDIA_TERMCAPS_H
+#define TMEDIA_TERMCAPS_H
+
+#include <tmedia/image/scale.h>
+
+#include <string_view>
+
+/**
+ * Capabilities of the controlling terminal which curses does not report,
+ * guessed from the environment the terminal gives to tmedia.
+*/
+
+/**
+ * Returns if the terminal advertises 24-bit SGR color support through the
+ * COLORTERM environment variable
+*/
+bool term_supports_truecolor();
+
+/**
+ * Returns if synchronized update markers (private mode 2026) can be sent to
+ * the terminal. Terminals which do not implement the mode ignore it, so this
+ * only excludes terminals known to misbehave with it.
+*/
+bool term_supports_synchronized_update();
+
+/**
+ * The graphics protocols tmedia can send pixels through
+*/
+enum class TermGraphics {
+  NONE,
+  SIXEL,
+  KITTY
+};
+
+struct TermGraphicsCaps {
+  TermGraphics protocol = TermGraphics::NONE;
+  Dim2 cell_pixels; // (0, 0) if not reported
+};
+
+/**
+ * Parses the terminal's replies to the queries sent by term_probe_graphics,
+ * preferring the kitty graphics protocol over Sixel when both are supported
+*/
+TermGraphicsCaps term_parse_graphics_reply(std::string_view reply);
+
+/**
+ * Asks the terminal which graphics protocols it supports and the size of its
+ * character cells in pixels, waiting at most timeout_ms for its replies.
+ * 
+ * Replies are read from stdin, so this must be called before curses is
+ * initialized. The result is remembered for term_graphics_caps.
+*/
+TermGraphicsCaps term_probe_graphics(int timeout_ms);
+
+/**
+ * Returns the result of the last call to term_probe_graphics, or no graphics
+ * support if the terminal was never probed
+*/
+const TermGraphicsCaps& term_graphics_caps();
+
+/**
+ * Returns the size of a character cell in pixels, as reported by the
+ * terminal's window size if available and by term_probe_graphics otherwise,
+ * or (0, 0) if neither reported it.
+*/
+Dim2 term_cell_pixels();
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TMEDIA_BRAILLE_KERNEL_H
+#define TMEDIA_BRAILLE_KERNEL_H
+
+#include <array>
+#include <cstdint>
+
+static constexpr std::uint32_t BRAILLE_BLANK = 0x2800; // U+2800, no dots raised
+static constexpr int BRAILLE_CELL_WIDTH = 2; // dots per cell
+static constexpr int BRAILLE_CELL_HEIGHT = 4;
+
+/**
+ * Maps gray pixels to Unicode braille patterns, where every cell shows a
+ * 2x4 block of pixels as its 8 dots.
+ *
+ * Pixels are ordered dithered against a 4x4 Bayer matrix, which keeps the
+ * dots of unchanged pixels the same from frame to frame. Whether the dot of a
+ * gray value is raised at each position of the matrix is precomputed into a
+ * table of the dot's bit in the pattern, so packing a cell is only 8 table
+ * lookups and ORs.
+*/
+class BrailleKernel {
+  private:
+    // dot bit by [row within the cell][column within the dither matrix][gray]
+    std::array<std::array<std::array<std::uint8_t, 256>, 4>, BRAILLE_CELL_HEIGHT> m_dots;
+
+  public:
+    BrailleKernel();
+
+    /**
+     * Maps one row of cells from rows consecutive rows of width gray pixels,
+     * writing (width + 1) / 2 code points to cells. rows should be at most
+     * BRAILLE_CELL_HEIGHT, and missing pixels are treated as black.
+    */
+    void map_row(const std::uint8_t* grays, int width, int rows, std::uint32_t* cells) const noexcept;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef TMEDIA_CELL_GRID_H
+#define TMEDIA_CELL_GRID_H
+
+#include <tmedia/util/defines.h>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A run of consecutive cells within a row of a CellGrid, starting at col
+*/
+struct CellRun {
+  int col;
+  int length;
+};
+
+/**
+ * Holds the cells last printed to a rectangular region of the screen, so that
+ * only the cells which changed since the previous frame have to be printed.
+ * 
+ * Cell is the type printed for a single terminal cell, such as a curses
+ * chtype, and must be equality comparable.
+ * 
+ * Anything that draws over or erases the region outside of the CellGrid
+ * (such as erase()) must be followed by a call to invalidate, or the stale
+ * cells will never be redrawn.
+*/
+template <typename Cell>
+class CellGrid {
+  private:
+    /**
+     * Changed cells separated by at most this many unchanged cells are printed
+     * as a single run, since reprinting a few cells is cheaper than moving the
+     * cursor
+    */
+    static constexpr int MAX_RUN_GAP = 4;
+
+    std::vector<Cell> m_cells;
+    int m_row = 0;
+    int m_col = 0;
+    int m_width = 0;
+    int m_height = 0;
+    bool m_valid = false;
+    bool m_full_frame = true;
+
+    int m_frame_changed_cells = 0;
+    std::uint64_t m_total_changed_cells = 0;
+    std::uint64_t m_total_cells = 0;
+    std::uint64_t m_frames = 0;
+
+  public:
+    /**
+     * Begins a new frame to be printed at the given region of the screen.
+     * If the region differs from the previous frame's region, the grid is
+     * invalidated.
+    */
+    void begin_frame(int row, int col, int width, int height);
+
+    /**
+     * Marks every cell of the grid as unknown, so that the next frame is
+     * printed in full.
+    */
+    void invalidate() noexcept;
+
+    /**
+     * Compares the width cells of the given row against the previous frame,
+     * storing them as the new contents of the row.
+     * 
+     * runs is filled with the runs of cells which must be printed, where
+     * changed cells separated by only a few unchanged cells are merged into one
+     * run to avoid needless cursor movement. The number of changed cells in
+     * the row is returned.
+    */
+    int diff_row(int row, const Cell* cells, std::vector<CellRun>& runs);
+
+    TMEDIA_ALWAYS_INLINE inline int get_row() const { return this->m_row; }
+    TMEDIA_ALWAYS_INLINE inline int get_col() const { return this->m_col; }
+    TMEDIA_ALWAYS_INLINE inline int get_width() const { return this->m_width; }
+    TMEDIA_ALWAYS_INLINE inline int get_height() const { return this->m_height; }
+
+    /**
+     * The number of changed cells in the frame begun by the last call to
+     * begin_frame
+    */
+    TMEDIA_ALWAYS_INLINE inline int get_frame_changed_cells() const { return this->m_frame_changed_cells; }
+    TMEDIA_ALWAYS_INLINE inline std::uint64_t get_total_changed_cells() const { return this->m_total_changed_cells; }
+    TMEDIA_ALWAYS_INLINE inline std::uint64_t get_total_cells() const { return this->m_total_cells; }
+    TMEDIA_ALWAYS_INLINE inline std::uint64_t get_frames() const { return this->m_frames; }
+    void reset_counters() noexcept;
+};
+
+template <typename Cell>
+void CellGrid<Cell>::begin_frame(int row, int col, int width, int height) {
+  if (row != this->m_row || col != this->m_col ||
+      width != this->m_width || height != this->m_height) {
+    this->m_row = row;
+    this->m_col = col;
+    this->m_width = width;
+    this->m_height = height;
+    this->m_cells.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+    this->m_valid = false;
+  }
+
+  // every row of the frame is printed in full if the previous cells are not
+  // known, after which they are known again
+  this->m_full_frame = !this->m_valid;
+  this->m_valid = true;
+  this->m_frame_changed_cells = 0;
+  this->m_total_cells += static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height);
+  this->m_frames++;
+}
+
+template <typename Cell>
+void CellGrid<Cell>::invalidate() noexcept {
+  this->m_valid = false;
+}
+
+template <typename Cell>
+int CellGrid<Cell>::diff_row(int row, const Cell* cells, std::vector<CellRun>& runs) {
+  Cell* prev = this->m_cells.data() + static_cast<std::size_t>(row) * this->m_width;
+  const int width = this->m_width;
+  runs.clear();
+
+  if (this->m_full_frame) {
+    for (int col = 0; col < width; col++) prev[col] = cells[col];
+    if (width > 0) runs.push_back({0, width});
+    this->m_frame_changed_cells += width;
+    this->m_total_changed_cells += width;
+    return width;
+  }
+
+  int changed = 0;
+  for (int col = 0; col < width; col++) {
+    if (prev[col] == cells[col]) continue;
+    prev[col] = cells[col];
+    changed++;
+
+    if (!runs.empty() && col - (runs.back().col + runs.back().length) <= MAX_RUN_GAP) {
+      runs.back().length = col - runs.back().col + 1;
+    } else {
+      runs.push_back({col, 1});
+    }
+  }
+
+  this->m_frame_changed_cells += changed;
+  this->m_total_changed_cells += changed;
+  return changed;
+}
+
+template <typename Cell>
+void CellGrid<Cell>::reset_counters() noexcept {
+  this->m_total_changed_cells = 0;
+  this->m_total_cells = 0;
+  this->m_frames = 0;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TMEDIA_CELL_KERNEL_H
+#define TMEDIA_CELL_KERNEL_H
+
+#include <tmedia/image/color.h>
+#include <tmedia/tmcurses/tmcurses.h>
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+extern "C" {
+  #include <curses.h>
+}
+
+/**
+ * Maps rows of already scaled pixels straight to curses cells, where each
+ * cell is a chtype holding both the glyph and the color pair attribute for
+ * one pixel, in a single pass per row.
+ * 
+ * The gray value, glyph, and color cube step of every channel value are
+ * precomputed into lookup tables on construction, so mapping a pixel is only
+ * table lookups and additions. Gray values are computed in 16-bit fixed point,
+ * and may differ by one from get_gray8.
+ * 
+ * The color pairs are read from tmcurses when constructed, so a kernel should
+ * be rebuilt once tmcurses_color_maps_generation changes.
+*/
+class CellKernel {
+  private:
+    std::array<std::uint32_t, 256> m_gray_r; // fixed point luma contribution
+    std::array<std::uint32_t, 256> m_gray_g;
+    std::array<std::uint32_t, 256> m_gray_b;
+    std::array<std::uint16_t, 256> m_step_r; // offset into m_cube_attrs
+    std::array<std::uint16_t, 256> m_step_g;
+    std::array<std::uint16_t, 256> m_step_b;
+    std::array<chtype, 256> m_glyphs; // by gray value
+    std::array<chtype, 256> m_gray_attrs; // color pair attribute by gray value
+    std::array<chtype, TMCURSES_COLOR_MAP_SIDE * TMCURSES_COLOR_MAP_SIDE * TMCURSES_COLOR_MAP_SIDE> m_cube_attrs;
+
+  public:
+    /**
+     * If glyphs is false, every cell is a space. If colors is false, no color
+     * pair attributes are given to cells.
+    */
+    CellKernel(std::string_view ascii_char_map, bool glyphs, bool colors);
+
+    void map_row(const RGB24* pixels, int width, chtype* cells) const noexcept;
+    void map_row(const std::uint8_t* grays, int width, chtype* cells) const noexcept;
+};
+
+#endif
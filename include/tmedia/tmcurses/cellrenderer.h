@@ -0,0 +1,119 @@
+#ifndef TMEDIA_CELL_RENDERER_H
+#define TMEDIA_CELL_RENDERER_H
+
+#include <tmedia/tmcurses/cellkernel.h>
+#include <tmedia/term/ansiframe.h>
+#include <tmedia/image/pixeldata.h>
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstddef>
+#include <string_view>
+#include <cstdint>
+
+extern "C" {
+  #include <curses.h>
+}
+
+class CellRenderer;
+
+/**
+ * The cells rendered from every pixel of a frame by a CellRenderer, in row
+ * major order. Only the cells of the renderer's output are filled.
+*/
+struct CellFrame {
+  std::shared_ptr<const CellRenderer> renderer;
+  int width;
+  int height;
+  std::vector<chtype> curses_cells;
+  std::vector<AnsiCell> ansi_cells;
+};
+
+/**
+ * Maps pixels to the cells of one character per pixel output modes, either
+ * curses cells mapped by a CellKernel or 24-bit color AnsiCells.
+ * 
+ * A CellRenderer never changes after construction, so the same renderer can
+ * render frames on any thread, such as on the video thread ahead of
+ * presentation. A new renderer should be made whenever its parameters or the
+ * tmcurses color maps change, and cells rendered by an outdated renderer
+ * should be rendered again.
+*/
+class CellRenderer {
+  public:
+    enum class Output {
+      CURSES_CELLS,
+      ANSI_FG, // glyphs colored with the pixel's color
+      ANSI_BG // spaces with the pixel's color as their background
+    };
+
+  private:
+    Output m_output;
+    std::optional<CellKernel> m_kernel; // for Output::CURSES_CELLS
+    std::array<std::uint32_t, 256> m_glyphs; // codepoints by gray value, for Output::ANSI_FG
+    int m_color_bits;
+
+  public:
+    /**
+     * Renders curses cells, as constructed by CellKernel with the same
+     * parameters. Must be constructed on the thread owning curses.
+    */
+    CellRenderer(std::string_view ascii_char_map, bool glyphs, bool colors);
+
+    /**
+     * Renders AnsiCells for Output::ANSI_FG or Output::ANSI_BG, with colors
+     * reduced to color_bits bits per channel (see ansi_reduce_color)
+    */
+    CellRenderer(Output output, std::string_view ascii_char_map, int color_bits);
+
+    TMEDIA_ALWAYS_INLINE inline Output get_output() const noexcept {
+      return this->m_output;
+    }
+
+    /**
+     * Renders width pixels of the pixel data's given row, beginning at the
+     * given column, into cells. Must match the renderer's output.
+    */
+    void map_row(const PixelData& pixel_data, int row, int col, int width, chtype* cells) const noexcept;
+    void map_row(const PixelData& pixel_data, int row, int col, int width, AnsiCell* cells) const noexcept;
+};
+
+/**
+ * Recycles CellFrames in the same way as PixelBufferPool recycles pixel
+ * buffers, so that rendering frames at a steady rate and size stops
+ * allocating once every CellFrame in flight has been created.
+ * 
+ * A CellFrame is only handed out again once nothing else references it.
+ * Not thread-safe, although acquired CellFrames may be shared across threads
+ * as usual.
+*/
+class CellFramePool {
+  private:
+    std::vector<std::shared_ptr<CellFrame>> m_frames;
+    std::size_t m_capacity;
+
+  public:
+    /**
+     * At most capacity CellFrames are kept for reuse. CellFrames acquired
+     * while every kept CellFrame is in use are not kept.
+    */
+    CellFramePool(std::size_t capacity);
+
+    /**
+     * Returns a CellFrame which is not referenced anywhere else. Its contents
+     * are unspecified.
+    */
+    std::shared_ptr<CellFrame> acquire();
+
+    std::size_t size() const noexcept;
+};
+
+/**
+ * Renders every pixel of the pixel data with the given renderer, into a
+ * CellFrame acquired from pool
+*/
+std::shared_ptr<const CellFrame> render_cell_frame(CellFramePool& pool, const std::shared_ptr<const CellRenderer>& renderer, const PixelData& pixel_data);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef TMEDIA_HALFBLOCK_PAIRS_H
+#define TMEDIA_HALFBLOCK_PAIRS_H
+
+#include <tmedia/image/color.h>
+
+/**
+ * Layout of the color pairs tmcurses allocates for half-block cells (see
+ * get_tmcurses_halfblock_pair), as offsets from the first pair past the
+ * color palette's pairs.
+ *
+ * Top and bottom colors are quantized to a color cube with side steps along
+ * each channel. Every color of the cube gets a run of pairs with it as the
+ * foreground: one for each color of the cube as the background, followed by
+ * one with the terminal's default background, for cells whose bottom pixel
+ * lies past the frame.
+*/
+
+static constexpr int HALFBLOCK_SIDES[] = { 4, 3, 2 }; // preferred first
+
+constexpr int halfblock_cube_size(int side) {
+  return side * side * side;
+}
+
+constexpr int halfblock_nb_pairs(int side) {
+  return halfblock_cube_size(side) * (halfblock_cube_size(side) + 1);
+}
+
+/**
+ * Returns the largest of HALFBLOCK_SIDES whose pairs all fit into free_pairs
+ * color pairs, or 0 if none fit
+*/
+constexpr int halfblock_side_for(int free_pairs) {
+  for (int side : HALFBLOCK_SIDES) {
+    if (halfblock_nb_pairs(side) <= free_pairs) return side;
+  }
+  return 0;
+}
+
+/**
+ * Returns the index into the color cube of the cube color closest to color,
+ * where the cube is ordered by red, then green, then blue
+*/
+inline int halfblock_cube_index(const RGB24& color, int side) {
+  const int max_step = side - 1;
+  return ((static_cast<int>(color.r) * max_step + 127) / 255 * side
+    + (static_cast<int>(color.g) * max_step + 127) / 255) * side
+    + (static_cast<int>(color.b) * max_step + 127) / 255;
+}
+
+constexpr int halfblock_pair_offset(int top_index, int bottom_index, int side) {
+  return top_index * (halfblock_cube_size(side) + 1) + bottom_index;
+}
+
+constexpr int halfblock_default_bg_pair_offset(int top_index, int side) {
+  return halfblock_pair_offset(top_index, halfblock_cube_size(side), side);
+}
+
+#endif
@@ -48,6 +48,28 @@ enum class TMNCursesColorPalette {
 */
 void tmcurses_init();
 
+/**
+ * Initializes tmcurses onto a virtual screen of cols by lines cells, with no
+ * terminal attached (see --headless). Curses keeps the screen's cells in
+ * memory as it would for a terminal, but everything written out is discarded
+ * into /dev/null and no input is ever read.
+ *
+ * The virtual screen is described as xterm-256color, so that colors behave
+ * the same wherever tmedia runs headless.
+ *
+ * No-op if tmcurses is already initialized
+ *
+ * @throws std::runtime_error if the virtual screen could not be created
+*/
+void tmcurses_init_headless(int cols, int lines);
+
+/**
+ * The file descriptor curses writes the screen to, which output written
+ * around curses should go to as well. STDOUT_FILENO unless tmcurses was
+ * initialized headless.
+*/
+int tmcurses_output_fd();
+
 /**
  * Way to check if tmcurses has been initialized with tmcurses_init() and has
  * not been uninitialized with tmcurses_uninit()
@@ -133,6 +155,51 @@ void tmcurses_set_color_palette_custom(const Palette&);
  */
 curses_color_pair_t get_closest_tmcurses_color_pair(const RGB24& input);
 
+/**
+ * Colors are matched to color pairs through a discrete color cube with
+ * TMCURSES_COLOR_MAP_SIDE steps along each channel, where a channel value v
+ * falls into step v * (TMCURSES_COLOR_MAP_SIDE - 1) / 255
+*/
+inline constexpr int TMCURSES_COLOR_MAP_SIDE = 7;
+
+/**
+ * Returns the color pair that get_closest_tmcurses_color_pair gives for every
+ * color in the given step of the color cube. Meant for building lookup tables
+ * over color pairs.
+*/
+curses_color_pair_t get_tmcurses_color_pair_at_step(int r_step, int g_step, int b_step);
+
+/**
+ * Incremented whenever the colors matched by get_closest_tmcurses_color_pair
+ * may have changed, so that lookup tables built over color pairs know when to
+ * be rebuilt
+*/
+unsigned int tmcurses_color_maps_generation();
+
+/**
+ * Returns if color pairs for half-block cells (see
+ * get_tmcurses_halfblock_pair) are available. This needs more color pairs than
+ * the color palette itself, so it depends on the terminal's COLOR_PAIRS.
+*/
+bool tmcurses_has_halfblock_pairs();
+
+/**
+ * Returns a color pair with a foreground close to top and a background close
+ * to bottom, for printing U+2580 (upper half block) as two stacked pixels.
+ * 
+ * Both colors are coarsely quantized to keep the number of pairs in bounds.
+ * Pair numbers may exceed 255, so they can only be given to curses through
+ * the wide character functions. Returns 0 without half-block pairs.
+*/
+curses_color_pair_t get_tmcurses_halfblock_pair(const RGB24& top, const RGB24& bottom);
+
+/**
+ * Returns a half-block color pair with a foreground close to top over the
+ * terminal's default background, for cells with no bottom pixel. Returns 0
+ * without half-block pairs.
+*/
+curses_color_pair_t get_tmcurses_halfblock_top_pair(const RGB24& top);
+
 /**
  * @brief Find the closest registered ncurses color integer to the inputted RGB24.
  * @returns The closest registered ncurses color pair attribute index
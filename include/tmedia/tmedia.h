@@ -7,10 +7,15 @@
 #include <tmedia/media/metadata.h> // for MetadataCache
 #include <tmedia/image/scale.h> // for Dim2
 #include <tmedia/ffmpeg/boiler.h> // for MediaType
-#include <tmedia/image/pixeldata.h> // for PixelData and ScalingAlgo
+#include <tmedia/image/pixeldata.h> // for PixelData
 #include <tmedia/util/defines.h> // for ASCII_STANDARD_CHAR_MAP
+#include <tmedia/tmedia_tui_elems.h> // for VideoSurface
+#include <tmedia/term/outputscaler.h> // for OutputScaler
+#include <tmedia/tmcurses/cellrenderer.h> // for CellRenderer and CellFrame
 
 #include <optional>
+#include <memory>
+#include <string_view>
 #include <vector>
 #include <string>
 #include <filesystem>
@@ -23,9 +28,53 @@ enum class VidOutMode {
   COLOR,
   GRAY,
   COLOR_BG,
-  GRAY_BG
+  GRAY_BG,
+  TRUECOLOR, // 24-bit color written directly to the terminal
+  TRUECOLOR_BG,
+  HALFBLOCK, // two pixels per cell, stacked as the colors of U+2580
+  BRAILLE, // 2x4 dithered gray pixels per cell, as the dots of U+2800-U+28FF
+  GRAPHICS // real pixels, sent through the Sixel or kitty graphics protocols
 };
 
+/**
+ * Returns the output mode which can actually be displayed for the requested
+ * mode, falling back from the truecolor modes to the curses color modes when
+ * truecolor is not supported, from VidOutMode::HALFBLOCK to
+ * VidOutMode::COLOR_BG when it can be printed through neither truecolor nor
+ * curses, and to VidOutMode::PLAIN when curses has no colors.
+ * VidOutMode::GRAPHICS falls back to VidOutMode::HALFBLOCK when
+ * term_probe_graphics found no graphics protocol or the size of the
+ * terminal's cells is unknown. VidOutMode::BRAILLE has no colors, so it is
+ * always displayable.
+*/
+VidOutMode resolve_vom(VidOutMode mode, bool truecolor_supported);
+
+/**
+ * Returns the pixels shown in each character cell by the given output mode
+*/
+Dim2 vom_cell_pixels(VidOutMode mode);
+
+/**
+ * Returns the CellRenderer for the given displayable output mode (see
+ * resolve_vom), which can also be handed to other threads to render frames
+ * ahead of time. Returns nullptr for the output modes which are not rendered
+ * one cell per pixel.
+ * 
+ * The same renderer is returned until its parameters or the tmcurses color
+ * maps change. Only to be called from the rendering thread.
+*/
+std::shared_ptr<const CellRenderer> vom_cell_renderer(VidOutMode mode, std::string_view ascii_char_map, int color_bits);
+
+/**
+ * How tmedia plays without a terminal (see --headless). Headless playback
+ * renders onto a virtual curses screen and discards what would be written to
+ * the terminal, so that rendering can be measured anywhere.
+*/
+enum class HeadlessMode {
+  OFF, // play in the terminal
+  REALTIME, // play at normal speed
+  MAX_SPEED // present every video frame as soon as it is decoded
+};
 
 struct TMediaStartupState {
   std::vector<std::filesystem::path> media_files;
@@ -34,10 +83,14 @@ struct TMediaStartupState {
   double volume = 1.0;
   bool muted = false;
   int refresh_rate_fps = 24;
+  int decode_threads = 0;
+  bool lowres_decoding = false;
+  bool dump_decoders = false;
   VidOutMode vom = VidOutMode::PLAIN;
-  ScalingAlgo scaling_algorithm = ScalingAlgo::BOX_SAMPLING;
   bool fullscreen = false;
   std::string ascii_display_chars = ASCII_STANDARD_CHAR_MAP;
+  HeadlessMode headless = HeadlessMode::OFF;
+  Dim2 headless_dims = Dim2(80, 24); // cells of the virtual screen played on while headless
 };
 
 int tmedia_run(TMediaStartupState& tmpd);
@@ -59,7 +112,11 @@ struct TMediaProgramState {
   bool quit = false;
   bool fullscreen = false;
   int refresh_rate_fps = 24;
-  ScalingAlgo scaling_algorithm = ScalingAlgo::BOX_SAMPLING;
+  int decode_threads = 0;
+  bool lowres_decoding = false;
+  bool dump_decoders = false;
+  std::vector<std::string> decoder_dump; // printed once curses has exited
+  HeadlessMode headless = HeadlessMode::OFF;
   VidOutMode vom = VidOutMode::PLAIN;
   std::string ascii_display_chars = ASCII_STANDARD_CHAR_MAP;
   
@@ -69,6 +126,7 @@ struct TMediaProgramState {
 struct TMediaProgramSnapshot {
   std::string currently_playing;
   PixelData frame;
+  std::shared_ptr<const CellFrame> frame_cells; // frame rendered ahead of time, if at all
   MediaType media_type;
   bool playing;
   double media_duration_secs;
@@ -80,6 +138,8 @@ struct TMediaRendererState {
   MetadataCache metadata_cache;
   Dim2 last_frame_dims = Dim2(1, 1);
   Dim2 req_frame_dim = Dim2(1, 1);
+  VideoSurface video;
+  OutputScaler output_scaler; // scales video down while the terminal cannot keep up
 };
 
 void render_tui_fullscreen(const TMediaProgramState& tmps, const TMediaProgramSnapshot& sshot, TMediaRendererState& tmrs);
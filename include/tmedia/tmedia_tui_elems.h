@@ -1,28 +1,127 @@
 #ifndef TMEDIA_TMEDIA_TUI_ELEMS_H
 #define TMEDIA_TMEDIA_TUI_ELEMS_H
 
-class PixelData;
-enum class ScalingAlgo;
 enum class VidOutMode;
 
+#include <tmedia/tmcurses/cellgrid.h>
+#include <tmedia/tmcurses/tmcurses.h>
+#include <tmedia/tmcurses/cellrenderer.h>
+#include <tmedia/term/ansiframe.h>
+#include <tmedia/term/termcaps.h>
+#include <tmedia/term/sixel.h>
+#include <tmedia/term/kittygfx.h>
+#include <tmedia/image/pixeldata.h>
+
 #include <string>
 #include <vector>
+#include <memory>
+#include <cstdint>
 
 extern "C" {
   #include <curses.h>
 }
 
-void render_pixel_data(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VidOutMode output_mode, const ScalingAlgo scaling_algorithm, std::string_view ascii_char_map);
+/**
+ * The state kept between frames about the video printed to the screen, for
+ * both the curses output and the direct ANSI truecolor output
+*/
+struct VideoSurface {
+  CellGrid<chtype> curses_cells;
+  CellGrid<curses_color_pair_t> halfblock_cells; // wide curses half-blocks
+  CellGrid<std::uint32_t> braille_cells; // wide curses braille patterns
+  CellGrid<AnsiCell> ansi_cells;
+  AnsiFrame ansi_frame; // to be written to the terminal after curses refreshes
+  bool truecolor_supported = term_supports_truecolor();
+  bool synchronized_update = term_supports_synchronized_update();
+  bool ansi_active = false; // if the video is currently printed by ansi_frame
+  int color_bits = 8; // bits per channel of the colors printed by ansi_frame
+  VidOutMode vom{}; // the output mode of the last printed frame
+
+  SixelEncoder sixel_encoder;
+  KittyEncoder kitty_encoder;
+  std::string graphics_bytes; // the encoded image of the last graphics frame
+  PixelData graphics_frame; // the last image sent through a graphics protocol
+  int graphics_row = 0;
+  int graphics_col = 0;
+  bool graphics_shown = false; // if graphics_frame is on the screen
+  bool kitty_image_shown = false; // if a kitty image must be deleted to clear it
+  bool sixel_cursor_right = false; // if the sixel cursor placement must be reset
+
+  /**
+   * Forces the next frame to be printed in full, such as after the screen
+   * has been erased. When the video is printed through ansi_frame, curses is
+   * also told to repaint the whole screen on the next refresh, since curses
+   * does not know what ansi_frame left on the screen.
+  */
+  void invalidate();
+
+  /**
+   * Removes any image sent through the kitty graphics protocol from the
+   * screen, which erasing the screen's text does not do, and restores the
+   * terminal's default sixel cursor placement if sixel frames changed it.
+   * Must be called before exiting.
+  */
+  void clear_graphics();
+};
+
+void render_pixel_data(const PixelData& pixel_data, const CellFrame* frame_cells, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VidOutMode output_mode, std::string_view ascii_char_map, VideoSurface& surface);
 void wprint_progress_bar(WINDOW* window, int y, int x, int width, int height, double percentage);
 void wprint_playback_bar(WINDOW* window, int y, int x, int width, double time, double duration);
 void wprint_labels(WINDOW* window, std::vector<std::string_view>& labels, int y, int x, int width);
 
 
-void render_pixel_data_plain(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const ScalingAlgo scaling_algorithm, std::string_view ascii_char_map);
-void render_pixel_data_bg(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const ScalingAlgo scaling_algorithm);
-void render_pixel_data_color(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const ScalingAlgo scaling_algorithm, std::string_view ascii_char_map);
+/**
+ * Centers the pixel data within the given bounds, and prints the runs of
+ * curses cells rendered by renderer which changed since the last frame
+ * printed to grid.
+ * 
+ * If frame_cells were already rendered from the pixel data by the same
+ * renderer, such as by the video thread, they are printed as they are.
+ * Otherwise, rows are rendered in parallel bands by the render pool, and only
+ * printing them to curses happens row by row on the rendering thread.
+*/
+void render_pixel_data_cells(const PixelData& pixel_data, const CellFrame* frame_cells, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const std::shared_ptr<const CellRenderer>& renderer, CellGrid<chtype>& grid);
+
+/**
+ * Prints the pixel data with 24-bit colors into surface.ansi_frame, as the
+ * AnsiCells rendered by renderer, taking frame_cells as they are in the same
+ * way as render_pixel_data_cells.
+*/
+void render_pixel_data_truecolor(const PixelData& pixel_data, const CellFrame* frame_cells, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const std::shared_ptr<const CellRenderer>& renderer, VideoSurface& surface);
+
+/**
+ * Prints every two rows of the pixel data as one row of upper half blocks,
+ * colored with the top pixel as the foreground and the bottom pixel as the
+ * background. Printed into surface.ansi_frame while surface.ansi_active, and
+ * otherwise through curses' wide character functions.
+*/
+void render_pixel_data_halfblock(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VideoSurface& surface);
+
+/**
+ * Returns if half blocks can be printed through curses
+*/
+bool curses_halfblock_supported();
+
+/**
+ * Prints every 2x4 block of the pixel data as the dots of one braille
+ * pattern, dithered from the gray value of each pixel. Printed through curses'
+ * wide character functions when curses_wide_supported, and otherwise into
+ * surface.ansi_frame.
+*/
+void render_pixel_data_braille(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VideoSurface& surface);
 
+/**
+ * Sends the pixel data as an image through the graphics protocol found by
+ * term_probe_graphics, at the size of the cells it covers. The image is only
+ * sent again once the shown pixel data, its position, or the screen
+ * changes.
+*/
+void render_pixel_data_graphics(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VideoSurface& surface);
 
+/**
+ * Returns if characters outside of ASCII can be printed through curses
+*/
+bool curses_wide_supported();
 
 
 #endif
\ No newline at end of file
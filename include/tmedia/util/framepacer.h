@@ -0,0 +1,57 @@
+#ifndef TMEDIA_FRAME_PACER_H
+#define TMEDIA_FRAME_PACER_H
+
+#include <cstdint>
+
+/**
+ * Deadline-based pacing of refreshes on the system's monotonic clock (see
+ * sys_clk_sec).
+ * 
+ * Refresh deadlines lie on a grid of 1 / fps seconds, so that the time spent
+ * refreshing is subtracted from the time waited rather than added onto every
+ * refresh interval. A refresh which overruns its deadline moves the grid to
+ * the first boundary after the refresh finished, instead of rushing through
+ * the missed boundaries. A refresh begun before its deadline, such as when a
+ * new video frame was ready early, moves the grid to begin at that refresh.
+ * 
+ * The slack left before the deadline once each refresh is done, and the
+ * refreshes which overran their deadline, are recorded.
+*/
+class FramePacer {
+  private:
+    double m_interval;
+    double m_deadline; // when the current refresh was scheduled to begin, NAN before the first
+    std::uint64_t m_refreshes;
+    std::uint64_t m_overruns;
+    double m_total_slack;
+    double m_min_slack;
+    double m_max_overrun;
+
+  public:
+    FramePacer(double fps);
+
+    /**
+     * Marks that a refresh has begun at the given time
+    */
+    void begin_refresh(double currsystime);
+
+    /**
+     * Marks that the refresh begun last has finished at the given time,
+     * returning the deadline at which the next refresh should begin
+    */
+    double end_refresh(double currsystime);
+
+    void reset_stats();
+
+    std::uint64_t get_refreshes() const noexcept;
+    std::uint64_t get_overruns() const noexcept;
+
+    /**
+     * Statistics in seconds, which are 0 until a refresh has been recorded
+    */
+    double get_mean_slack() const noexcept;
+    double get_min_slack() const noexcept;
+    double get_max_overrun() const noexcept;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef TMEDIA_ROW_POOL_H
+#define TMEDIA_ROW_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * A small pool of persistent worker threads which split the rows of a frame
+ * into bands and process the bands in parallel.
+ * 
+ * The thread calling run processes bands alongside the workers and returns
+ * once every band is done, so a pool with no workers simply runs every row
+ * on the calling thread. Only one thread should call run at a time.
+*/
+class RowPool {
+  private:
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_cond; // tells workers that a new job began
+    std::condition_variable m_done_cond; // tells run that every band is done
+    const std::function<void(int, int)>* m_band_fn;
+    int m_nb_rows;
+    int m_nb_bands;
+    int m_next_band;
+    int m_bands_done;
+    unsigned int m_generation; // incremented for every job given to the workers
+    bool m_stopping;
+
+    void worker_func();
+
+    /**
+     * Processes bands of the current job until none are left to take
+    */
+    void work_bands();
+
+  public:
+    /**
+     * Starts nb_workers worker threads. Fewer than 1 worker starts none.
+    */
+    RowPool(int nb_workers);
+    ~RowPool();
+
+    RowPool(const RowPool&) = delete;
+    RowPool& operator=(const RowPool&) = delete;
+
+    int get_nb_workers() const noexcept;
+
+    /**
+     * Calls band_fn(begin, end) for consecutive bands of rows covering
+     * [0, nb_rows), with bands of at least min_band_rows rows where possible,
+     * and at most one band for each worker and the calling thread.
+     * 
+     * band_fn is called concurrently from different threads, so it must only
+     * write to the rows it is given, and it must not throw.
+    */
+    void run(int nb_rows, int min_band_rows, const std::function<void(int, int)>& band_fn);
+};
+
+#endif
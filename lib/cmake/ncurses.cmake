@@ -10,6 +10,9 @@ if(FIND_CURSES)
   if (NOT CURSES_FOUND)
     set(CURSES_NEED_WIDE OFF)
     find_package(Curses REQUIRED)
+  else()
+    # wide character output (such as half-blocks) is only built against ncursesw
+    list(APPEND TMEDIA_COMPILE_OPTIONS -DTMEDIA_WIDE_CURSES -DNCURSES_WIDECHAR=1)
   endif()
 
   list(APPEND TMEDIA_DEPS_LIBRARIES ${CURSES_LIBRARIES})
@@ -36,3 +36,10 @@ include(${CMAKE_SOURCE_DIR}/lib/cmake/ffmpeg.cmake)
 include(${CMAKE_SOURCE_DIR}/lib/cmake/ncurses.cmake)
 include(${CMAKE_SOURCE_DIR}/lib/cmake/fmt.cmake)
 
+# zlib is optional, and only compresses the frames sent through the kitty
+# graphics protocol
+find_package(ZLIB)
+if (ZLIB_FOUND)
+  list(APPEND TMEDIA_DEPS_LIBRARIES ZLIB::ZLIB)
+  list(APPEND TMEDIA_COMPILE_OPTIONS -DTMEDIA_ZLIB)
+endif()
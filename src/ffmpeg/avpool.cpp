@@ -0,0 +1,93 @@
+#include <tmedia/ffmpeg/avpool.h>
+
+#include <tmedia/ffmpeg/ffmpeg_error.h>
+#include <tmedia/util/defines.h>
+
+#include <vector>
+#include <mutex>
+
+#include <fmt/format.h>
+
+extern "C" {
+  #include <libavcodec/avcodec.h>
+  #include <libavutil/frame.h>
+}
+
+AVPacket* AVPacketPool::acquire() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->free_packets.empty()) {
+      AVPacket* packet = this->free_packets.back();
+      this->free_packets.pop_back();
+      return packet;
+    }
+  }
+
+  AVPacket* packet = av_packet_alloc();
+  if (unlikely(packet == nullptr)) {
+    throw ffmpeg_error(fmt::format("[{}] Failed to allocate AVPacket",
+    FUNCDINFO), AVERROR(ENOMEM));
+  }
+  return packet;
+}
+
+void AVPacketPool::release(AVPacket* packet) noexcept {
+  if (packet == nullptr) return;
+  av_packet_unref(packet);
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  try {
+    this->free_packets.push_back(packet);
+  } catch (const std::bad_alloc& err) {
+    av_packet_free(&packet);
+  }
+}
+
+AVPacketPool::~AVPacketPool() {
+  for (AVPacket*& packet : this->free_packets) {
+    av_packet_free(&packet);
+  }
+}
+
+AVFrame* AVFramePool::acquire() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->free_frames.empty()) {
+      AVFrame* frame = this->free_frames.back();
+      this->free_frames.pop_back();
+      return frame;
+    }
+  }
+
+  AVFrame* frame = av_frame_alloc();
+  if (unlikely(frame == nullptr)) {
+    throw ffmpeg_error(fmt::format("[{}] Failed to allocate AVFrame",
+    FUNCDINFO), AVERROR(ENOMEM));
+  }
+  return frame;
+}
+
+void AVFramePool::release(AVFrame* frame) noexcept {
+  if (frame == nullptr) return;
+  av_frame_unref(frame);
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  try {
+    this->free_frames.push_back(frame);
+  } catch (const std::bad_alloc& err) {
+    av_frame_free(&frame);
+  }
+}
+
+void AVFramePool::release(std::vector<AVFrame*>& frames) noexcept {
+  for (AVFrame* frame : frames) {
+    this->release(frame);
+  }
+  frames.clear();
+}
+
+AVFramePool::~AVFramePool() {
+  for (AVFrame*& frame : this->free_frames) {
+    av_frame_free(&frame);
+  }
+}
@@ -0,0 +1,100 @@
+#include <tmedia/ffmpeg/packetqueue.h>
+
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <memory>
+
+extern "C" {
+  #include <libavcodec/avcodec.h>
+}
+
+PacketQueue::PacketQueue(std::size_t max_packets, std::shared_ptr<AVPacketPool> pkt_pool) : m_pkt_pool(pkt_pool) {
+  this->m_max_packets = max_packets;
+  this->m_serial = 0;
+  this->m_eof = false;
+  this->m_closed = false;
+}
+
+void PacketQueue::clear() noexcept {
+  while (!this->m_packets.empty()) {
+    AVPacket* packet = this->m_packets.front();
+    this->m_packets.pop_front();
+    this->m_pkt_pool->release(packet);
+  }
+}
+
+bool PacketQueue::try_push(AVPacket* packet, int serial, int milliseconds) {
+  std::unique_lock<std::mutex> lock(this->mutex);
+  if (this->m_closed || serial != this->m_serial) {
+    this->m_pkt_pool->release(packet);
+    return true;
+  }
+
+  if (this->m_packets.size() >= this->m_max_packets) {
+    this->cond.wait_for(lock, std::chrono::milliseconds(milliseconds));
+  }
+
+  if (this->m_closed || serial != this->m_serial) { // flushed while waiting
+    this->m_pkt_pool->release(packet);
+    return true;
+  }
+
+  if (this->m_packets.size() < this->m_max_packets) {
+    this->m_packets.push_back(packet);
+    this->cond.notify_one();
+    return true;
+  }
+
+  return false;
+}
+
+bool PacketQueue::try_pop(AVPacket*& packet, int& serial, int milliseconds) {
+  std::unique_lock<std::mutex> lock(this->mutex);
+  if (this->m_packets.empty() && !this->m_eof) {
+    this->cond.wait_for(lock, std::chrono::milliseconds(milliseconds));
+  }
+
+  if (this->m_packets.empty()) return false;
+  packet = this->m_packets.front();
+  serial = this->m_serial;
+  this->m_packets.pop_front();
+  this->cond.notify_one();
+  return true;
+}
+
+void PacketQueue::flush() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->clear();
+  this->m_serial++;
+  this->m_eof = false;
+  this->cond.notify_all();
+}
+
+void PacketQueue::set_eof(int serial) {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (serial != this->m_serial) return;
+  this->m_eof = true;
+  this->cond.notify_all();
+}
+
+void PacketQueue::close() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->clear();
+  this->m_closed = true;
+  this->cond.notify_all();
+}
+
+int PacketQueue::get_serial() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->m_serial;
+}
+
+bool PacketQueue::finished() {
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->m_closed || (this->m_eof && this->m_packets.empty());
+}
+
+PacketQueue::~PacketQueue() {
+  this->clear();
+}
@@ -12,13 +12,51 @@
 #include <vector>
 #include <stdexcept>
 #include <string>
+#include <memory>
+#include <algorithm>
 
 extern "C" {
   #include <libavcodec/avcodec.h>
   #include <libavformat/avformat.h>
 }
 
-StreamDecoder::StreamDecoder(AVFormatContext* fmt_ctx, enum AVMediaType media_type) {
+/**
+ * Allocates and opens a codec context for decoding the given stream.
+ * Throws if the codec could not be opened.
+*/
+static AVCodecContext* open_codec_context(const AVCodec* decoder, AVStream* stream, int thread_count, int thread_type, int lowres) {
+  AVCodecContext* codec_context = avcodec_alloc_context3(decoder);
+
+  if (codec_context == nullptr) {
+    throw std::runtime_error(fmt::format("[{}] Could not alloc codec context "
+    "from decoder: {}", FUNCDINFO, decoder->long_name));
+  }
+
+  int result = avcodec_parameters_to_context(codec_context, stream->codecpar);
+  if (result < 0) {
+    avcodec_free_context(&codec_context);
+    throw ffmpeg_error(fmt::format("[{}] Could not move AVCodec "
+    "parameters into context",
+    FUNCDINFO), result);
+  }
+
+  // must be set before avcodec_open2, as the thread pool is created on open
+  codec_context->thread_count = thread_count;
+  codec_context->thread_type = thread_type;
+  codec_context->lowres = lowres;
+
+  result = avcodec_open2(codec_context, decoder, NULL);
+  if (result < 0) {
+    avcodec_free_context(&codec_context);
+    throw ffmpeg_error(fmt::format("[{}] Could not initialize "
+    "AVCodecContext with AVCodec decoder",
+    FUNCDINFO), result);
+  }
+
+  return codec_context;
+}
+
+StreamDecoder::StreamDecoder(AVFormatContext* fmt_ctx, enum AVMediaType media_type, int thread_count, int thread_type, std::shared_ptr<AVPacketPool> pkt_pool) : pkt_pool(pkt_pool) {
   #if AV_FIND_BEST_STREAM_CONST_DECODER
   const AVCodec* decoder;
   #else
@@ -34,70 +72,77 @@ StreamDecoder::StreamDecoder(AVFormatContext* fmt_ctx, enum AVMediaType media_ty
 
   this->decoder = decoder;
   this->stream = fmt_ctx->streams[stream_index];
-  this->codec_context = avcodec_alloc_context3(this->decoder);
-
-  if (this->codec_context == nullptr) {
-    throw std::runtime_error(fmt::format("[{}] Could not alloc codec context "
-    "from decoder: {}", FUNCDINFO, decoder->long_name));
-  }
-
   this->media_type = media_type;
+  this->thread_count = thread_count;
+  this->thread_type = thread_type;
+  this->drained = false;
+  this->nb_failed_packets = 0;
+  this->codec_context = open_codec_context(this->decoder, this->stream, thread_count, thread_type, 0);
+};
 
-  int result = avcodec_parameters_to_context(this->codec_context, this->stream->codecpar);
-  if (result < 0) {
-    avcodec_free_context(&this->codec_context);
-    throw ffmpeg_error(fmt::format("[{}] Could not move AVCodec "
-    "parameters into context",
-    FUNCDINFO), result);
-  }
+void StreamDecoder::set_lowres(int lowres) {
+  lowres = std::clamp(lowres, 0, static_cast<int>(this->decoder->max_lowres));
+  if (lowres == this->codec_context->lowres) return;
 
-  result = avcodec_open2(this->codec_context, this->decoder, NULL);
-  if (result < 0) {
-    avcodec_free_context(&this->codec_context);
-    throw ffmpeg_error(fmt::format("[{}] Could not initialize "
-    "AVCodecContext with AVCodec decoder",
-    FUNCDINFO), result);
-  }
-};
+  AVCodecContext* codec_context = open_codec_context(this->decoder,
+  this->stream, this->thread_count, this->thread_type, lowres);
+  this->reset();
+  avcodec_free_context(&this->codec_context);
+  this->codec_context = codec_context;
+}
+
+const char* StreamDecoder::get_thread_type_str() const noexcept {
+  if (this->codec_context->active_thread_type & FF_THREAD_FRAME) return "frame";
+  if (this->codec_context->active_thread_type & FF_THREAD_SLICE) return "slice";
+  return "none";
+}
 
 void StreamDecoder::reset() noexcept {
-  avcodec_flush_buffers(this->codec_context);
+  avcodec_flush_buffers(this->codec_context); // also takes the codec out of draining
+  this->drained = false;
+  this->nb_failed_packets = 0;
 
   while (!this->packet_queue.empty()) {
     AVPacket* packet = this->packet_queue.front();
     this->packet_queue.pop_front();
-    av_packet_free(&packet);
+    this->pkt_pool->release(packet);
   }
 }
 
-std::vector<AVFrame*> StreamDecoder::decode_next() {
+int StreamDecoder::decode_next(std::vector<AVFrame*>& frames) {
   static constexpr int ALLOWED_FAILURES = 5;
 
-  bool decoding_error_thrown = true; //init to true so loop runs
-  for (int i = 0; i <= ALLOWED_FAILURES && decoding_error_thrown; i++) {
-    decoding_error_thrown = false;
-
-    try {
-      return decode_packet_queue(this->codec_context, this->packet_queue, this->media_type);
-    } catch (ffmpeg_error const& e) {
-      decoding_error_thrown = true;
-      if (i >= ALLOWED_FAILURES) {
-        throw std::runtime_error(fmt::format("[{}] Could not decode next {} "
-        "packet: \n\t{}", FUNCDINFO, av_get_media_type_string(this->media_type),
-         e.what()));
-      }
+  while (!this->packet_queue.empty()) {
+    const int result = decode_packet_queue(this->codec_context,
+    this->packet_queue, this->media_type, *this->pkt_pool, this->frame_pool,
+    frames);
+    if (result == 0 || result == AVERROR(EAGAIN)) { // the last packet decoded
+      this->nb_failed_packets = 0;
+      return result;
     }
 
+    // the failed packet was consumed, so decoding goes on with the next one
+    if (++this->nb_failed_packets > ALLOWED_FAILURES) {
+      throw ffmpeg_error(fmt::format("[{}] Could not decode {} consecutive "
+      "{} packets", FUNCDINFO, this->nb_failed_packets,
+      av_get_media_type_string(this->media_type)), result);
+    }
   }
-  
-  return {};
+
+  return AVERROR(EAGAIN);
+}
+
+int StreamDecoder::drain(std::vector<AVFrame*>& frames) {
+  if (this->drained) return AVERROR_EOF;
+  this->drained = true;
+  return drain_decoder(this->codec_context, this->frame_pool, frames);
 }
 
 StreamDecoder::~StreamDecoder() {
   while (!this->packet_queue.empty()) {
     AVPacket* packet = this->packet_queue.front();
     this->packet_queue.pop_front();
-    av_packet_free(&packet);
+    this->pkt_pool->release(packet);
   }
 
   if (this->codec_context != nullptr) {
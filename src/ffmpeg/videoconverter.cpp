@@ -5,12 +5,44 @@
 #include <tmedia/util/defines.h>
 
 #include <stdexcept>
+#include <algorithm>
 #include <fmt/format.h>
 
 extern "C" {
   #include <libavutil/frame.h>
   #include <libswscale/swscale.h>
   #include <libavutil/version.h>
+  #include <libavutil/pixdesc.h>
+}
+
+/**
+ * Returns whether the luma plane of the given format can be read on its own
+ * as an AV_PIX_FMT_GRAY8 image
+*/
+static bool has_gray8_luma_plane(enum AVPixelFormat src_pix_fmt) {
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(src_pix_fmt);
+  if (desc == nullptr) return false;
+  if (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BAYER | AV_PIX_FMT_FLAG_HWACCEL)) return false;
+  if (!(desc->flags & AV_PIX_FMT_FLAG_PLANAR) || desc->nb_components < 3) return false;
+  return desc->comp[0].plane == 0 && desc->comp[0].step == 1 && desc->comp[0].depth == 8;
+}
+
+/**
+ * Returns how many source rows to advance per row read when decimating a
+ * source into a destination of the given height. At least two source rows
+ * are kept for every destination row, so that the scaler still has some
+ * detail to filter.
+ * 
+ * Decimating by skipping rows keeps every plane aligned only for formats
+ * whose chroma planes are at most vertically halved, and breaks the 2x2
+ * pattern of bayer formats, so other formats are never decimated.
+*/
+static int src_row_step_for(int src_height, int dst_height, enum AVPixelFormat src_pix_fmt) {
+  const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(src_pix_fmt);
+  if (desc == nullptr) return 1;
+  if (desc->flags & (AV_PIX_FMT_FLAG_BAYER | AV_PIX_FMT_FLAG_HWACCEL)) return 1;
+  if (desc->log2_chroma_h > 1) return 1;
+  return std::max(1, src_height / (2 * dst_height));
 }
 
 VideoConverter::VideoConverter(int dst_width, int dst_height, enum AVPixelFormat dst_pix_fmt, int src_width, int src_height, enum AVPixelFormat src_pix_fmt) {
@@ -36,40 +68,71 @@ VideoConverter::VideoConverter(int dst_width, int dst_height, enum AVPixelFormat
     "defined dest pixel format: got AV_PIX_FMT_NONE", FUNCDINFO));
   }
 
-  this->m_context = sws_getContext(
-      src_width, src_height, src_pix_fmt, 
-      dst_width, dst_height, dst_pix_fmt, 
-      SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
-
-  if (this->m_context == nullptr) {
-    throw std::runtime_error(fmt::format("[{}] Allocation of internal "
-    "SwsContext of Video Converter failed", FUNCDINFO));
-  }
-  
+  this->m_context = nullptr;
   this->m_dst_width = dst_width;
   this->m_dst_height = dst_height;
   this->m_dst_pix_fmt = dst_pix_fmt;
   this->m_src_width = src_width;
   this->m_src_height = src_height;
   this->m_src_pix_fmt = src_pix_fmt;
+  this->m_row_decimation = false;
+  this->m_src_row_step = 1;
+  this->m_luma_only = false;
+  this->m_src_full_range = false;
+  this->reset_context();
 }
 
-void VideoConverter::reset_dst_size(int dst_width, int dst_height) {
-  if (dst_width == this->m_dst_width && dst_height == this->m_dst_height)
-    return;
+void VideoConverter::reset_context() {
+  this->m_src_row_step = this->m_row_decimation ? src_row_step_for(
+  this->m_src_height, this->m_dst_height, this->m_src_pix_fmt) : 1;
+
+  this->m_luma_only = this->m_dst_pix_fmt == AV_PIX_FMT_GRAY8
+    && has_gray8_luma_plane(this->m_src_pix_fmt);
 
   sws_freeContext(this->m_context);
   this->m_context = sws_getContext(
-      this->m_src_width, this->m_src_height, this->m_src_pix_fmt, 
-      dst_width, dst_height, this->m_dst_pix_fmt, 
+      this->m_src_width, this->m_src_height / this->m_src_row_step,
+      this->m_luma_only ? AV_PIX_FMT_GRAY8 : this->m_src_pix_fmt, 
+      this->m_dst_width, this->m_dst_height, this->m_dst_pix_fmt, 
       SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+
   if (this->m_context == nullptr) {
     throw std::runtime_error(fmt::format("[{}] Allocation of internal "
     "SwsContext of Video Converter failed", FUNCDINFO));
   }
 
+  if (this->m_luma_only && !this->m_src_full_range) {
+    // luma read as GRAY8 is still limited range, so stretch it to full range
+    const int* coefficients = sws_getCoefficients(SWS_CS_DEFAULT);
+    sws_setColorspaceDetails(this->m_context, coefficients, 0, coefficients,
+    1, 0, 1 << 16, 1 << 16);
+  }
+}
+
+void VideoConverter::reset_dst_size(int dst_width, int dst_height) {
+  if (dst_width == this->m_dst_width && dst_height == this->m_dst_height)
+    return;
+
   this->m_dst_width = dst_width;
   this->m_dst_height = dst_height;
+  this->reset_context();
+}
+
+void VideoConverter::reset_dst_pix_fmt(enum AVPixelFormat dst_pix_fmt) {
+  if (dst_pix_fmt == this->m_dst_pix_fmt) return;
+  if (dst_pix_fmt == AV_PIX_FMT_NONE) {
+    throw std::runtime_error(fmt::format("[{}] Video Converter must have a "
+    "defined dest pixel format: got AV_PIX_FMT_NONE", FUNCDINFO));
+  }
+
+  this->m_dst_pix_fmt = dst_pix_fmt;
+  this->reset_context();
+}
+
+void VideoConverter::set_row_decimation(bool row_decimation) {
+  if (row_decimation == this->m_row_decimation) return;
+  this->m_row_decimation = row_decimation;
+  this->reset_context();
 }
 
 VideoConverter::~VideoConverter() {
@@ -98,9 +161,34 @@ AVFrame* VideoConverter::convert_video_frame(AVFrame* original) {
     "allocating buffers for resized video frame", FUNCDINFO), err);
   }
 
-  (void)sws_scale(this->m_context,
-    (uint8_t const * const *)original->data, original->linesize, 0,
-    original->height, resized_video_frame->data, resized_video_frame->linesize);
-
+  this->convert_video_frame(original, resized_video_frame->data[0],
+  resized_video_frame->linesize[0]);
   return resized_video_frame;
+}
+
+void VideoConverter::convert_video_frame(AVFrame* original, uint8_t* dst, int dst_linesize) {
+  const bool src_full_range = original->color_range == AVCOL_RANGE_JPEG;
+  if (original->width != this->m_src_width || original->height != this->m_src_height
+    || original->format != this->m_src_pix_fmt || src_full_range != this->m_src_full_range) {
+    this->m_src_width = original->width;
+    this->m_src_height = original->height;
+    this->m_src_pix_fmt = static_cast<enum AVPixelFormat>(original->format);
+    this->m_src_full_range = src_full_range;
+    this->reset_context();
+  }
+
+  // reading with a stride of several rows skips the rows in between
+  const int nb_src_planes = this->m_luma_only ? 1 : AV_NUM_DATA_POINTERS;
+  const uint8_t* src_data[AV_NUM_DATA_POINTERS] = { nullptr };
+  int src_linesize[AV_NUM_DATA_POINTERS] = { 0 };
+  for (int i = 0; i < nb_src_planes; i++) {
+    src_data[i] = original->data[i];
+    src_linesize[i] = original->linesize[i] * this->m_src_row_step;
+  }
+
+  uint8_t* const dst_data[4] = { dst, nullptr, nullptr, nullptr };
+  const int dst_linesizes[4] = { dst_linesize, 0, 0, 0 };
+  (void)sws_scale(this->m_context,
+    src_data, src_linesize, 0,
+    original->height / this->m_src_row_step, dst_data, dst_linesizes);
 }
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include <tmedia/image/boxfilter.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+  #define TMEDIA_BOX_FILTER_AVX2
+  #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define TMEDIA_BOX_FILTER_SSE2
+  #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #define TMEDIA_BOX_FILTER_NEON
+  #include <arm_neon.h>
+#endif
+
+/**
+ * 16-bit accumulators can hold the sum of at most this many 8-bit rows
+*/
+static constexpr int MAX_U16_ACCUMULATED_ROWS = 0xFFFF / 0xFF;
+
+/**
+ * The half-open range of source pixels covered by a destination pixel along
+ * one axis
+*/
+struct BoxSpan {
+  int begin;
+  int end;
+};
+
+static void compute_spans(int src_size, int dst_size, std::vector<BoxSpan>& spans) {
+  spans.resize(static_cast<std::size_t>(dst_size));
+  for (int i = 0; i < dst_size; i++) {
+    const int begin = std::min(src_size - 1, static_cast<int>(static_cast<std::int64_t>(i) * src_size / dst_size));
+    const int end = static_cast<int>(static_cast<std::int64_t>(i + 1) * src_size / dst_size);
+    spans[i] = BoxSpan{begin, std::max(begin + 1, end)};
+  }
+}
+
+/**
+ * Adds every byte of row to the accumulator at the same index
+*/
+static void accumulate_row(std::uint16_t* acc, const std::uint8_t* row, std::size_t size) noexcept {
+  std::size_t i = 0;
+#if defined(TMEDIA_BOX_FILTER_AVX2)
+  for (; i + 16 <= size; i += 16) {
+    const __m256i bytes = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)));
+    __m256i* const sums = reinterpret_cast<__m256i*>(acc + i);
+    _mm256_storeu_si256(sums, _mm256_add_epi16(_mm256_loadu_si256(sums), bytes));
+  }
+#elif defined(TMEDIA_BOX_FILTER_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= size; i += 16) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+    __m128i* const sums_lo = reinterpret_cast<__m128i*>(acc + i);
+    __m128i* const sums_hi = reinterpret_cast<__m128i*>(acc + i + 8);
+    _mm_storeu_si128(sums_lo, _mm_add_epi16(_mm_loadu_si128(sums_lo), _mm_unpacklo_epi8(bytes, zero)));
+    _mm_storeu_si128(sums_hi, _mm_add_epi16(_mm_loadu_si128(sums_hi), _mm_unpackhi_epi8(bytes, zero)));
+  }
+#elif defined(TMEDIA_BOX_FILTER_NEON)
+  for (; i + 16 <= size; i += 16) {
+    const uint8x16_t bytes = vld1q_u8(row + i);
+    vst1q_u16(acc + i, vaddw_u8(vld1q_u16(acc + i), vget_low_u8(bytes)));
+    vst1q_u16(acc + i + 8, vaddw_u8(vld1q_u16(acc + i + 8), vget_high_u8(bytes)));
+  }
+#endif
+  for (; i < size; i++) {
+    acc[i] = static_cast<std::uint16_t>(acc[i] + row[i]);
+  }
+}
+
+static void accumulate_row(std::uint32_t* acc, const std::uint8_t* row, std::size_t size) noexcept {
+  for (std::size_t i = 0; i < size; i++) {
+    acc[i] += row[i];
+  }
+}
+
+/**
+ * Averages the accumulated columns covered by every destination pixel of a
+ * row, where every accumulator holds the sum of nb_rows source rows
+*/
+template <int Channels, typename Acc>
+static void average_columns(const Acc* acc, const std::vector<BoxSpan>& col_spans, int nb_rows, std::uint8_t* dst) noexcept {
+  for (const BoxSpan& span : col_spans) {
+    std::uint32_t sums[Channels] = {};
+    for (int col = span.begin; col < span.end; col++) {
+      for (int c = 0; c < Channels; c++) {
+        sums[c] += acc[col * Channels + c];
+      }
+    }
+
+    const std::uint32_t count = static_cast<std::uint32_t>(nb_rows * (span.end - span.begin));
+    for (int c = 0; c < Channels; c++) {
+      *dst++ = static_cast<std::uint8_t>((sums[c] + count / 2) / count);
+    }
+  }
+}
+
+template <typename Acc>
+static void box_filter_rows(const std::uint8_t* src, int src_width, int channels,
+  std::uint8_t* dst, const std::vector<BoxSpan>& row_spans, const std::vector<BoxSpan>& col_spans) {
+  const std::size_t row_size = static_cast<std::size_t>(src_width) * channels;
+  const std::size_t dst_row_size = col_spans.size() * channels;
+  thread_local std::vector<Acc> acc;
+  acc.resize(row_size);
+
+  for (const BoxSpan& span : row_spans) {
+    std::fill(acc.begin(), acc.end(), 0);
+    for (int row = span.begin; row < span.end; row++) {
+      accumulate_row(acc.data(), src + row * row_size, row_size);
+    }
+
+    const int nb_rows = span.end - span.begin;
+    switch (channels) {
+      case 1: average_columns<1>(acc.data(), col_spans, nb_rows, dst); break;
+      case 3: average_columns<3>(acc.data(), col_spans, nb_rows, dst); break;
+      case 4: average_columns<4>(acc.data(), col_spans, nb_rows, dst); break;
+      default: { // not used by tmedia, so left generic
+        for (std::size_t i = 0; i < col_spans.size(); i++) {
+          const BoxSpan& col_span = col_spans[i];
+          const std::uint32_t count = static_cast<std::uint32_t>(nb_rows * (col_span.end - col_span.begin));
+          for (int c = 0; c < channels; c++) {
+            std::uint32_t sum = 0;
+            for (int col = col_span.begin; col < col_span.end; col++) sum += acc[col * channels + c];
+            dst[i * channels + c] = static_cast<std::uint8_t>((sum + count / 2) / count);
+          }
+        }
+      }
+    }
+    dst += dst_row_size;
+  }
+}
+
+void box_filter(const std::uint8_t* src, int src_width, int src_height, int channels,
+  std::uint8_t* dst, int dst_width, int dst_height) {
+  if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0 || channels <= 0)
+    return;
+
+  thread_local std::vector<BoxSpan> row_spans;
+  thread_local std::vector<BoxSpan> col_spans;
+  compute_spans(src_height, dst_height, row_spans);
+  compute_spans(src_width, dst_width, col_spans);
+
+  int max_span_rows = 0;
+  for (const BoxSpan& span : row_spans)
+    max_span_rows = std::max(max_span_rows, span.end - span.begin);
+
+  if (max_span_rows <= MAX_U16_ACCUMULATED_ROWS) {
+    box_filter_rows<std::uint16_t>(src, src_width, channels, dst, row_spans, col_spans);
+  } else {
+    box_filter_rows<std::uint32_t>(src, src_width, channels, dst, row_spans, col_spans);
+  }
+}
@@ -0,0 +1,40 @@
+#include <tmedia/image/pixelbufferpool.h>
+
+#include <tmedia/image/color.h>
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+template <typename Pixel>
+PixelBufferPool<Pixel>::PixelBufferPool(std::size_t capacity) {
+  this->m_capacity = capacity;
+  this->m_buffers.reserve(capacity);
+}
+
+template <typename Pixel>
+std::shared_ptr<std::vector<Pixel>> PixelBufferPool<Pixel>::acquire(std::size_t nb_pixels) {
+  for (std::shared_ptr<std::vector<Pixel>>& buffer : this->m_buffers) {
+    if (buffer.use_count() == 1) { // only referenced by the pool
+      // use_count is a relaxed load, so make sure another thread's last reads
+      // of the buffer happen before it is written to again
+      std::atomic_thread_fence(std::memory_order_acquire);
+      buffer->resize(nb_pixels);
+      return buffer;
+    }
+  }
+
+  std::shared_ptr<std::vector<Pixel>> buffer = std::make_shared<std::vector<Pixel>>(nb_pixels);
+  if (this->m_buffers.size() < this->m_capacity) this->m_buffers.push_back(buffer);
+  return buffer;
+}
+
+template <typename Pixel>
+std::size_t PixelBufferPool<Pixel>::size() const noexcept {
+  return this->m_buffers.size();
+}
+
+template class PixelBufferPool<RGB24>;
+template class PixelBufferPool<std::uint8_t>;
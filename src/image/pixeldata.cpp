@@ -3,6 +3,7 @@
 #include <tmedia/image/color.h>
 #include <tmedia/util/wmath.h>
 #include <tmedia/image/scale.h>
+#include <tmedia/image/boxfilter.h>
 #include <tmedia/ffmpeg/decode.h>
 #include <tmedia/ffmpeg/boiler.h>
 #include <tmedia/ffmpeg/videoconverter.h>
@@ -18,6 +19,8 @@
 #include <cstdlib>
 #include <memory>
 #include <functional>
+#include <algorithm>
+#include <cmath>
 #include <utility>
 #include <memory>
 
@@ -29,6 +32,8 @@ extern "C" {
   #include <libavutil/frame.h>
 }
 
+static_assert(sizeof(RGB24) == 3, "RGB24 must be layout compatible with interleaved 8-bit RGB");
+
 // Accepts empty matrices
 template <typename T>
 bool is_rect_vec_mat(const std::vector<std::vector<T>>& vector_2d) {
@@ -45,8 +50,7 @@ bool is_rect_vec_mat(const std::vector<std::vector<T>>& vector_2d) {
 
 // remember to allocate this->pixels before calling init_from_avframe
 void PixelData::init_from_avframe(AVFrame* video_frame) {
-  this->pixels->clear();
-  this->pixels->reserve(video_frame->width * video_frame->height);
+  this->pixels->resize(video_frame->width * video_frame->height);
   this->m_width = video_frame->width;
   this->m_height = video_frame->height;
   const uint8_t* const data = video_frame->data[0];
@@ -82,7 +86,7 @@ PixelData::PixelData(const std::vector<std::vector<RGB24>>& rgbm) {
   this->pixels = std::make_shared<std::vector<RGB24>>();
   this->m_height = rgbm.size();
   this->m_width = rgbm.size() > 0 ? rgbm[0].size() : 0;
-  this->pixels->reserve(this->m_height * this->m_width);
+  this->pixels->resize(this->m_height * this->m_width);
 
   for (int row = 0; row < this->m_height; row++) {
     for (int col = 0; col < this->m_width; col++) {
@@ -100,7 +104,7 @@ PixelData::PixelData(const std::vector<std::vector<uint8_t> >& graym) {
   this->pixels = std::make_shared<std::vector<RGB24>>();
   this->m_height = graym.size();
   this->m_width = graym.size() > 0 ? graym[0].size() : 0;
-  this->pixels->reserve(this->m_height * this->m_width);
+  this->pixels->resize(this->m_height * this->m_width);
 
   for (int row = 0; row < this->m_height; row++) {
     for (int col = 0; col < this->m_width; col++) {
@@ -116,7 +120,7 @@ PixelData::PixelData(const std::vector<RGB24>& flatrgb, int width, int height) {
     "given height: {}", FUNCDINFO, flatrgb.size(), width, height));
 
   this->pixels = std::make_shared<std::vector<RGB24>>();
-  this->pixels->reserve(width * height);
+  this->pixels->resize(width * height);
   this->m_width = width;
   this->m_height = height;
   const int area = width * height; 
@@ -137,35 +141,52 @@ PixelData::PixelData(std::shared_ptr<std::vector<RGB24>> colors, int width, int
   this->m_height = height;
 }
 
+PixelData::PixelData(std::shared_ptr<std::vector<std::uint8_t>> grays, int width, int height) {
+  if (std::size_t(width * height) != grays->size()) 
+    throw std::runtime_error(fmt::format("[{}] Cannot initialize PixelData "
+    "with innacurate flattened gray vector: size = {}, given width: {}, "
+    "given height: {}", FUNCDINFO, grays->size(), width, height));
+
+  this->gray_pixels = grays;
+  this->m_width = width;
+  this->m_height = height;
+}
+
 PixelData::PixelData(AVFrame* video_frame) {
   this->pixels = std::make_shared<std::vector<RGB24>>();
   this->init_from_avframe(video_frame);
 }
 
 void PixelData::operator=(AVFrame* video_frame) {
+  if (!this->pixels) this->pixels = std::make_shared<std::vector<RGB24>>();
+  this->gray_pixels.reset();
   this->init_from_avframe(video_frame);
 }
 
 PixelData::PixelData(const PixelData& pix_data) {
   this->pixels = pix_data.pixels;
+  this->gray_pixels = pix_data.gray_pixels;
   this->m_width = pix_data.m_width;
   this->m_height = pix_data.m_height;
 }
 
 PixelData::PixelData(PixelData&& pix_data) {
   this->pixels = std::move(pix_data.pixels);
+  this->gray_pixels = std::move(pix_data.gray_pixels);
   this->m_width = pix_data.m_width;
   this->m_height = pix_data.m_height;
 }
 
 void PixelData::operator=(const PixelData& pix_data) {
   this->pixels = pix_data.pixels;
+  this->gray_pixels = pix_data.gray_pixels;
   this->m_width = pix_data.m_width;
   this->m_height = pix_data.m_height;
 }
 
 void PixelData::operator=(PixelData&& pix_data) {
   this->pixels = std::move(pix_data.pixels);
+  this->gray_pixels = std::move(pix_data.gray_pixels);
   this->m_width = pix_data.m_width;
   this->m_height = pix_data.m_height;
 }
@@ -182,24 +203,45 @@ PixelData PixelData::scale(double amount, ScalingAlgo scaling_algorithm) const {
 
   const int new_width = this->get_width() * amount;
   const int new_height = this->get_height() * amount;
+  if (this->is_gray()) return this->scale_gray(amount, new_width, new_height, scaling_algorithm);
+
   std::shared_ptr<std::vector<RGB24>> new_pixels = std::make_shared<std::vector<RGB24>>();
-  new_pixels->reserve(new_width * new_height);
 
   switch (scaling_algorithm) {
     case ScalingAlgo::BOX_SAMPLING: {
-      double box_width = 1 / amount;
-      double box_height = 1 / amount;
-
+      new_pixels->resize(new_width * new_height);
+      box_filter(reinterpret_cast<const std::uint8_t*>(this->pixels->data()), this->m_width, this->m_height,
+      3, reinterpret_cast<std::uint8_t*>(new_pixels->data()), new_width, new_height);
+    } break;
+    case ScalingAlgo::NEAREST_NEIGHBOR: {
+      new_pixels->reserve(new_width * new_height);
       for (double new_row = 0; new_row < new_height; new_row++) {
         for (double new_col = 0; new_col < new_width; new_col++) {
-          new_pixels->push_back(get_avg_color_from_area(*this, new_row * box_height, new_col * box_width, box_width, box_height ));
+          new_pixels->push_back((*this->pixels)[(int)(new_row / amount) * this->m_width + (int)(new_col / amount)]);
         }
       }
     } break;
+    default: throw std::runtime_error(fmt::format("[{}] unrecognized scaling "
+    "function", FUNCDINFO));
+  }
+
+  return PixelData(new_pixels, new_width, new_height);
+}
+
+PixelData PixelData::scale_gray(double amount, int new_width, int new_height, ScalingAlgo scaling_algorithm) const {
+  const std::vector<std::uint8_t>& grays = *this->gray_pixels;
+  std::shared_ptr<std::vector<std::uint8_t>> new_grays = std::make_shared<std::vector<std::uint8_t>>();
+
+  switch (scaling_algorithm) {
+    case ScalingAlgo::BOX_SAMPLING: {
+      new_grays->resize(new_width * new_height);
+      box_filter(grays.data(), this->m_width, this->m_height, 1, new_grays->data(), new_width, new_height);
+    } break;
     case ScalingAlgo::NEAREST_NEIGHBOR: {
+      new_grays->reserve(new_width * new_height);
       for (double new_row = 0; new_row < new_height; new_row++) {
         for (double new_col = 0; new_col < new_width; new_col++) {
-          new_pixels->push_back((*this->pixels)[(int)(new_row / amount) * this->m_width + (int)(new_col / amount)]);
+          new_grays->push_back(grays[(int)(new_row / amount) * this->m_width + (int)(new_col / amount)]);
         }
       }
     } break;
@@ -207,7 +249,7 @@ PixelData PixelData::scale(double amount, ScalingAlgo scaling_algorithm) const {
     "function", FUNCDINFO));
   }
 
-  return PixelData(new_pixels, new_width, new_height);
+  return PixelData(new_grays, new_width, new_height);
 }
 
 PixelData PixelData::bound(int width, int height, ScalingAlgo scaling_algorithm) const {
@@ -219,6 +261,50 @@ PixelData PixelData::bound(int width, int height, ScalingAlgo scaling_algorithm)
   return this->scale(scale_factor, scaling_algorithm);
 }
 
+PixelData PixelData::crop(int row, int col, int width, int height) const {
+  if (row < 0 || col < 0 || width < 0 || height < 0
+    || row + height > this->get_height() || col + width > this->get_width()) {
+    throw std::runtime_error(fmt::format("[{}] Cannot crop {}x{} pixels at "
+    "({}, {}) from {}x{} pixel data", FUNCDINFO, width, height, row, col,
+    this->get_width(), this->get_height()));
+  }
+
+  const std::size_t nb_pixels = static_cast<std::size_t>(width) * height;
+  if (this->is_gray()) {
+    std::shared_ptr<std::vector<uint8_t>> grays = std::make_shared<std::vector<uint8_t>>(nb_pixels);
+    for (int r = 0; r < height; r++) {
+      const uint8_t* src_row = this->gray_pixels->data() + static_cast<std::size_t>(row + r) * this->m_width + col;
+      std::copy(src_row, src_row + width, grays->data() + static_cast<std::size_t>(r) * width);
+    }
+    return PixelData(grays, width, height);
+  }
+
+  std::shared_ptr<std::vector<RGB24>> colors = std::make_shared<std::vector<RGB24>>(nb_pixels);
+  for (int r = 0; r < height; r++) {
+    const RGB24* src_row = this->pixels->data() + static_cast<std::size_t>(row + r) * this->m_width + col;
+    std::copy(src_row, src_row + width, colors->data() + static_cast<std::size_t>(r) * width);
+  }
+  return PixelData(colors, width, height);
+}
+
+PixelData PixelData::resize(int width, int height) const {
+  if (width <= 0 || height <= 0 || this->get_width() == 0 || this->get_height() == 0) {
+    return PixelData();
+  }
+
+  const std::size_t nb_pixels = static_cast<std::size_t>(width) * height;
+  if (this->is_gray()) {
+    std::shared_ptr<std::vector<uint8_t>> grays = std::make_shared<std::vector<uint8_t>>(nb_pixels);
+    box_filter(this->gray_pixels->data(), this->m_width, this->m_height, 1, grays->data(), width, height);
+    return PixelData(grays, width, height);
+  }
+
+  std::shared_ptr<std::vector<RGB24>> colors = std::make_shared<std::vector<RGB24>>(nb_pixels);
+  box_filter(reinterpret_cast<const uint8_t*>(this->pixels->data()), this->m_width, this->m_height, 3,
+  reinterpret_cast<uint8_t*>(colors->data()), width, height);
+  return PixelData(colors, width, height);
+}
+
 bool PixelData::equals(const PixelData& pix_data) const {
   if (this->get_width() != pix_data.get_width() || this->get_height() != pix_data.get_height()) {
     return false;
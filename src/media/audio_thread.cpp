@@ -24,14 +24,20 @@ void MediaFetcher::audio_dispatch_thread_func() {
   
   static constexpr int AUDIO_THREAD_PAUSED_SLEEP_MS = 25;
   static constexpr int AUDIO_BUFFER_TRY_WRITE_WAIT_MS = 25;
+  static constexpr int AUDIO_PACKET_TRY_POP_WAIT_MS = 25;
 
   try { // super try block :)
-    MediaDecoder adec(this->mdec->path, { AVMEDIA_TYPE_AUDIO });
-    if (!adec.has_stream_decoder(AVMEDIA_TYPE_AUDIO)) return; // copy failed?
     AudioResampler audio_resampler(
-    adec.get_ch_layout(), AV_SAMPLE_FMT_FLT, adec.get_sample_rate(),
-    adec.get_ch_layout(), adec.get_sample_fmt(), adec.get_sample_rate());
-    sleep_for_sec(adec.get_start_time(AVMEDIA_TYPE_AUDIO));
+    this->mdec->get_ch_layout(), AV_SAMPLE_FMT_FLT, this->mdec->get_sample_rate(),
+    this->mdec->get_ch_layout(), this->mdec->get_sample_fmt(), this->mdec->get_sample_rate());
+    sleep_for_sec(this->mdec->get_start_time(AVMEDIA_TYPE_AUDIO));
+
+    const double time_base = this->mdec->get_time_base(AVMEDIA_TYPE_AUDIO);
+    PacketQueue& pkt_queue = *(this->pkt_queues[AVMEDIA_TYPE_AUDIO]);
+    StreamDecoder& adec = this->mdec->get_stream_decoder(AVMEDIA_TYPE_AUDIO);
+    std::vector<AVFrame*> next_raw_audio_frames;
+    int serial = 0;
+    double jump_time = 0.0;
 
     while (!this->should_exit()) {
       if (!this->is_playing()) {
@@ -41,34 +47,28 @@ void MediaFetcher::audio_dispatch_thread_func() {
         }
       }
 
-      std::vector<AVFrame*> next_raw_audio_frames;
-      int msg_audio_jump_curr_time_cache = 0;
-      double current_time = 0;
-
-      {
-        next_raw_audio_frames = adec.next_frames(AVMEDIA_TYPE_AUDIO);
-        std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
-        current_time = this->clock.get_time(sys_clk_sec());
-        msg_audio_jump_curr_time_cache = this->msg_audio_jump_curr_time;
-      }
+      const int prev_serial = serial;
+      this->decode_next_frames(AVMEDIA_TYPE_AUDIO, serial, AUDIO_PACKET_TRY_POP_WAIT_MS, next_raw_audio_frames);
 
-      if (msg_audio_jump_curr_time_cache > 0) {
-        this->audio_buffer->clear(current_time);
-        adec.jump_to_time(current_time);
-        next_raw_audio_frames = adec.next_frames(AVMEDIA_TYPE_AUDIO);
-        
-        std::scoped_lock<std::mutex> lock(this->alter_mutex);
-        this->msg_audio_jump_curr_time--;
+      if (serial != prev_serial) { // the packet queue was flushed by a jump
+        {
+          std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+          jump_time = this->clock.get_time(sys_clk_sec());
+        }
+        this->audio_buffer->clear(jump_time);
       }
 
       for (std::size_t i = 0; i < next_raw_audio_frames.size(); i++) {
+        // the demuxer seeks to before the jump time, so skip what was already passed
+        if (next_raw_audio_frames[i]->pts != AV_NOPTS_VALUE && next_raw_audio_frames[i]->pts * time_base < jump_time) continue;
+
         AVFrame* frame = audio_resampler.resample_audio_frame(next_raw_audio_frames[i]);
         while (!this->audio_buffer->try_write_into(frame->nb_samples, (float*)(frame->data[0]), AUDIO_BUFFER_TRY_WRITE_WAIT_MS)) {
-          if (this->should_exit()) break;
+          if (this->should_exit() || pkt_queue.get_serial() != serial) break;
         }
         av_frame_free(&frame);
       }
-      clear_avframe_list(next_raw_audio_frames);
+      adec.release_frames(next_raw_audio_frames);
     }
   } catch (std::exception const& err) {
     std::lock_guard<std::mutex> lock(this->alter_mutex);
@@ -0,0 +1,40 @@
+#include <tmedia/media/catchup.h>
+
+#include <cmath>
+
+CatchupController::CatchupController() {
+  this->reset();
+}
+
+int CatchupController::update(double lag_secs, double frame_duration_secs, double frame_pts_secs) {
+  this->m_frames_since_change++;
+
+  if (lag_secs > ESCALATE_LAG_FRAMES * frame_duration_secs) {
+    this->m_streak_start_pts = NAN;
+    if (this->m_level < MAX_LEVEL && this->m_frames_since_change >= SETTLE_FRAMES) {
+      this->m_level++;
+      this->m_frames_since_change = 0;
+    }
+  } else if (lag_secs < RELAX_LAG_FRAMES * frame_duration_secs) {
+    if (!std::isfinite(this->m_streak_start_pts)) this->m_streak_start_pts = frame_pts_secs;
+    if (this->m_level > 0 && frame_pts_secs - this->m_streak_start_pts >= RELAX_SECS) {
+      this->m_level--;
+      this->m_streak_start_pts = frame_pts_secs; // the new level must stay on time on its own
+      this->m_frames_since_change = 0;
+    }
+  } else {
+    this->m_streak_start_pts = NAN;
+  }
+
+  return this->m_level;
+}
+
+int CatchupController::level() const noexcept {
+  return this->m_level;
+}
+
+void CatchupController::reset() noexcept {
+  this->m_level = 0;
+  this->m_streak_start_pts = NAN;
+  this->m_frames_since_change = 0;
+}
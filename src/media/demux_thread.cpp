@@ -0,0 +1,156 @@
+#include <tmedia/media/mediafetcher.h>
+
+#include <tmedia/ffmpeg/avpool.h>
+#include <tmedia/util/wtime.h>
+#include <tmedia/util/wmath.h>
+
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <optional>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+/**
+ * The demux thread is the only thread which reads from the MediaFetcher's
+ * media file. Every packet is read exactly once and routed into the packet
+ * queue of its stream, where it is decoded by the video or audio thread.
+ * 
+ * Seeking the file is also done here, once the demux thread receives a jump
+ * message. MediaFetcher::jump_to_time flushes the packet queues itself, so any
+ * packets read before the seek are dropped as outdated when pushed.
+ * 
+ * Unless the container already indexes every keyframe, the keyframes of the
+ * video packets read are also added to kf_index, for as long as reading has
+ * continued on from the indexed part of the stream. Reading straight through
+ * the file this way indexes it without reading anything twice.
+*/
+void MediaFetcher::demux_thread_func() {
+  static constexpr int PACKET_QUEUE_TRY_PUSH_WAIT_MS = 25;
+  static constexpr int DEMUX_EOF_SLEEP_MS = 100;
+  static constexpr int KEYFRAME_PUBLISH_PACKETS = 64; // video packets read between updates of kf_index
+
+  std::array<int, AVMEDIA_TYPE_NB> serials;
+  serials.fill(0);
+  bool eof = false;
+  AVPacketPool& pkt_pool = *(this->mdec->get_packet_pool());
+
+  // reading begins at the start of the stream, which is where the indexed
+  // part of the stream begins as well
+  bool indexing = this->media_type == MediaType::VIDEO && this->has_media_stream(AVMEDIA_TYPE_VIDEO);
+  bool index_contiguous = true;
+  std::vector<int64_t> keyframes;
+  int64_t read_until = INT64_MIN;
+  int nb_unpublished = 0;
+
+  try {
+    while (!this->should_exit()) {
+      bool req_jump = false;
+      double jump_time = 0.0;
+      std::optional<int64_t> jump_keyframe;
+
+      {
+        std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+        if (indexing && this->kf_index.is_complete()) indexing = false;
+        if (this->msg_demux_jump_curr_time > 0) {
+          req_jump = true;
+          jump_time = clamp(this->get_time(sys_clk_sec()), 0.0, this->get_duration());
+          this->msg_demux_jump_curr_time = 0;
+          if (indexing && index_contiguous) {
+            for (int64_t keyframe : keyframes) this->kf_index.insert(keyframe);
+            this->kf_index.set_indexed_until(read_until);
+          }
+          keyframes.clear();
+          nb_unpublished = 0;
+          index_contiguous = false; // until reading is found to land inside the indexed part
+          if (this->has_media_stream(AVMEDIA_TYPE_VIDEO)) {
+            const double time_base = this->mdec->get_time_base(AVMEDIA_TYPE_VIDEO);
+            jump_keyframe = this->msg_demux_jump_keyframe ? this->msg_demux_jump_keyframe
+            : this->kf_index.floor(static_cast<int64_t>(jump_time / time_base));
+            this->msg_demux_jump_keyframe.reset();
+          }
+
+          // queues are only ever flushed under alter_mutex, so these serials
+          // are guaranteed to belong to this jump
+          for (int i = 0; i < AVMEDIA_TYPE_NB; i++) {
+            if (this->pkt_queues[i]) serials[i] = this->pkt_queues[i]->get_serial();
+          }
+        }
+      }
+
+      if (req_jump) {
+        // landing exactly on the preceding keyframe bounds how many frames
+        // must be decoded before reaching the jump time
+        if (!jump_keyframe || this->mdec->seek_keyframe(AVMEDIA_TYPE_VIDEO, *jump_keyframe) < 0) {
+          this->mdec->seek(jump_time);
+        }
+        eof = false;
+      }
+
+      if (eof) {
+        std::unique_lock<std::mutex> exit_lock(this->ex_noti_mtx);
+        if (!this->should_exit()) {
+          this->exit_cond.wait_for(exit_lock, std::chrono::milliseconds(DEMUX_EOF_SLEEP_MS));
+        }
+        continue;
+      }
+
+      enum AVMediaType packet_type = AVMEDIA_TYPE_UNKNOWN;
+      AVPacket* packet = pkt_pool.acquire();
+      if (this->mdec->read_packet(packet, packet_type) < 0) {
+        pkt_pool.release(packet);
+        for (int i = 0; i < AVMEDIA_TYPE_NB; i++) {
+          if (this->pkt_queues[i]) this->pkt_queues[i]->set_eof(serials[i]);
+        }
+        if (indexing && index_contiguous) {
+          std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+          for (int64_t keyframe : keyframes) this->kf_index.insert(keyframe);
+          this->kf_index.set_indexed_until(read_until);
+          this->kf_index.set_complete();
+          keyframes.clear();
+          indexing = false;
+        }
+        eof = true;
+        continue;
+      }
+
+      if (indexing && packet_type == AVMEDIA_TYPE_VIDEO && packet->pts != AV_NOPTS_VALUE) {
+        const bool keyframe = packet->flags & AV_PKT_FLAG_KEY;
+        if (!index_contiguous && keyframe) {
+          // reading on from a keyframe already indexed continues the indexed part
+          std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+          index_contiguous = packet->pts <= this->kf_index.get_indexed_until();
+        }
+
+        if (index_contiguous) {
+          if (keyframe) keyframes.push_back(packet->pts);
+          read_until = std::max(read_until, packet->pts);
+          if (++nb_unpublished >= KEYFRAME_PUBLISH_PACKETS) {
+            std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+            for (int64_t kf : keyframes) this->kf_index.insert(kf);
+            this->kf_index.set_indexed_until(read_until);
+            keyframes.clear();
+            nb_unpublished = 0;
+          }
+        }
+      }
+
+      PacketQueue& pkt_queue = *(this->pkt_queues[packet_type]);
+      while (!pkt_queue.try_push(packet, serials[packet_type], PACKET_QUEUE_TRY_PUSH_WAIT_MS)) {
+        if (this->should_exit()) {
+          pkt_pool.release(packet);
+          break;
+        }
+      }
+    }
+  } catch (std::exception const& err) {
+    std::lock_guard<std::mutex> lock(this->alter_mutex);
+    this->dispatch_exit(err.what());
+  }
+}
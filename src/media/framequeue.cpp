@@ -0,0 +1,105 @@
+#include <tmedia/media/framequeue.h>
+
+#include <cassert>
+#include <memory>
+#include <utility>
+
+// besides one frame pushed past capacity, one slot is held by the presenter
+// and one is kept free, so that the producer's tail never reaches the
+// presenter's head
+FrameQueue::FrameQueue(std::size_t capacity) : m_slots(capacity + 3),
+  m_capacity(capacity), m_head(0), m_tail(0), m_held(NO_SLOT), m_serial(0) {}
+
+bool FrameQueue::full() const noexcept {
+  const std::size_t tail = this->m_tail.load(std::memory_order_relaxed);
+  const std::size_t head = this->m_head.load(std::memory_order_acquire);
+  return tail - head >= this->m_capacity
+    || tail % this->m_slots.size() == this->m_held.load(std::memory_order_acquire);
+}
+
+unsigned int FrameQueue::serial() const noexcept {
+  return this->m_serial.load(std::memory_order_acquire);
+}
+
+bool FrameQueue::push(const PixelData& frame, double pts, unsigned int serial, std::shared_ptr<const CellFrame> cells) {
+  const std::size_t tail = this->m_tail.load(std::memory_order_relaxed);
+  const std::size_t head = this->m_head.load(std::memory_order_acquire);
+  const std::size_t slot = tail % this->m_slots.size();
+  if (tail - head >= this->m_slots.size() - 2 || slot == this->m_held.load(std::memory_order_acquire))
+    return false;
+
+  this->m_slots[slot].frame = frame;
+  this->m_slots[slot].cells = std::move(cells);
+  this->m_slots[slot].pts = pts;
+  this->m_slots[slot].serial = serial;
+  this->m_tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+std::optional<PixelData> FrameQueue::presented() const {
+  const std::size_t held = this->m_held.load(std::memory_order_acquire);
+  if (held == NO_SLOT) return std::nullopt;
+  return this->m_slots[held].frame;
+}
+
+void FrameQueue::drop_outdated() noexcept {
+  const unsigned int serial = this->m_serial.load(std::memory_order_relaxed);
+  const std::size_t tail = this->m_tail.load(std::memory_order_acquire);
+  std::size_t head = this->m_head.load(std::memory_order_relaxed);
+  while (head != tail && this->m_slots[head % this->m_slots.size()].serial != serial) {
+    head++;
+  }
+  this->m_head.store(head, std::memory_order_release);
+}
+
+PixelData FrameQueue::pop_held() noexcept {
+  const std::size_t head = this->m_head.load(std::memory_order_relaxed);
+  const std::size_t slot = head % this->m_slots.size();
+  PixelData frame = this->m_slots[slot].frame;
+  this->m_held.store(slot, std::memory_order_release); // before head, so the slot is never seen as free
+  this->m_head.store(head + 1, std::memory_order_release);
+  return frame;
+}
+
+bool FrameQueue::empty() noexcept {
+  this->drop_outdated();
+  return this->m_head.load(std::memory_order_relaxed) == this->m_tail.load(std::memory_order_acquire);
+}
+
+std::size_t FrameQueue::size() const noexcept {
+  return this->m_tail.load(std::memory_order_acquire) - this->m_head.load(std::memory_order_acquire);
+}
+
+std::optional<double> FrameQueue::front_pts() noexcept {
+  if (this->empty()) return std::nullopt;
+  return this->m_slots[this->m_head.load(std::memory_order_relaxed) % this->m_slots.size()].pts;
+}
+
+std::shared_ptr<const CellFrame> FrameQueue::popped_cells() const {
+  const std::size_t held = this->m_held.load(std::memory_order_relaxed);
+  if (held == NO_SLOT) return nullptr;
+  return this->m_slots[held].cells;
+}
+
+std::optional<PixelData> FrameQueue::pop_due(double time) {
+  std::optional<PixelData> due;
+  while (!this->empty()) {
+    if (this->m_slots[this->m_head.load(std::memory_order_relaxed) % this->m_slots.size()].pts > time) break;
+    due = this->pop_held();
+  }
+  return due;
+}
+
+PixelData FrameQueue::pop_front() {
+  const bool has_front = !this->empty(); // also drops outdated frames
+  assert(has_front);
+  (void)has_front;
+  return this->pop_held();
+}
+
+void FrameQueue::clear() noexcept {
+  // frames pushed after the head moves can only carry the old serial until
+  // the serial is incremented, so they are dropped as outdated
+  this->m_head.store(this->m_tail.load(std::memory_order_acquire), std::memory_order_release);
+  this->m_serial.fetch_add(1, std::memory_order_acq_rel);
+}
@@ -0,0 +1,146 @@
+#include <tmedia/media/mediafetcher.h>
+
+#include <tmedia/ffmpeg/boiler.h>
+#include <tmedia/ffmpeg/ffmpeg_error.h>
+#include <tmedia/util/defines.h>
+
+#include <vector>
+#include <optional>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+#include <fmt/format.h>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+/**
+ * Extends the video keyframe index past the part the demux thread has indexed,
+ * for jumps that land beyond it (see MediaFetcher::request_keyframe_index).
+ * 
+ * The demux thread indexes keyframes as it reads packets, so this only does
+ * anything once a jump asks for more than has been read. The scan then reads
+ * the video packets themselves (not just their headers) through a separate
+ * AVFormatContext, starting from the last indexed keyframe, and stops once the
+ * requested timestamp has been indexed. Reading is done in short batches with
+ * a pause in between, so the scan does not compete with playback for the disk.
+ * Nothing is decoded.
+ * 
+ * Failing to build the index is not an error, as seeking falls back to
+ * FFmpeg's own seeking.
+*/
+void MediaFetcher::keyframe_indexing_thread_func() {
+  static constexpr int KEYFRAME_INDEXING_POLL_MS = 100;
+  static constexpr int KEYFRAME_INDEXING_BATCH_PAUSE_MS = 5;
+  static constexpr int KEYFRAME_INDEXING_BATCH_PACKETS = 256;
+
+  if (this->media_type != MediaType::VIDEO) return;
+  if (!this->has_media_stream(AVMEDIA_TYPE_VIDEO)) return;
+
+  AVFormatContext* fmt_ctx = nullptr;
+  AVPacket* packet = nullptr;
+
+  try {
+    const int video_stream_index = this->mdec->get_stream_decoder(AVMEDIA_TYPE_VIDEO).get_stream_index();
+    int64_t scanned_until = INT64_MIN; // latest video timestamp read by fmt_ctx
+    std::vector<int64_t> keyframes;
+
+    while (!this->should_exit()) {
+      int64_t index_until = INT64_MIN;
+      int64_t indexed_until = INT64_MIN;
+      std::optional<int64_t> resume_keyframe = std::nullopt;
+
+      {
+        std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+        if (this->kf_index.is_complete()) break;
+        index_until = this->msg_index_until;
+        indexed_until = this->kf_index.get_indexed_until();
+        if (indexed_until > scanned_until) resume_keyframe = this->kf_index.floor(indexed_until);
+      }
+
+      if (index_until <= indexed_until) {
+        std::unique_lock<std::mutex> exit_lock(this->ex_noti_mtx);
+        if (!this->should_exit())
+          this->exit_cond.wait_for(exit_lock, std::chrono::milliseconds(KEYFRAME_INDEXING_POLL_MS));
+        continue;
+      }
+
+      if (fmt_ctx == nullptr) {
+        fmt_ctx = open_format_context(this->path);
+        packet = av_packet_alloc();
+        if (unlikely(packet == nullptr)) {
+          throw ffmpeg_error(fmt::format("[{}] Failed to allocate AVPacket",
+          FUNCDINFO), AVERROR(ENOMEM));
+        }
+
+        // the same file opens with the same stream layout as mdec
+        for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+          if ((int)i != video_stream_index) fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+      }
+
+      // the demux thread may have indexed past where this scan is, in which
+      // case the scan skips ahead to the last keyframe indexed. Without any
+      // keyframe to go to, only a scan that has not moved from the start of
+      // the file still continues on from the indexed part.
+      bool check_contiguous = false;
+      if (indexed_until > scanned_until) {
+        if (resume_keyframe.has_value()) {
+          if (av_seek_frame(fmt_ctx, video_stream_index, *resume_keyframe, AVSEEK_FLAG_BACKWARD) < 0) break;
+          check_contiguous = true;
+        } else if (scanned_until != INT64_MIN) {
+          break;
+        }
+      }
+
+      bool scan_finished = false;
+      bool scan_lost = false;
+      for (int i = 0; i < KEYFRAME_INDEXING_BATCH_PACKETS && scanned_until <= index_until; i++) {
+        const int res = av_read_frame(fmt_ctx, packet);
+        scan_finished = res == AVERROR_EOF;
+        scan_lost = res < 0 && !scan_finished;
+        if (res < 0) break;
+
+        if (packet->stream_index == video_stream_index && packet->pts != AV_NOPTS_VALUE) {
+          if (check_contiguous) {
+            // the seek must land inside the indexed part, or keyframes could be skipped
+            scan_lost = packet->pts > indexed_until;
+            check_contiguous = false;
+          }
+
+          if (!scan_lost) {
+            if (packet->flags & AV_PKT_FLAG_KEY) keyframes.push_back(packet->pts);
+            scanned_until = std::max(scanned_until, packet->pts);
+          }
+        }
+        av_packet_unref(packet);
+        if (scan_lost) break;
+      }
+
+      if (scan_lost) break;
+
+      {
+        std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+        for (int64_t keyframe : keyframes) this->kf_index.insert(keyframe);
+        this->kf_index.set_indexed_until(scanned_until);
+        if (scan_finished) this->kf_index.set_complete();
+      }
+      keyframes.clear();
+
+      if (scan_finished) break;
+      if (scanned_until <= index_until) {
+        std::unique_lock<std::mutex> exit_lock(this->ex_noti_mtx);
+        if (!this->should_exit())
+          this->exit_cond.wait_for(exit_lock, std::chrono::milliseconds(KEYFRAME_INDEXING_BATCH_PAUSE_MS));
+      }
+    }
+  } catch (const std::exception& err) {
+    // no-op, jumps continue to seek without the index
+  }
+
+  av_packet_free(&packet);
+  if (fmt_ctx != nullptr) avformat_close_input(&fmt_ctx);
+}
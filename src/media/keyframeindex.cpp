@@ -0,0 +1,63 @@
+#include <tmedia/media/keyframeindex.h>
+
+#include <algorithm>
+#include <limits>
+
+KeyframeIndex::KeyframeIndex() {
+  this->clear();
+}
+
+void KeyframeIndex::insert(int64_t keyframe_ts) {
+  if (this->m_keyframes.empty() || this->m_keyframes.back() < keyframe_ts) {
+    this->m_keyframes.push_back(keyframe_ts);
+  } else {
+    auto it = std::lower_bound(this->m_keyframes.begin(), this->m_keyframes.end(), keyframe_ts);
+    if (*it != keyframe_ts) this->m_keyframes.insert(it, keyframe_ts);
+  }
+}
+
+void KeyframeIndex::set_indexed_until(int64_t ts) {
+  this->m_indexed_until = std::max(this->m_indexed_until, ts);
+}
+
+void KeyframeIndex::set_complete() {
+  this->m_complete = true;
+}
+
+bool KeyframeIndex::is_complete() const noexcept {
+  return this->m_complete;
+}
+
+int64_t KeyframeIndex::get_indexed_until() const noexcept {
+  return this->m_indexed_until;
+}
+
+std::size_t KeyframeIndex::size() const noexcept {
+  return this->m_keyframes.size();
+}
+
+std::optional<int64_t> KeyframeIndex::floor(int64_t ts) const {
+  if (!this->m_complete && ts > this->m_indexed_until) return std::nullopt;
+
+  auto it = std::upper_bound(this->m_keyframes.begin(), this->m_keyframes.end(), ts);
+  if (it == this->m_keyframes.begin()) return std::nullopt;
+  return *(--it);
+}
+
+std::optional<int64_t> KeyframeIndex::nearest(int64_t ts) const {
+  if (!this->m_complete && ts > this->m_indexed_until) return std::nullopt;
+  if (this->m_keyframes.empty()) return std::nullopt;
+
+  auto it = std::lower_bound(this->m_keyframes.begin(), this->m_keyframes.end(), ts);
+  if (it == this->m_keyframes.begin()) return *it;
+  if (it == this->m_keyframes.end()) return *(--it);
+  const int64_t after = *it;
+  const int64_t before = *(--it);
+  return after - ts < ts - before ? after : before;
+}
+
+void KeyframeIndex::clear() noexcept {
+  this->m_keyframes.clear();
+  this->m_indexed_until = std::numeric_limits<int64_t>::min();
+  this->m_complete = false;
+}
@@ -2,7 +2,6 @@
 
 #include <tmedia/ffmpeg/avguard.h>
 #include <tmedia/ffmpeg/boiler.h>
-#include <tmedia/ffmpeg/decode.h>
 #include <tmedia/util/formatting.h>
 #include <tmedia/ffmpeg/ffmpeg_error.h>
 #include <tmedia/util/defines.h>
@@ -14,6 +13,8 @@
 #include <memory> //std::make_unique
 #include <utility>
 #include <filesystem>
+#include <algorithm>
+#include <cstdint>
 
 #include <fmt/format.h>
 #include <cassert>
@@ -23,7 +24,8 @@ extern "C" {
   #include <libavformat/avformat.h>
 }
 
-MediaDecoder::MediaDecoder(const std::filesystem::path& path, const std::set<enum AVMediaType>& requested_streams) : path(path) {
+MediaDecoder::MediaDecoder(const std::filesystem::path& path, const std::set<enum AVMediaType>& requested_streams, int decode_threads) :
+  pkt_pool(std::make_shared<AVPacketPool>()), path(path) {
   try {
     this->fmt_ctx = open_format_context(path);
   } catch (std::runtime_error const& e) {
@@ -34,9 +36,14 @@ MediaDecoder::MediaDecoder(const std::filesystem::path& path, const std::set<enu
    
   this->media_type = media_type_from_avformat_context(this->fmt_ctx);
 
+  // frame threading only overlaps the decoding of different frames, so it
+  // would only hold back the one frame of an image
+  const int thread_type = this->media_type == MediaType::IMAGE ?
+    FF_THREAD_SLICE : FF_THREAD_FRAME | FF_THREAD_SLICE;
+
   for (const enum AVMediaType& stream_type : requested_streams) {
     try {
-      this->decs[stream_type] = std::make_unique<StreamDecoder>(fmt_ctx, stream_type);
+      this->decs[stream_type] = std::make_unique<StreamDecoder>(fmt_ctx, stream_type, decode_threads, thread_type, this->pkt_pool);
     } catch (std::runtime_error const& e) { } // no-op
   }
 }
@@ -45,98 +52,63 @@ MediaDecoder::~MediaDecoder() {
   avformat_close_input(&(this->fmt_ctx));
 }
 
-std::vector<AVFrame*> MediaDecoder::next_frames(enum AVMediaType media_type) {
-  assert(this->has_stream_decoder(media_type));
-  constexpr int NO_FETCH_MADE = -1;
-
-  StreamDecoder& stream_decoder = *(this->decs[media_type]);
-  int fetch_count = NO_FETCH_MADE; 
-
-  do {
-    fetch_count = !stream_decoder.has_packets() ? this->fetch_next(10) : NO_FETCH_MADE;
-    std::vector<AVFrame*> dec_frames = stream_decoder.decode_next();
-    if (dec_frames.size() > 0)
-      return dec_frames;
-    // no need to clear dec_frames, if the size of decoded frames is greater than 0, would have already returned
-  } while (fetch_count > 0 || fetch_count == NO_FETCH_MADE);
-
-  return {}; // no video frames could sadly be found. This should only really ever happen once the file ends
-}
-
-int MediaDecoder::fetch_next(int requested_packet_count) {
-  int packets_read = 0;
-  AVPacket* reading_packet = av_packet_alloc();
-  if (unlikely(reading_packet == nullptr)) {
-    throw ffmpeg_error(fmt::format("[{}] Failed to allocate AVPacket", FUNCDINFO), AVERROR(ENOMEM));
-  }
-
-  while (av_read_frame(this->fmt_ctx, reading_packet) == 0) {
+int MediaDecoder::read_packet(AVPacket* packet, enum AVMediaType& media_type) {
+  int res = 0;
+  while ((res = av_read_frame(this->fmt_ctx, packet)) == 0) {
     for (auto &dec : this->decs) {
-      if (!dec) continue;
-      
-      if (dec->get_stream_index() == reading_packet->stream_index) {
-        AVPacket* saved_packet = av_packet_alloc();
-        if (unlikely(saved_packet == nullptr)) {
-          av_packet_free(&reading_packet);
-          throw ffmpeg_error(fmt::format("[{}] Failed to allocate "
-          "AVPacket", FUNCDINFO), AVERROR(ENOMEM));
-        }
-
-        int res = av_packet_ref(saved_packet, reading_packet);
-        if (unlikely(res < 0)) {
-          av_packet_free(&reading_packet);
-          av_packet_free(&saved_packet);
-          throw ffmpeg_error(fmt::format("[{}] Failed to reference "
-          "frame from format context", FUNCDINFO), AVERROR(ENOMEM));
-        }
-        
-        dec->push_back(saved_packet);
-        packets_read++;
-        break;
+      if (dec && dec->get_stream_index() == packet->stream_index) {
+        media_type = dec->get_media_type();
+        return 0;
       }
     }
 
-    av_packet_unref(reading_packet);
-    if (packets_read >= requested_packet_count) break;
+    av_packet_unref(packet); // packet from a stream we don't decode
   }
 
-  av_packet_free(&reading_packet);
-  return packets_read;
+  return res;
 }
 
-int MediaDecoder::jump_to_time(double target_time) {
+int MediaDecoder::seek(double target_time) {
   assert(target_time >= 0.0 && target_time <= this->get_duration());
-  int ret = avformat_seek_file(this->fmt_ctx, -1, 0.0,
+  return avformat_seek_file(this->fmt_ctx, -1, 0.0,
     target_time * AV_TIME_BASE, target_time * AV_TIME_BASE, 0);
+}
 
-  if (ret < 0) {
-    return ret;
-  }
-
-  for (auto& dec : this->decs) {
-    if (!dec) continue;
-    dec->reset();
-  }
+int MediaDecoder::seek_keyframe(enum AVMediaType media_type, int64_t keyframe_ts) {
+  assert(this->has_stream_decoder(media_type));
+  return avformat_seek_file(this->fmt_ctx,
+    this->decs[media_type]->get_stream_index(),
+    INT64_MIN, keyframe_ts, keyframe_ts, 0);
+}
 
-  for (int i = 0; i < AVMEDIA_TYPE_NB; i++) {
-    std::unique_ptr<StreamDecoder>& dec = this->decs[i];
-    if (!dec) continue;
-    std::vector<AVFrame*> frames;
-    bool passed_target_time = false;
-
-    do {
-      clear_avframe_list(frames);
-      frames = this->next_frames((enum AVMediaType)i);
-      for (std::size_t i = 0; i < frames.size(); i++) {
-        if (frames[i]->pts * dec->get_time_base() >= target_time) {
-          passed_target_time = true;
-          break;
-        }
-      }
-    } while (!passed_target_time && frames.size() > 0);
-    
-    clear_avframe_list(frames);
+bool MediaDecoder::read_container_keyframes(enum AVMediaType media_type, KeyframeIndex& index) {
+  assert(this->has_stream_decoder(media_type));
+  AVStream* stream = this->decs[media_type]->get_stream();
+  int nb_keyframes = 0;
+  int64_t last_keyframe = INT64_MIN;
+
+  #if HAS_AVFORMAT_INDEX_GET_ENTRY
+  const int nb_entries = avformat_index_get_entries_count(stream);
+  #else
+  const int nb_entries = stream->nb_index_entries;
+  #endif
+
+  for (int i = 0; i < nb_entries; i++) {
+    #if HAS_AVFORMAT_INDEX_GET_ENTRY
+    const AVIndexEntry* entry = avformat_index_get_entry(stream, i);
+    #else
+    const AVIndexEntry* entry = &(stream->index_entries[i]);
+    #endif
+    if (entry != nullptr && (entry->flags & AVINDEX_KEYFRAME)) {
+      index.insert(entry->timestamp);
+      last_keyframe = std::max(last_keyframe, entry->timestamp);
+      nb_keyframes++;
+    }
   }
 
-  return ret;
+  // generic indexes only hold what was read so far, and are thinned out by
+  // FFmpeg as they grow, so they never count as the indexed portion
+  const bool complete = nb_keyframes > 0 && !(this->fmt_ctx->iformat->flags & AVFMT_GENERIC_INDEX);
+  if (complete) index.set_indexed_until(last_keyframe);
+  return complete;
 }
@@ -2,6 +2,7 @@
 #include <tmedia/media/mediafetcher.h>
 
 #include <tmedia/ffmpeg/decode.h>
+#include <tmedia/tmcurses/cellrenderer.h>
 #include <tmedia/util/wtime.h>
 #include <tmedia/util/wmath.h>
 #include <tmedia/util/formatting.h>
@@ -12,7 +13,12 @@
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <optional>
+#include <algorithm>
 #include <set>
+#include <cstdint>
 
 #include <fmt/format.h>
 
@@ -23,16 +29,40 @@ extern "C" {
 #include <libavutil/avutil.h>
 }
 
-MediaFetcher::MediaFetcher(const std::filesystem::path& path, const std::set<enum AVMediaType>& requested_streams) :
-  path(path), mdec(std::make_unique<MediaDecoder>(path, requested_streams)) {
+// at most a third of a second at 24 fps, while keeping memory of queued
+// frames reasonable at MAX_FRAME_WIDTH
+static constexpr std::size_t VIDEO_LOOKAHEAD_FRAMES = 8;
+
+MediaFetcher::MediaFetcher(const std::filesystem::path& path, const std::set<enum AVMediaType>& requested_streams, int decode_threads, const std::optional<Dim2>& lowres_target) :
+  path(path), frame_queue(VIDEO_LOOKAHEAD_FRAMES), mdec(std::make_unique<MediaDecoder>(path, requested_streams, decode_threads)) {
   this->in_use = false;
 
   if (this->mdec->nb_stream_decoders() == 0)
     throw std::runtime_error(fmt::format("[{}] Could not find any media streams", FUNCDINFO));
 
   this->media_type = this->mdec->get_media_type();
-  this->msg_video_jump_curr_time = 0;
-  this->msg_audio_jump_curr_time = 0;
+  this->msg_demux_jump_curr_time = 0;
+  this->msg_index_until = INT64_MIN;
+  this->jumped_since_present = false;
+  this->flags = 0;
+  this->req_cell_pixels = Dim2(1, 1);
+  this->lowres_decoding = lowres_target.has_value();
+  if (lowres_target && this->media_type == MediaType::VIDEO && this->has_media_stream(AVMEDIA_TYPE_VIDEO))
+    this->init_lowres_decoding(*lowres_target);
+  this->nb_dropped_frames = 0;
+  this->nb_skipped_frames = 0;
+
+  static constexpr std::size_t VIDEO_PACKET_QUEUE_CAPACITY = 128;
+  static constexpr std::size_t AUDIO_PACKET_QUEUE_CAPACITY = 256;
+  if (this->has_media_stream(AVMEDIA_TYPE_VIDEO))
+    this->pkt_queues[AVMEDIA_TYPE_VIDEO] = std::make_unique<PacketQueue>(VIDEO_PACKET_QUEUE_CAPACITY, this->mdec->get_packet_pool());
+  if (this->has_media_stream(AVMEDIA_TYPE_AUDIO))
+    this->pkt_queues[AVMEDIA_TYPE_AUDIO] = std::make_unique<PacketQueue>(AUDIO_PACKET_QUEUE_CAPACITY, this->mdec->get_packet_pool());
+
+  if (this->media_type == MediaType::VIDEO && this->has_media_stream(AVMEDIA_TYPE_VIDEO)) {
+    if (this->mdec->read_container_keyframes(AVMEDIA_TYPE_VIDEO, this->kf_index))
+      this->kf_index.set_complete();
+  }
 
 
   if (this->has_media_stream(AVMEDIA_TYPE_AUDIO)) {
@@ -50,10 +80,22 @@ void MediaFetcher::dispatch_exit(std::string_view err) {
 }
 
 void MediaFetcher::dispatch_exit() {
-  std::scoped_lock<std::mutex, std::mutex> notification_locks(this->ex_noti_mtx, this->resume_notify_mutex);
+  std::scoped_lock<std::mutex, std::mutex, std::mutex, std::mutex> notification_locks(this->ex_noti_mtx, this->resume_notify_mutex, this->frame_notify_mutex, this->slot_notify_mutex);
   this->in_use = false;
   this->exit_cond.notify_all();
   this->resume_cond.notify_all();
+  this->frame_cond.notify_all();
+  this->slot_cond.notify_all();
+}
+
+void MediaFetcher::notify_frame() {
+  std::lock_guard<std::mutex> frame_notify_lock(this->frame_notify_mutex);
+  this->frame_cond.notify_all();
+}
+
+void MediaFetcher::notify_slot() {
+  std::lock_guard<std::mutex> slot_notify_lock(this->slot_notify_mutex);
+  this->slot_cond.notify_all();
 }
 
 bool MediaFetcher::is_playing() {
@@ -95,19 +137,164 @@ double MediaFetcher::get_desync_time(double currsystime) const {
 int MediaFetcher::jump_to_time(double target_time, double currsystime) {
   assert(target_time >= 0.0 && target_time <= this->get_duration());
   const double original_time = this->get_time(currsystime);
-  this->msg_audio_jump_curr_time++;
-  this->msg_video_jump_curr_time++;
+  for (auto& pkt_queue : this->pkt_queues) {
+    if (pkt_queue) pkt_queue->flush();
+  }
+  this->msg_demux_jump_curr_time++;
+  this->msg_demux_jump_keyframe.reset();
+  this->frame_queue.clear();
+  this->notify_slot();
+  this->jumped_since_present = true;
+  this->request_keyframe_index(target_time);
   
   this->clock.skip(target_time - original_time); // Update the playback to account for the skipped time
   return 0; // assume success
 }
 
+void MediaFetcher::request_keyframe_index(double target_time) {
+  if (this->media_type != MediaType::VIDEO || !this->has_media_stream(AVMEDIA_TYPE_VIDEO)) return;
+  if (this->kf_index.is_complete()) return;
+  const int64_t target_ts = static_cast<int64_t>(target_time / this->mdec->get_time_base(AVMEDIA_TYPE_VIDEO));
+  if (target_ts > this->kf_index.get_indexed_until())
+    this->msg_index_until = std::max(this->msg_index_until, target_ts);
+}
+
+double MediaFetcher::scrub_to_time(double target_time, double currsystime) {
+  std::optional<int64_t> keyframe;
+  if (this->media_type == MediaType::VIDEO && this->has_media_stream(AVMEDIA_TYPE_VIDEO)) {
+    const double time_base = this->mdec->get_time_base(AVMEDIA_TYPE_VIDEO);
+    keyframe = this->kf_index.nearest(static_cast<int64_t>(target_time / time_base));
+    if (keyframe) {
+      const double keyframe_time = static_cast<double>(*keyframe) * time_base;
+      if (keyframe_time < 0.0 || keyframe_time > this->get_duration()) keyframe.reset();
+      else target_time = keyframe_time;
+    }
+  }
+
+  this->jump_to_time(target_time, currsystime);
+  this->msg_demux_jump_keyframe = keyframe;
+  return target_time;
+}
+
+void MediaFetcher::decode_next_frames(enum AVMediaType media_type, int& serial, int milliseconds, std::vector<AVFrame*>& frames) {
+  PacketQueue& pkt_queue = *(this->pkt_queues[media_type]);
+  StreamDecoder& stream_decoder = this->mdec->get_stream_decoder(media_type);
+  AVPacket* packet = nullptr;
+  int packet_serial = pkt_queue.get_serial();
+
+  if (packet_serial != serial) {
+    stream_decoder.reset();
+    serial = packet_serial;
+  }
+
+  while (pkt_queue.try_pop(packet, packet_serial, milliseconds)) {
+    if (packet_serial != serial) { // flushed since the check above
+      stream_decoder.reset();
+      serial = packet_serial;
+    }
+
+    stream_decoder.push_back(packet);
+    if (stream_decoder.decode_next(frames) == 0) {
+      if (pkt_queue.get_serial() != serial) { // flushed while decoding
+        stream_decoder.release_frames(frames);
+      }
+      return;
+    }
+  }
+
+  // no more packets are coming, so take the frames the decoder held back
+  if (pkt_queue.get_serial() == serial && pkt_queue.finished()) {
+    if (stream_decoder.drain(frames) == 0 && pkt_queue.get_serial() != serial) {
+      stream_decoder.release_frames(frames);
+    }
+  }
+}
+
+void MediaFetcher::present_frame(double currsystime) {
+  if (this->still_frames.consume()) {
+    this->frame = this->still_frames.front();
+    this->frame_cells.reset();
+  }
+
+  if (this->jumped_since_present && !this->frame_queue.empty()) {
+    // show where playback landed right away, rather than once the clock
+    // has moved past the first frame after the jump
+    this->frame = this->frame_queue.pop_front();
+    this->frame_cells = this->frame_queue.popped_cells();
+    this->jumped_since_present = false;
+    this->notify_slot();
+    return;
+  }
+
+  std::optional<PixelData> due = this->frame_queue.pop_due(this->get_time(currsystime));
+  if (due) {
+    this->frame = std::move(*due);
+    this->frame_cells = this->frame_queue.popped_cells();
+    this->notify_slot();
+  } else if (this->frame.get_width() * this->frame.get_height() == 0 && !this->frame_queue.empty()) {
+    this->frame = this->frame_queue.pop_front();
+    this->frame_cells = this->frame_queue.popped_cells();
+    this->notify_slot();
+  }
+}
+
+void MediaFetcher::wait_for_frame(double until_systime) {
+  while (this->in_use) {
+    double currsystime, wake_systime = until_systime;
+    bool queue_empty;
+    {
+      std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+      if (this->still_frames.fresh() || (this->jumped_since_present && !this->frame_queue.empty())) return;
+      currsystime = sys_clk_sec();
+      std::optional<double> next_pts = this->frame_queue.front_pts();
+      queue_empty = !next_pts.has_value();
+      if (next_pts && this->is_playing()) {
+        wake_systime = std::min(wake_systime, currsystime + (*next_pts - this->get_time(currsystime)));
+      }
+    }
+
+    if (wake_systime <= currsystime) return;
+    std::unique_lock<std::mutex> frame_notify_lock(this->frame_notify_mutex);
+    const bool woken = this->frame_cond.wait_for(frame_notify_lock, std::chrono::duration<double>(wake_systime - currsystime), [this, queue_empty] {
+      return !this->in_use || this->still_frames.fresh() || (queue_empty && !this->frame_queue.empty());
+    });
+    if (!woken) return;
+    // a frame was queued into an empty queue, so check again when it is due
+  }
+}
+
+void MediaFetcher::skip_to_next_frame(double currsystime, double fallback_secs) {
+  const double time = this->get_time(currsystime);
+  const std::optional<double> next_pts = this->frame_queue.front_pts();
+  if (next_pts) {
+    if (*next_pts > time) this->clock.skip(*next_pts - time);
+    return;
+  }
+
+  const bool video_pending = this->media_type == MediaType::VIDEO
+    && this->pkt_queues[AVMEDIA_TYPE_VIDEO] && !this->pkt_queues[AVMEDIA_TYPE_VIDEO]->finished();
+  if (!video_pending) this->clock.skip(fallback_secs);
+}
+
+void MediaFetcher::wait_for_queued_frame(double until_systime) {
+  const double currsystime = sys_clk_sec();
+  if (until_systime <= currsystime) return;
+  std::unique_lock<std::mutex> frame_notify_lock(this->frame_notify_mutex);
+  this->frame_cond.wait_for(frame_notify_lock, std::chrono::duration<double>(until_systime - currsystime), [this] {
+    return !this->in_use || this->still_frames.fresh() || !this->frame_queue.empty();
+  });
+}
+
 void MediaFetcher::begin(double currsystime) {
   this->in_use = true;
   this->clock.init(currsystime);
 
   std::thread idct(&MediaFetcher::duration_checking_thread_func, this);
   this->duration_checking_thread.swap(idct);
+  std::thread idmt(&MediaFetcher::demux_thread_func, this);
+  this->demux_thread.swap(idmt);
+  std::thread ikit(&MediaFetcher::keyframe_indexing_thread_func, this);
+  this->keyframe_indexing_thread.swap(ikit);
   std::thread ivt(&MediaFetcher::video_fetching_thread_func, this);
   this->video_thread.swap(ivt);
   std::thread iat(&MediaFetcher::audio_dispatch_thread_func, this);
@@ -121,6 +308,10 @@ void MediaFetcher::join(double currsystime) {
     this->pause(currsystime);
   if (this->video_thread.joinable())
     this->video_thread.join();
+  if (this->demux_thread.joinable())
+    this->demux_thread.join();
+  if (this->keyframe_indexing_thread.joinable())
+    this->keyframe_indexing_thread.join();
   if (this->duration_checking_thread.joinable())
     this->duration_checking_thread.join();
   if (this->audio_thread.joinable())
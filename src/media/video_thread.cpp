@@ -1,18 +1,26 @@
 #include <tmedia/media/mediafetcher.h>
 
 #include <tmedia/ffmpeg/decode.h>
+#include <tmedia/media/catchup.h>
 #include <tmedia/audio/audio.h>
 #include <tmedia/audio/audio_visualizer.h>
 #include <tmedia/util/sleep.h>
 #include <tmedia/image/scale.h>
 #include <tmedia/util/wtime.h>
 #include <tmedia/ffmpeg/videoconverter.h>
+#include <tmedia/image/pixelbufferpool.h>
+#include <tmedia/tmcurses/cellrenderer.h>
 #include <tmedia/util/defines.h>
 
 #include <mutex>
 #include <memory>
 #include <stdexcept>
 #include <chrono>
+#include <cmath>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
 
 #include <fmt/format.h>
 
@@ -32,11 +40,12 @@ extern "C" {
  *  playback timestamp
  * 
  * If the currently attached media is an image:
- *  The video thread will read the cover art and exit
+ *  The video thread will read the image, and convert it again whenever
+ *  the requested frame size changes until exiting
  * 
  * If the currently attached media is audio:
  *  If there is an attached cover art to the current audio file:
- *    The video thread will read the cover art and exit
+ *    The video thread will read the cover art the same way as an image
  *  else:
  *    The video thread will update the current frame to be a snapshot of the wave of audio data currently being
  *    processed. 
@@ -58,6 +67,91 @@ constexpr int MAX_FRAME_WIDTH = 640;
 constexpr int MAX_FRAME_HEIGHT = static_cast<int>(static_cast<double>(MAX_FRAME_WIDTH) / MAX_FRAME_ASPECT_RATIO);
 constexpr int PAUSED_SLEEP_TIME_MS = 100;
 constexpr double DEFAULT_AVGFTS = 1.0 / 24.0;
+constexpr int VIDEO_PACKET_TRY_POP_WAIT_MS = 25;
+
+/**
+ * Returns the size of frames to be shown on at most max_cells character
+ * cells, where every cell shows cell_pixels pixels, such that the frame keeps
+ * the source's aspect ratio once displayed on the terminal's tall cells
+*/
+static Dim2 bound_frame_dims(int src_width, int src_height, Dim2 max_cells, Dim2 cell_pixels) {
+  return bound_dims(src_width * PAR_HEIGHT * cell_pixels.width,
+  src_height * PAR_WIDTH * cell_pixels.height,
+  std::min(max_cells.width, MAX_FRAME_WIDTH) * cell_pixels.width,
+  std::min(max_cells.height, MAX_FRAME_HEIGHT) * cell_pixels.height);
+}
+
+/**
+ * Returns the size of frames to produce from a source of the given size for
+ * the frame size currently requested of the MediaFetcher. Frames are always
+ * produced at this size, so that the renderer never has to scale them.
+ * 
+ * alter_mutex must be held while reading req_dims and req_cell_pixels
+*/
+static Dim2 req_frame_dims(int src_width, int src_height, const std::optional<Dim2>& req_dims, Dim2 req_cell_pixels) {
+  return bound_frame_dims(src_width, src_height,
+  req_dims ? *req_dims : Dim2(MAX_FRAME_WIDTH, MAX_FRAME_HEIGHT), req_cell_pixels);
+}
+
+// discard levels applied to the video decoder for each CatchupController level
+constexpr enum AVDiscard CATCHUP_SKIP_FRAME[CatchupController::MAX_LEVEL + 1] = {
+  AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_BIDIR, AVDISCARD_NONKEY };
+constexpr enum AVDiscard CATCHUP_SKIP_LOOP_FILTER[CatchupController::MAX_LEVEL + 1] = {
+  AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_BIDIR, AVDISCARD_ALL };
+
+// every slot of the lookahead queue, which keeps its frames referenced until
+// they are overwritten, plus the frame being converted and the copies of the
+// presented frame being rendered
+constexpr std::size_t VIDEO_PIXEL_BUFFER_POOL_SIZE = 14;
+
+// cells rendered ahead of time are referenced for as long as the frames they
+// were rendered from
+constexpr std::size_t VIDEO_CELL_FRAME_POOL_SIZE = VIDEO_PIXEL_BUFFER_POOL_SIZE;
+
+static_assert(sizeof(RGB24) == 3, "RGB24 must be layout compatible with AV_PIX_FMT_RGB24");
+
+/**
+ * Converts a decoded frame into a PixelData by scaling straight into a pixel
+ * buffer from the pool matching vconv's destination format, which must be
+ * AV_PIX_FMT_RGB24 or AV_PIX_FMT_GRAY8
+*/
+static PixelData convert_to_pixel_data(VideoConverter& vconv, PixelBufferPool<RGB24>& pool, PixelBufferPool<uint8_t>& gray_pool, AVFrame* frame) {
+  const int width = vconv.get_dst_width();
+  const int height = vconv.get_dst_height();
+  const std::size_t nb_pixels = static_cast<std::size_t>(width) * height;
+
+  if (vconv.get_dst_pix_fmt() == AV_PIX_FMT_GRAY8) {
+    std::shared_ptr<std::vector<uint8_t>> grays = gray_pool.acquire(nb_pixels);
+    vconv.convert_video_frame(frame, grays->data(), width);
+    return PixelData(grays, width, height);
+  }
+
+  std::shared_ptr<std::vector<RGB24>> pixels = pool.acquire(nb_pixels);
+  vconv.convert_video_frame(frame, reinterpret_cast<uint8_t*>(pixels->data()), width * 3);
+  return PixelData(pixels, width, height);
+}
+
+// headroom over the cells requested at startup, so that the terminal can grow
+// somewhat before reduced resolution decoding becomes visible
+constexpr int LOWRES_TARGET_HEADROOM = 2;
+
+void MediaFetcher::init_lowres_decoding(Dim2 target_dims) {
+  StreamDecoder& vdec = this->mdec->get_stream_decoder(AVMEDIA_TYPE_VIDEO);
+  const int width = this->mdec->get_width();
+  const int height = this->mdec->get_height();
+  const Dim2 outdim = bound_dims(width * PAR_HEIGHT, height * PAR_WIDTH,
+  target_dims.width * LOWRES_TARGET_HEADROOM,
+  target_dims.height * LOWRES_TARGET_HEADROOM);
+
+  int lowres = 0;
+  while (lowres < vdec.get_max_lowres()
+    && AV_CEIL_RSHIFT(width, lowres + 1) >= outdim.width
+    && AV_CEIL_RSHIFT(height, lowres + 1) >= outdim.height) {
+    lowres++;
+  }
+
+  vdec.set_lowres(lowres);
+}
 
 void MediaFetcher::video_fetching_thread_func() {
   // note that frame_audio_fetching_func can run even if there is no video data
@@ -77,125 +171,234 @@ void MediaFetcher::video_fetching_thread_func() {
 }
 
 void MediaFetcher::frame_video_fetching_func() {
-  MediaDecoder vdec(this->mdec->path, { AVMEDIA_TYPE_VIDEO });
-  if (!vdec.has_stream_decoder(AVMEDIA_TYPE_VIDEO)) return; // copy failed?
+  if (!this->has_media_stream(AVMEDIA_TYPE_VIDEO)) return;
 
-  const Dim2 def_outdim = bound_dims(vdec.get_width() * PAR_HEIGHT,
-  vdec.get_height() * PAR_WIDTH,
-  MAX_FRAME_WIDTH,
-  MAX_FRAME_HEIGHT);
+  const Dim2 def_outdim = bound_frame_dims(this->mdec->get_width(),
+  this->mdec->get_height(), Dim2(MAX_FRAME_WIDTH, MAX_FRAME_HEIGHT),
+  Dim2(1, 1));
 
-  const double avg_fts = vdec.get_avgfts(AVMEDIA_TYPE_VIDEO);
+  const double avg_fts = this->mdec->get_avgfts(AVMEDIA_TYPE_VIDEO);
+  const double time_base = this->mdec->get_time_base(AVMEDIA_TYPE_VIDEO);
   VideoConverter vconv(def_outdim.width, def_outdim.height, AV_PIX_FMT_RGB24,
-  vdec.get_width(), vdec.get_height(), vdec.get_pix_fmt());
+  this->mdec->get_width(), this->mdec->get_height(), this->mdec->get_pix_fmt());
+  vconv.set_row_decimation(this->lowres_decoding);
+  PixelBufferPool<RGB24> pix_pool(VIDEO_PIXEL_BUFFER_POOL_SIZE);
+  PixelBufferPool<uint8_t> gray_pix_pool(VIDEO_PIXEL_BUFFER_POOL_SIZE);
+  CellFramePool cell_frame_pool(VIDEO_CELL_FRAME_POOL_SIZE);
+  StreamDecoder& vdec = this->mdec->get_stream_decoder(AVMEDIA_TYPE_VIDEO);
+  CatchupController catchup;
+  double last_pts_time_sec = NAN; // NAN until a frame has been decoded
+  double preroll_until = NAN; // NAN while not prerolling after a jump
+  std::vector<AVFrame*> dec_frames;
+  int serial = 0;
+  std::optional<PixelData> paused_frame;
+  Dim2 paused_dim;
 
   while (!this->should_exit()) {
-    if (!this->is_playing()) {
-      std::unique_lock<std::mutex> resume_notify_lock(this->resume_notify_mutex);
-      while (!this->is_playing() && !this->should_exit()) {
-        this->resume_cond.wait_for(resume_notify_lock, std::chrono::milliseconds(PAUSED_SLEEP_TIME_MS));
+    while (!this->is_playing() && !this->should_exit()) {
+      {
+        std::unique_lock<std::mutex> resume_notify_lock(this->resume_notify_mutex);
+        if (!this->is_playing() && !this->should_exit()) {
+          this->resume_cond.wait_for(resume_notify_lock, std::chrono::milliseconds(PAUSED_SLEEP_TIME_MS));
+        }
+      }
+
+      // no frames are produced while paused, so the presented frame is
+      // resized and published as a still frame whenever the requested frame
+      // size changes. Resizing always starts from the frame presented when
+      // pausing, so that repeated resizes do not blur it.
+      if (!paused_frame) {
+        paused_frame = this->frame_queue.presented();
+        if (!paused_frame) continue; // nothing presented yet
+        paused_dim = Dim2(paused_frame->get_width(), paused_frame->get_height());
+      }
+
+      Dim2 out_dim;
+      {
+        std::lock_guard<std::mutex> alter_mutex_lock(this->alter_mutex);
+        out_dim = req_frame_dims(this->mdec->get_width(),
+        this->mdec->get_height(), this->req_dims, this->req_cell_pixels);
+      }
+
+      if (out_dim != paused_dim) {
+        this->still_frames.back() = paused_frame->resize(out_dim.width, out_dim.height);
+        this->still_frames.publish();
+        this->notify_frame();
+        paused_dim = out_dim;
       }
     }
+    paused_frame.reset();
 
+    const bool lookahead_full = this->frame_queue.full();
+    std::shared_ptr<const CellRenderer> cell_renderer;
     {
       std::lock_guard<std::mutex> alter_mutex_lock(this->alter_mutex);
-      if (this->req_dims) {
-        Dim2 req_dims_bounded = bound_dims(
-        vdec.get_width() * PAR_HEIGHT,
-        vdec.get_height() * PAR_WIDTH,
-        this->req_dims->width, this->req_dims->height);
-
-        Dim2 out_dim = bound_dims(
-        req_dims_bounded.width,
-        req_dims_bounded.height,
-        MAX_FRAME_WIDTH, MAX_FRAME_HEIGHT);
-        
-        vconv.reset_dst_size(out_dim.width, out_dim.height);
-      }
+      const Dim2 out_dim = req_frame_dims(this->mdec->get_width(),
+      this->mdec->get_height(), this->req_dims, this->req_cell_pixels);
+      vconv.reset_dst_size(out_dim.width, out_dim.height);
+      cell_renderer = this->cell_renderer;
     }
+
+    vconv.reset_dst_pix_fmt((this->flags & GRAYSCALE_VIDEO) ? AV_PIX_FMT_GRAY8 : AV_PIX_FMT_RGB24);
     
-    double wait_duration = avg_fts;
-    std::vector<AVFrame*> dec_frames;
-    double current_time = 0.0;
-    int msg_video_jump_curr_time_cache = 0;
-    {
-      dec_frames = vdec.next_frames(AVMEDIA_TYPE_VIDEO);
-      std::scoped_lock<std::mutex> lock(this->alter_mutex);
-      current_time = this->get_time(sys_clk_sec());
-      msg_video_jump_curr_time_cache = this->msg_video_jump_curr_time;
+    if (lookahead_full) { // far enough ahead of the clock, let the presenter catch up
+      // woken as soon as the presenter frees a slot, so that playback
+      // unbound by the clock (see --headless-max) is not held to avg_fts
+      std::unique_lock<std::mutex> slot_lock(this->slot_notify_mutex);
+      this->slot_cond.wait_for(slot_lock, secs_to_chns(avg_fts), [this] {
+        return !this->frame_queue.full() || this->should_exit();
+      });
+      continue;
     }
 
-    if (msg_video_jump_curr_time_cache > 0) {
-      vdec.jump_to_time(current_time);
-      dec_frames = vdec.next_frames(AVMEDIA_TYPE_VIDEO);
-      std::scoped_lock<std::mutex> lock(this->alter_mutex);
-      this->msg_video_jump_curr_time--;
+    // read before popping any packets, so that frames decoded from packets
+    // from before a jump are always pushed with an outdated serial
+    const unsigned int queue_serial = this->frame_queue.serial();
+    const int prev_serial = serial;
+    this->decode_next_frames(AVMEDIA_TYPE_VIDEO, serial, VIDEO_PACKET_TRY_POP_WAIT_MS, dec_frames);
+    if (serial != prev_serial) { // jumped, so lag from before the jump is meaningless
+      catchup.reset();
+      last_pts_time_sec = NAN;
+
+      // the demuxer lands on the keyframe before the jump target, so only
+      // reference frames are needed to decode up to the target
+      std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+      preroll_until = this->get_time(sys_clk_sec());
+      vdec.set_discard(AVDISCARD_NONREF, CATCHUP_SKIP_LOOP_FILTER[0]);
     }
 
-    if (dec_frames.size() > 0) {
-      const double frame_pts_time_sec = (double)dec_frames[0]->pts * vdec.get_time_base(AVMEDIA_TYPE_VIDEO);
-      const double extra_delay = (double)(dec_frames[0]->repeat_pict) / (2 * avg_fts);
-      wait_duration = frame_pts_time_sec - current_time + extra_delay;
-
-      if (wait_duration > 0.0 || this->frame.get_width() * this->frame.get_height() == 0) { // or the current frame has no valid dimensions
-        AVFrame* frame_image = vconv.convert_video_frame(dec_frames[0]);
-        PixelData pix_data = PixelData(frame_image);
-        av_frame_free(&frame_image);
-        
-        std::lock_guard<std::mutex> lock(this->alter_mutex);
-        this->frame = pix_data;
-      }
-      clear_avframe_list(dec_frames);
-      std::unique_lock<std::mutex> exit_lock(this->ex_noti_mtx);
-      if (wait_duration > 0.0 && !this->should_exit()) {
-        this->exit_cond.wait_for(exit_lock, secs_to_chns(wait_duration)); 
-      }
-    } else { // no frame was found.
+    if (dec_frames.size() == 0) { // no frame was found.
       std::unique_lock<std::mutex> exit_lock(this->ex_noti_mtx);
       if (!this->should_exit()) {
         this->exit_cond.wait_for(exit_lock, secs_to_chns(DEFAULT_AVGFTS)); 
       }
+      continue;
+    }
+
+    double current_time = 0.0;
+    {
+      std::lock_guard<std::mutex> lock(this->alter_mutex);
+      current_time = this->get_time(sys_clk_sec());
     }
+    bool has_frame = this->frame_queue.size() > 0 || this->frame_queue.presented().has_value();
+
+    for (std::size_t i = 0; i < dec_frames.size(); i++) {
+      const double frame_pts_time_sec = (double)dec_frames[i]->pts * time_base;
+      const double extra_delay = (double)(dec_frames[i]->repeat_pict) / (2 * avg_fts);
+
+      if (std::isfinite(preroll_until)) {
+        if (frame_pts_time_sec + avg_fts <= preroll_until) continue; // still before the jump target
+        preroll_until = NAN;
+        vdec.set_discard(CATCHUP_SKIP_FRAME[catchup.level()], CATCHUP_SKIP_LOOP_FILTER[catchup.level()]);
+      }
+
+      // while discarding, gaps between consecutive timestamps are frames
+      // the decoder skipped
+      if (catchup.level() > 0 && std::isfinite(last_pts_time_sec) && std::isfinite(avg_fts)) {
+        const long gap = std::lround((frame_pts_time_sec - last_pts_time_sec) / avg_fts) - 1;
+        if (gap > 0) this->nb_skipped_frames += static_cast<int>(gap);
+      }
+      last_pts_time_sec = frame_pts_time_sec;
+
+      const int prev_level = catchup.level();
+      const int level = catchup.update(current_time - frame_pts_time_sec, avg_fts, frame_pts_time_sec);
+      if (level != prev_level) {
+        vdec.set_discard(CATCHUP_SKIP_FRAME[level], CATCHUP_SKIP_LOOP_FILTER[level]);
+      }
 
+      // frames which would already be over by the time they are presented are
+      // never converted, unless there is nothing to present at all
+      if (frame_pts_time_sec + avg_fts + extra_delay <= current_time && has_frame) {
+        this->nb_dropped_frames++;
+        continue;
+      }
+
+      PixelData pix_data = convert_to_pixel_data(vconv, pix_pool, gray_pix_pool, dec_frames[i]);
+      std::shared_ptr<const CellFrame> cells;
+      if (cell_renderer) cells = render_cell_frame(cell_frame_pool, cell_renderer, pix_data);
+      if (this->frame_queue.serial() != queue_serial) break; // jumped while converting
+      if (!this->frame_queue.push(pix_data, frame_pts_time_sec, queue_serial, std::move(cells))) {
+        this->nb_dropped_frames++; // a single packet decoded into more frames than there are slots
+        continue;
+      }
+      this->notify_frame(); // in case the presenter waits on an empty queue
+      has_frame = true;
+    }
+    vdec.release_frames(dec_frames);
   }
 
 }
 
 void MediaFetcher::frame_image_fetching_func() {
-  MediaDecoder vdec(this->mdec->path, { AVMEDIA_TYPE_VIDEO });
+  if (!this->has_media_stream(AVMEDIA_TYPE_VIDEO)) return;
 
-  Dim2 outdim = bound_dims(vdec.get_width() * PAR_HEIGHT,
-  vdec.get_height() * PAR_WIDTH,
-  MAX_FRAME_WIDTH,
-  MAX_FRAME_HEIGHT);
+  Dim2 outdim;
+  {
+    std::lock_guard<std::mutex> lock(this->alter_mutex);
+    outdim = req_frame_dims(this->mdec->get_width(), this->mdec->get_height(),
+    this->req_dims, this->req_cell_pixels);
+  }
 
   VideoConverter vconv(outdim.width,
   outdim.height,
   AV_PIX_FMT_RGB24,
-  vdec.get_width(),
-  vdec.get_height(),
-  vdec.get_pix_fmt());
+  this->mdec->get_width(),
+  this->mdec->get_height(),
+  this->mdec->get_pix_fmt());
+
+  int serial = 0;
+  std::vector<AVFrame*> dec_frames;
+  while (dec_frames.empty() && !this->should_exit()) {
+    const bool finished = this->pkt_queues[AVMEDIA_TYPE_VIDEO]->finished();
+    this->decode_next_frames(AVMEDIA_TYPE_VIDEO, serial, VIDEO_PACKET_TRY_POP_WAIT_MS, dec_frames);
+    if (finished) break; // the decoder has been drained as well
+  }
 
-  std::vector<AVFrame*> dec_frames = vdec.next_frames(AVMEDIA_TYPE_VIDEO);
+  PixelBufferPool<RGB24> pix_pool(0);
+  PixelBufferPool<uint8_t> gray_pix_pool(0);
   if (dec_frames.size() > 0) {
-    AVFrame* frame_image = vconv.convert_video_frame(dec_frames[0]);
-    PixelData frame_pixel_data = PixelData(frame_image);
+    this->still_frames.back() = convert_to_pixel_data(vconv, pix_pool, gray_pix_pool, dec_frames[0]);
+    this->still_frames.publish();
+    this->notify_frame();
+  }
+
+  // the picture is converted again whenever the requested frame size
+  // changes, as the renderer shows frames as they are
+  while (dec_frames.size() > 0 && !this->should_exit()) {
+    {
+      std::unique_lock<std::mutex> exit_lock(this->ex_noti_mtx);
+      if (!this->should_exit()) {
+        this->exit_cond.wait_for(exit_lock, std::chrono::milliseconds(PAUSED_SLEEP_TIME_MS));
+      }
+    }
+
+    Dim2 req_outdim;
     {
       std::lock_guard<std::mutex> lock(this->alter_mutex);
-      this->frame = frame_pixel_data;
+      req_outdim = req_frame_dims(this->mdec->get_width(),
+      this->mdec->get_height(), this->req_dims, this->req_cell_pixels);
     }
-    av_frame_free(&frame_image);
+
+    if (req_outdim == outdim) continue;
+    outdim = req_outdim;
+    vconv.reset_dst_size(outdim.width, outdim.height);
+    this->still_frames.back() = convert_to_pixel_data(vconv, pix_pool, gray_pix_pool, dec_frames[0]);
+    this->still_frames.publish();
+    this->notify_frame();
   }
-  clear_avframe_list(dec_frames);
+
+  this->mdec->get_stream_decoder(AVMEDIA_TYPE_VIDEO).release_frames(dec_frames);
 }
 
 void MediaFetcher::frame_audio_fetching_func() {
   if (this->has_media_stream(AVMEDIA_TYPE_VIDEO)) { // assume attached pic
     try {
       this->frame_image_fetching_func();
+      this->pkt_queues[AVMEDIA_TYPE_VIDEO]->close(); // only one picture needed
       return;
     } catch (const std::runtime_error& e) {
       // no-op, Image decoding error, continue on with visualization
+      this->pkt_queues[AVMEDIA_TYPE_VIDEO]->close();
     }
   }
 
@@ -206,12 +409,15 @@ void MediaFetcher::frame_audio_fetching_func() {
   const int nb_ch = this->audio_buffer->get_nb_channels();
   const int aubduf_sz = AUDIO_PEEK_MAX_SAMPLE_SIZE / nb_ch;
   Dim2 visdim(MAX_FRAME_WIDTH, MAX_FRAME_HEIGHT);
-  if (this->req_dims) {
-    visdim = bound_dims(
-    this->req_dims->width,
-    this->req_dims->height,
-    MAX_FRAME_WIDTH,
-    MAX_FRAME_HEIGHT);
+  {
+    std::lock_guard<std::mutex> alter_lock(this->alter_mutex);
+    if (this->req_dims) {
+      visdim = bound_dims(
+      this->req_dims->width * this->req_cell_pixels.width,
+      this->req_dims->height * this->req_cell_pixels.height,
+      MAX_FRAME_WIDTH * this->req_cell_pixels.width,
+      MAX_FRAME_HEIGHT * this->req_cell_pixels.height);
+    }
   }
   
   while (!this->should_exit()) {
@@ -224,15 +430,16 @@ void MediaFetcher::frame_audio_fetching_func() {
 
 
     if (this->audio_buffer->try_peek_into(aubduf_sz, audbuf, AUDIO_PEEK_TRY_WAIT_MS)) {
-      PixelData frame = visualize(audbuf, aubduf_sz, nb_ch, visdim.width, visdim.height);
+      this->still_frames.back() = visualize(audbuf, aubduf_sz, nb_ch, visdim.width, visdim.height);
+      this->still_frames.publish();
+      this->notify_frame();
       std::scoped_lock<std::mutex> alter_lock(this->alter_mutex);
-      this->frame = frame;
       if (this->req_dims) {
         visdim = bound_dims(
-        this->req_dims->width,
-        this->req_dims->height,
-        MAX_FRAME_WIDTH,
-        MAX_FRAME_HEIGHT);
+        this->req_dims->width * this->req_cell_pixels.width,
+        this->req_dims->height * this->req_cell_pixels.height,
+        MAX_FRAME_WIDTH * this->req_cell_pixels.width,
+        MAX_FRAME_HEIGHT * this->req_cell_pixels.height);
       }
     }
 
@@ -0,0 +1,214 @@
+#include <tmedia/term/ansiframe.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include <unistd.h>
+
+static constexpr std::size_t ANSI_FRAME_INITIAL_CAPACITY = 1 << 16;
+
+// "\x1b[38;2;255;255;255;48;2;255;255;255m" plus a 4 byte UTF-8 codepoint,
+// rounded up
+static constexpr std::size_t MAX_CELL_BYTES = 48;
+
+// "\x1b[65535;65535H"
+static constexpr std::size_t MAX_CURSOR_MOVE_BYTES = 16;
+
+static constexpr char SYNC_BEGIN[] = "\x1b[?2026h";
+static constexpr char SYNC_END[] = "\x1b[?2026l";
+static constexpr char FRAME_BEGIN[] = "\x1b" "7" "\x1b[0m"; // save cursor, reset attributes
+static constexpr char FRAME_END[] = "\x1b[0m" "\x1b" "8"; // reset attributes, restore cursor
+
+/**
+ * The decimal digits of every value of a color channel
+*/
+struct ChannelDigits {
+  std::array<std::array<char, 3>, 256> digits;
+  std::array<std::uint8_t, 256> lengths;
+
+  constexpr ChannelDigits() : digits(), lengths() {
+    for (int v = 0; v < 256; v++) {
+      if (v >= 100) {
+        this->digits[v] = {static_cast<char>('0' + v / 100), static_cast<char>('0' + v / 10 % 10), static_cast<char>('0' + v % 10)};
+        this->lengths[v] = 3;
+      } else if (v >= 10) {
+        this->digits[v] = {static_cast<char>('0' + v / 10), static_cast<char>('0' + v % 10), '\0'};
+        this->lengths[v] = 2;
+      } else {
+        this->digits[v] = {static_cast<char>('0' + v), '\0', '\0'};
+        this->lengths[v] = 1;
+      }
+    }
+  }
+};
+
+static constexpr ChannelDigits CHANNEL_DIGITS;
+
+static inline char* write_channel(char* out, std::uint32_t value) {
+  const std::uint8_t v = static_cast<std::uint8_t>(value);
+  std::memcpy(out, CHANNEL_DIGITS.digits[v].data(), 3);
+  return out + CHANNEL_DIGITS.lengths[v];
+}
+
+static inline char* write_uint(char* out, unsigned int value) {
+  char digits[10];
+  int len = 0;
+  do {
+    digits[len++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  while (len > 0) *out++ = digits[--len];
+  return out;
+}
+
+/**
+ * Writes the parameters of an SGR sequence setting a 24-bit color, where
+ * base is 38 for the foreground or 48 for the background
+*/
+static inline char* write_color_params(char* out, std::uint32_t color, char base) {
+  *out++ = base;
+  if (color == ANSI_DEFAULT_COLOR) {
+    *out++ = '9';
+    return out;
+  }
+
+  std::memcpy(out, "8;2;", 4);
+  out += 4;
+  out = write_channel(out, color >> 16);
+  *out++ = ';';
+  out = write_channel(out, color >> 8);
+  *out++ = ';';
+  return write_channel(out, color);
+}
+
+static inline char* write_utf8(char* out, std::uint32_t codepoint) {
+  if (codepoint < 0x80) {
+    *out++ = static_cast<char>(codepoint);
+  } else if (codepoint < 0x800) {
+    *out++ = static_cast<char>(0xC0 | (codepoint >> 6));
+    *out++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else if (codepoint < 0x10000) {
+    *out++ = static_cast<char>(0xE0 | (codepoint >> 12));
+    *out++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else {
+    *out++ = static_cast<char>(0xF0 | (codepoint >> 18));
+    *out++ = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+    *out++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (codepoint & 0x3F));
+  }
+  return out;
+}
+
+AnsiFrame::AnsiFrame() : m_bytes(ANSI_FRAME_INITIAL_CAPACITY) {
+  this->m_size = 0;
+  this->m_fg = ANSI_DEFAULT_COLOR;
+  this->m_bg = ANSI_DEFAULT_COLOR;
+  this->m_nb_cells = 0;
+  this->m_nb_images = 0;
+  this->m_synchronized = false;
+}
+
+char* AnsiFrame::reserve(std::size_t nb_bytes) {
+  if (this->m_size + nb_bytes > this->m_bytes.size()) {
+    this->m_bytes.resize(std::max(this->m_bytes.size() * 2, this->m_size + nb_bytes));
+  }
+  return this->m_bytes.data() + this->m_size;
+}
+
+void AnsiFrame::append(const char* str, std::size_t len) {
+  std::memcpy(this->reserve(len), str, len);
+  this->m_size += len;
+}
+
+void AnsiFrame::move_cursor(int row, int col) {
+  char* const start = this->reserve(MAX_CURSOR_MOVE_BYTES);
+  char* out = start;
+  *out++ = '\x1b';
+  *out++ = '[';
+  out = write_uint(out, static_cast<unsigned int>(row + 1));
+  *out++ = ';';
+  out = write_uint(out, static_cast<unsigned int>(col + 1));
+  *out++ = 'H';
+  this->m_size += static_cast<std::size_t>(out - start);
+}
+
+void AnsiFrame::begin_frame(bool synchronized) {
+  this->m_size = 0;
+  this->m_nb_cells = 0;
+  this->m_nb_images = 0;
+  this->m_synchronized = synchronized;
+  if (synchronized) this->append(SYNC_BEGIN, sizeof(SYNC_BEGIN) - 1);
+  this->append(FRAME_BEGIN, sizeof(FRAME_BEGIN) - 1);
+  this->m_fg = ANSI_DEFAULT_COLOR;
+  this->m_bg = ANSI_DEFAULT_COLOR;
+}
+
+void AnsiFrame::put_cells(int row, int col, const AnsiCell* cells, int count) {
+  if (count <= 0) return;
+  this->move_cursor(row, col);
+  char* const start = this->reserve(static_cast<std::size_t>(count) * MAX_CELL_BYTES);
+  char* out = start;
+
+  for (int i = 0; i < count; i++) {
+    const AnsiCell& cell = cells[i];
+    const bool fg_changed = cell.fg != this->m_fg;
+    const bool bg_changed = cell.bg != this->m_bg;
+
+    if (fg_changed || bg_changed) {
+      *out++ = '\x1b';
+      *out++ = '[';
+      if (fg_changed) out = write_color_params(out, cell.fg, '3');
+      if (fg_changed && bg_changed) *out++ = ';';
+      if (bg_changed) out = write_color_params(out, cell.bg, '4');
+      *out++ = 'm';
+      this->m_fg = cell.fg;
+      this->m_bg = cell.bg;
+    }
+
+    out = write_utf8(out, cell.codepoint);
+  }
+
+  this->m_size += static_cast<std::size_t>(out - start);
+  this->m_nb_cells += count;
+}
+
+void AnsiFrame::put_image(int row, int col, std::string_view encoded) {
+  this->move_cursor(row, col);
+  this->append(encoded.data(), encoded.size());
+  this->m_nb_images++;
+}
+
+void AnsiFrame::end_frame() {
+  this->append(FRAME_END, sizeof(FRAME_END) - 1);
+  if (this->m_synchronized) this->append(SYNC_END, sizeof(SYNC_END) - 1);
+}
+
+bool AnsiFrame::flush(int fd) {
+  const bool has_output = this->m_nb_cells > 0 || this->m_nb_images > 0;
+  const std::size_t size = this->m_size;
+  this->m_size = 0;
+  this->m_nb_cells = 0;
+  this->m_nb_images = 0;
+  if (!has_output) return true;
+  return term_write_all(fd, this->m_bytes.data(), size);
+}
+
+bool term_write_all(int fd, const char* bytes, std::size_t size) {
+  while (size > 0) {
+    const ssize_t written = write(fd, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    bytes += written;
+    size -= static_cast<std::size_t>(written);
+  }
+
+  return true;
+}
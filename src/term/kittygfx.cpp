@@ -0,0 +1,107 @@
+#include <tmedia/term/kittygfx.h>
+
+#include <tmedia/image/pixeldata.h>
+#include <tmedia/image/color.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+#include <fmt/format.h>
+
+#ifdef TMEDIA_ZLIB
+#include <zlib.h>
+#endif
+
+static constexpr std::size_t KITTY_MAX_CHUNK_SIZE = 4096; // in base64 bytes
+static constexpr std::size_t KITTY_CHUNK_RAW_SIZE = KITTY_MAX_CHUNK_SIZE / 4 * 3;
+
+#ifdef TMEDIA_ZLIB
+// frames are replaced many times a second, so the fastest level is used
+static constexpr int KITTY_ZLIB_LEVEL = 1;
+#endif
+
+static constexpr char KITTY_BEGIN[] = "\x1b_G";
+static constexpr char KITTY_END[] = "\x1b\\";
+
+static constexpr char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void base64_encode(const std::uint8_t* bytes, std::size_t size, std::string& out) {
+  std::size_t i = 0;
+  for (; i + 3 <= size; i += 3) {
+    const std::uint32_t triple = (bytes[i] << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+    out.push_back(BASE64_CHARS[(triple >> 18) & 0x3F]);
+    out.push_back(BASE64_CHARS[(triple >> 12) & 0x3F]);
+    out.push_back(BASE64_CHARS[(triple >> 6) & 0x3F]);
+    out.push_back(BASE64_CHARS[triple & 0x3F]);
+  }
+
+  const std::size_t remaining = size - i;
+  if (remaining == 0) return;
+  const std::uint32_t triple = (bytes[i] << 16) | (remaining == 2 ? bytes[i + 1] << 8 : 0);
+  out.push_back(BASE64_CHARS[(triple >> 18) & 0x3F]);
+  out.push_back(BASE64_CHARS[(triple >> 12) & 0x3F]);
+  out.push_back(remaining == 2 ? BASE64_CHARS[(triple >> 6) & 0x3F] : '=');
+  out.push_back('=');
+}
+
+void KittyEncoder::encode(const PixelData& frame, std::uint32_t image_id, int cols, int rows, std::string& out) {
+  const int width = frame.get_width();
+  const int height = frame.get_height();
+  const std::size_t nb_pixels = static_cast<std::size_t>(width) * height;
+
+  const std::uint8_t* rgb = nullptr;
+  if (frame.is_gray()) {
+    this->m_rgb.resize(nb_pixels * 3);
+    for (std::size_t i = 0; i < nb_pixels; i++) {
+      const std::uint8_t gray = frame.gray_data()[i];
+      this->m_rgb[i * 3] = gray;
+      this->m_rgb[i * 3 + 1] = gray;
+      this->m_rgb[i * 3 + 2] = gray;
+    }
+    rgb = this->m_rgb.data();
+  } else {
+    rgb = reinterpret_cast<const std::uint8_t*>(frame.data().data());
+  }
+
+  const std::uint8_t* payload = rgb;
+  std::size_t payload_size = nb_pixels * 3;
+  bool compressed = false;
+
+#ifdef TMEDIA_ZLIB
+  uLongf compressed_size = compressBound(static_cast<uLong>(payload_size));
+  this->m_payload.resize(compressed_size);
+  if (compress2(this->m_payload.data(), &compressed_size, rgb, static_cast<uLong>(payload_size), KITTY_ZLIB_LEVEL) == Z_OK) {
+    payload = this->m_payload.data();
+    payload_size = compressed_size;
+    compressed = true;
+  }
+#endif
+
+  // q=2 silences the terminal's replies, and C=1 keeps the cursor in place
+  out.append(KITTY_BEGIN);
+  fmt::format_to(std::back_inserter(out), "a=T,f=24,s={},v={},c={},r={},i={},p=1,q=2,C=1{}",
+    width, height, cols, rows, image_id, compressed ? ",o=z" : "");
+
+  std::size_t offset = 0;
+  do {
+    const std::size_t chunk_size = std::min(KITTY_CHUNK_RAW_SIZE, payload_size - offset);
+    const bool last = offset + chunk_size >= payload_size;
+    if (offset > 0) out.append(KITTY_BEGIN);
+    if (offset > 0) { // continuation chunks only carry the m key
+      out.append(last ? "m=0;" : "m=1;");
+    } else {
+      out.append(last ? ",m=0;" : ",m=1;");
+    }
+    base64_encode(payload + offset, chunk_size, out);
+    out.append(KITTY_END);
+    offset += chunk_size;
+  } while (offset < payload_size);
+}
+
+void kitty_delete_image(std::uint32_t image_id, std::string& out) {
+  out.append(KITTY_BEGIN);
+  fmt::format_to(std::back_inserter(out), "a=d,d=I,i={},q=2", image_id);
+  out.append(KITTY_END);
+}
@@ -0,0 +1,86 @@
+#include <tmedia/term/outputscaler.h>
+
+// cheaper colors come first, as fewer distinct colors already let more cells
+// share color changes and stay unchanged between frames
+static constexpr double LEVEL_SCALES[OutputScaler::MAX_LEVEL + 1] = { 1.0, 1.0, 0.75, 0.75, 0.5, 0.35 };
+static constexpr int LEVEL_COLOR_BITS[OutputScaler::MAX_LEVEL + 1] = { 8, 6, 6, 4, 4, 4 };
+
+/**
+ * How many times more cells are drawn at level to than at level from
+*/
+static double cells_ratio(int from, int to) {
+  const double ratio = LEVEL_SCALES[to] / LEVEL_SCALES[from];
+  return ratio * ratio;
+}
+
+OutputScaler::OutputScaler() {
+  this->reset();
+}
+
+int OutputScaler::update(double output_secs, std::size_t bytes, double budget_secs) {
+  this->m_refreshes++;
+  this->m_bytes += bytes;
+  this->m_blocked_secs += output_secs;
+  this->m_refreshes_since_change++;
+  this->m_avg_output_secs += SMOOTHING * (output_secs - this->m_avg_output_secs);
+
+  if (this->m_avg_output_secs > budget_secs) {
+    this->m_relax_streak = 0;
+    if (this->m_level < MAX_LEVEL && this->m_refreshes_since_change >= SETTLE_REFRESHES) {
+      this->m_avg_output_secs *= cells_ratio(this->m_level, this->m_level + 1);
+      this->m_level++;
+      this->m_refreshes_since_change = 0;
+    }
+  } else if (this->m_level > 0
+    && this->m_avg_output_secs * cells_ratio(this->m_level, this->m_level - 1) < RELAX_BUDGET_FRACTION * budget_secs) {
+    this->m_relax_streak++;
+    if (this->m_relax_streak >= RELAX_STREAK) {
+      this->m_avg_output_secs *= cells_ratio(this->m_level, this->m_level - 1);
+      this->m_level--;
+      this->m_relax_streak = 0;
+      this->m_refreshes_since_change = 0;
+    }
+  } else {
+    this->m_relax_streak = 0;
+  }
+
+  return this->m_level;
+}
+
+int OutputScaler::level() const noexcept {
+  return this->m_level;
+}
+
+double OutputScaler::get_scale() const noexcept {
+  return LEVEL_SCALES[this->m_level];
+}
+
+int OutputScaler::get_color_bits() const noexcept {
+  return LEVEL_COLOR_BITS[this->m_level];
+}
+
+std::uint64_t OutputScaler::get_refreshes() const noexcept {
+  return this->m_refreshes;
+}
+
+std::uint64_t OutputScaler::get_bytes() const noexcept {
+  return this->m_bytes;
+}
+
+double OutputScaler::get_blocked_secs() const noexcept {
+  return this->m_blocked_secs;
+}
+
+void OutputScaler::reset_stats() noexcept {
+  this->m_refreshes = 0;
+  this->m_bytes = 0;
+  this->m_blocked_secs = 0.0;
+}
+
+void OutputScaler::reset() noexcept {
+  this->m_level = 0;
+  this->m_avg_output_secs = 0.0;
+  this->m_relax_streak = 0;
+  this->m_refreshes_since_change = 0;
+  this->reset_stats();
+}
@@ -0,0 +1,136 @@
+#include <tmedia/term/sixel.h>
+
+#include <tmedia/image/pixeldata.h>
+#include <tmedia/image/color.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <cstdint>
+
+#include <fmt/format.h>
+
+static constexpr int SIXEL_BAND_HEIGHT = 6;
+
+// runs of at least this many sixels are written as "!<count><sixel>"
+static constexpr int SIXEL_MIN_REPEAT = 4;
+
+static constexpr int BAYER_4X4[16] = {
+   0,  8,  2, 10,
+  12,  4, 14,  6,
+   3, 11,  1,  9,
+  15,  7, 13,  5
+};
+
+// P2 = 1 leaves pixels without sixels transparent, instead of painting them
+// with color register 0
+static constexpr char SIXEL_BEGIN[] = "\x1bP0;1;0q";
+static constexpr char SIXEL_END[] = "\x1b\\";
+
+SixelEncoder::SixelEncoder() {
+  static constexpr int MAX_LEVEL = SIXEL_PALETTE_SIDE - 1;
+  for (int pos = 0; pos < 16; pos++) {
+    const int threshold = (BAYER_4X4[pos] * 255 + 127) / 16;
+    for (int v = 0; v < 256; v++) {
+      this->m_levels[pos][v] = static_cast<std::uint8_t>(std::min(MAX_LEVEL, (v * MAX_LEVEL + threshold) / 255));
+    }
+  }
+  this->m_band_slots.fill(-1);
+}
+
+void SixelEncoder::encode(const PixelData& frame, std::string& out) {
+  static constexpr int SIDE = SIXEL_PALETTE_SIDE;
+  const int width = frame.get_width();
+  const int height = frame.get_height();
+  this->m_indices.resize(static_cast<std::size_t>(width) * height);
+
+  std::array<bool, SIXEL_PALETTE_SIZE> used{};
+  for (int row = 0; row < height; row++) {
+    const std::array<std::uint8_t, 256>* const levels = this->m_levels.data() + (row % 4) * 4;
+    std::uint8_t* indices = this->m_indices.data() + static_cast<std::size_t>(row) * width;
+    for (int col = 0; col < width; col++) {
+      const std::array<std::uint8_t, 256>& level = levels[col % 4];
+      std::uint8_t index;
+      if (frame.is_gray()) {
+        const std::uint8_t l = level[frame.gray_data()[row * width + col]];
+        index = static_cast<std::uint8_t>(l * SIDE * SIDE + l * SIDE + l);
+      } else {
+        const RGB24& pixel = frame.data()[row * width + col];
+        index = static_cast<std::uint8_t>(level[pixel.r] * SIDE * SIDE + level[pixel.g] * SIDE + level[pixel.b]);
+      }
+      indices[col] = index;
+      used[index] = true;
+    }
+  }
+
+  out.append(SIXEL_BEGIN);
+  fmt::format_to(std::back_inserter(out), "\"1;1;{};{}", width, height);
+  for (int i = 0; i < SIXEL_PALETTE_SIZE; i++) {
+    if (!used[i]) continue;
+    const int r = i / (SIDE * SIDE);
+    const int g = i / SIDE % SIDE;
+    const int b = i % SIDE;
+    fmt::format_to(std::back_inserter(out), "#{};2;{};{};{}", i,
+      r * 100 / (SIDE - 1), g * 100 / (SIDE - 1), b * 100 / (SIDE - 1));
+  }
+
+  for (int band_row = 0; band_row < height; band_row += SIXEL_BAND_HEIGHT) {
+    if (band_row > 0) out.push_back('-');
+    this->write_band(band_row, width, height, out);
+  }
+
+  out.append(SIXEL_END);
+}
+
+/**
+ * Appends a run of count identical sixels
+*/
+static void write_sixel_run(std::string& out, char sixel, int count) {
+  if (count >= SIXEL_MIN_REPEAT) {
+    fmt::format_to(std::back_inserter(out), "!{}{}", count, sixel);
+  } else {
+    out.append(static_cast<std::size_t>(count), sixel);
+  }
+}
+
+void SixelEncoder::write_band(int band_row, int width, int height, std::string& out) {
+  const int band_height = std::min(SIXEL_BAND_HEIGHT, height - band_row);
+  this->m_band_colors.clear();
+
+  for (int r = 0; r < band_height; r++) {
+    const std::uint8_t* indices = this->m_indices.data() + static_cast<std::size_t>(band_row + r) * width;
+    const std::uint8_t bit = static_cast<std::uint8_t>(1 << r);
+    for (int col = 0; col < width; col++) {
+      const std::uint8_t index = indices[col];
+      std::int16_t slot = this->m_band_slots[index];
+      if (slot < 0) {
+        slot = static_cast<std::int16_t>(this->m_band_colors.size());
+        this->m_band_slots[index] = slot;
+        this->m_band_colors.push_back(index);
+        this->m_band_bits.resize(this->m_band_colors.size() * width);
+        std::fill_n(this->m_band_bits.begin() + static_cast<std::ptrdiff_t>(slot) * width, width, 0);
+      }
+      this->m_band_bits[static_cast<std::size_t>(slot) * width + col] |= bit;
+    }
+  }
+
+  for (std::size_t slot = 0; slot < this->m_band_colors.size(); slot++) {
+    const std::uint8_t index = this->m_band_colors[slot];
+    this->m_band_slots[index] = -1;
+    if (slot > 0) out.push_back('$'); // back to the start of the band
+    fmt::format_to(std::back_inserter(out), "#{}", index);
+
+    // trailing columns without this color are left out entirely
+    const std::uint8_t* bits = this->m_band_bits.data() + slot * width;
+    int end = width;
+    while (end > 0 && bits[end - 1] == 0) end--;
+
+    int run_start = 0;
+    for (int col = 1; col <= end; col++) {
+      if (col == end || bits[col] != bits[run_start]) {
+        write_sixel_run(out, static_cast<char>('?' + bits[run_start]), col - run_start);
+        run_start = col;
+      }
+    }
+  }
+}
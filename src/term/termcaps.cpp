@@ -0,0 +1,164 @@
+#include <tmedia/term/termcaps.h>
+
+#include <tmedia/term/ansiframe.h>
+#include <tmedia/image/scale.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+static TermGraphicsCaps probed_graphics_caps;
+
+/**
+ * A kitty graphics query for a 1x1 image (image 31, which is never stored),
+ * a query for the size of a cell in pixels, and a primary device attributes
+ * query. Every terminal answers the device attributes, and terminals answer
+ * in order, so the device attributes arriving means that no other replies
+ * are coming.
+*/
+static constexpr char GRAPHICS_QUERY[] = "\x1b_Gi=31,s=1,v=1,a=q,t=d,f=24;AAAA\x1b\\" "\x1b[16t" "\x1b[c";
+static constexpr std::string_view KITTY_QUERY_OK = "\x1b_Gi=31;OK";
+static constexpr std::string_view DA1_REPLY_BEGIN = "\x1b[?";
+static constexpr std::string_view CELL_SIZE_REPLY_BEGIN = "\x1b[6;";
+static constexpr std::string_view DA1_SIXEL_ATTRIBUTE = "4";
+
+bool term_supports_truecolor() {
+  const char* colorterm = std::getenv("COLORTERM");
+  if (colorterm == nullptr) return false;
+  const std::string_view value(colorterm);
+  return value == "truecolor" || value == "24bit";
+}
+
+/**
+ * Returns if TERM names a terminal known to print escape sequences it does
+ * not implement instead of ignoring them, or if TERM is not set
+*/
+static bool term_is_limited() {
+  const char* term = std::getenv("TERM");
+  if (term == nullptr) return true;
+  const std::string_view value(term);
+  return value.substr(0, 5) == "linux" || value == "dumb";
+}
+
+bool term_supports_synchronized_update() {
+  return !term_is_limited();
+}
+
+/**
+ * Returns the position just past the final byte of the device attributes
+ * reply in reply, or std::string_view::npos if it has not fully arrived
+*/
+static std::size_t find_da1_reply_end(std::string_view reply) {
+  const std::size_t begin = reply.find(DA1_REPLY_BEGIN);
+  if (begin == std::string_view::npos) return std::string_view::npos;
+  const std::size_t end = reply.find('c', begin + DA1_REPLY_BEGIN.size());
+  return end == std::string_view::npos ? end : end + 1;
+}
+
+/**
+ * Parses the unsigned integer at the start of str, returning -1 if str does
+ * not begin with a digit
+*/
+static int parse_uint_prefix(std::string_view str, std::size_t& len) {
+  int value = 0;
+  len = 0;
+  while (len < str.size() && str[len] >= '0' && str[len] <= '9') {
+    value = value * 10 + (str[len] - '0');
+    len++;
+  }
+  return len > 0 ? value : -1;
+}
+
+TermGraphicsCaps term_parse_graphics_reply(std::string_view reply) {
+  TermGraphicsCaps caps;
+
+  // "\x1b[6;<height>;<width>t"
+  const std::size_t cell_size_begin = reply.find(CELL_SIZE_REPLY_BEGIN);
+  if (cell_size_begin != std::string_view::npos) {
+    std::string_view params = reply.substr(cell_size_begin + CELL_SIZE_REPLY_BEGIN.size());
+    std::size_t len = 0;
+    const int height = parse_uint_prefix(params, len);
+    if (height > 0 && len < params.size() && params[len] == ';') {
+      params.remove_prefix(len + 1);
+      const int width = parse_uint_prefix(params, len);
+      if (width > 0 && len < params.size() && params[len] == 't') {
+        caps.cell_pixels = Dim2(width, height);
+      }
+    }
+  }
+
+  if (reply.find(KITTY_QUERY_OK) != std::string_view::npos) {
+    caps.protocol = TermGraphics::KITTY;
+    return caps;
+  }
+
+  // "\x1b[?<attribute>;<attribute>;...c", where attribute 4 is Sixel graphics
+  const std::size_t da1_end = find_da1_reply_end(reply);
+  if (da1_end == std::string_view::npos) return caps;
+  const std::size_t da1_begin = reply.find(DA1_REPLY_BEGIN) + DA1_REPLY_BEGIN.size();
+  std::string_view attributes = reply.substr(da1_begin, da1_end - 1 - da1_begin);
+  while (!attributes.empty()) {
+    const std::size_t sep = attributes.find(';');
+    if (attributes.substr(0, sep) == DA1_SIXEL_ATTRIBUTE) {
+      caps.protocol = TermGraphics::SIXEL;
+      break;
+    }
+    if (sep == std::string_view::npos) break;
+    attributes.remove_prefix(sep + 1);
+  }
+
+  return caps;
+}
+
+TermGraphicsCaps term_probe_graphics(int timeout_ms) {
+  probed_graphics_caps = TermGraphicsCaps();
+  if (term_is_limited() || !isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO))
+    return probed_graphics_caps;
+
+  struct termios saved;
+  if (tcgetattr(STDIN_FILENO, &saved) != 0) return probed_graphics_caps;
+  struct termios raw = saved;
+  raw.c_lflag &= ~(ICANON | ECHO);
+  raw.c_cc[VMIN] = 0;
+  raw.c_cc[VTIME] = 0;
+  if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) return probed_graphics_caps;
+
+  std::string reply;
+  if (term_write_all(STDOUT_FILENO, GRAPHICS_QUERY, sizeof(GRAPHICS_QUERY) - 1)) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (find_da1_reply_end(reply) == std::string_view::npos) {
+      const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+      if (remaining <= 0) break;
+
+      struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+      if (poll(&pfd, 1, static_cast<int>(remaining)) <= 0) break;
+      char buf[256];
+      const ssize_t nb_read = read(STDIN_FILENO, buf, sizeof(buf));
+      if (nb_read <= 0) break;
+      reply.append(buf, static_cast<std::size_t>(nb_read));
+    }
+  }
+
+  tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+  probed_graphics_caps = term_parse_graphics_reply(reply);
+  return probed_graphics_caps;
+}
+
+const TermGraphicsCaps& term_graphics_caps() {
+  return probed_graphics_caps;
+}
+
+Dim2 term_cell_pixels() {
+  struct winsize ws;
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_xpixel > 0
+    && ws.ws_ypixel > 0 && ws.ws_col > 0 && ws.ws_row > 0) {
+    return Dim2(ws.ws_xpixel / ws.ws_col, ws.ws_ypixel / ws.ws_row);
+  }
+  return probed_graphics_caps.cell_pixels;
+}
@@ -0,0 +1,60 @@
+#include <tmedia/term/ansiframe.h>
+
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+
+static std::string_view frame_str(const AnsiFrame& frame) {
+  return std::string_view(frame.data(), frame.size());
+}
+
+TEST_CASE("ansiframe", "[ansiframe]") {
+  AnsiFrame frame;
+
+  SECTION("Repeated colors are only set once") {
+    const AnsiCell cells[3] = {
+      {'a', 0xFF0000, ANSI_DEFAULT_COLOR},
+      {'b', 0xFF0000, ANSI_DEFAULT_COLOR},
+      {'c', 0x00FF0A, ANSI_DEFAULT_COLOR}
+    };
+
+    frame.begin_frame(false);
+    frame.put_cells(2, 4, cells, 3);
+    frame.end_frame();
+    REQUIRE(frame.get_nb_cells() == 3);
+    REQUIRE(frame_str(frame) == "\x1b" "7" "\x1b[0m"
+      "\x1b[3;5H" "\x1b[38;2;255;0;0m" "ab" "\x1b[38;2;0;255;10m" "c"
+      "\x1b[0m" "\x1b" "8");
+  }
+
+  SECTION("Background colors and multibyte codepoints") {
+    const AnsiCell cells[2] = {
+      {0x2580, 0x010203, 0x040506},
+      {' ', ANSI_DEFAULT_COLOR, 0x040506}
+    };
+
+    frame.begin_frame(true);
+    frame.put_cells(0, 0, cells, 2);
+    frame.end_frame();
+    REQUIRE(frame_str(frame) == "\x1b[?2026h" "\x1b" "7" "\x1b[0m"
+      "\x1b[1;1H" "\x1b[38;2;1;2;3;48;2;4;5;6m" "\xe2\x96\x80" "\x1b[39m" " "
+      "\x1b[0m" "\x1b" "8" "\x1b[?2026l");
+  }
+
+  SECTION("Frames without cells are not written") {
+    frame.begin_frame(true);
+    frame.end_frame();
+    REQUIRE(frame.get_nb_cells() == 0);
+    REQUIRE(frame.flush(-1));
+    REQUIRE(frame.size() == 0);
+  }
+}
+
+TEST_CASE("ansi_reduce_color", "[ansiframe]") {
+  REQUIRE(ansi_reduce_color(0x12AB7F, 8) == 0x12AB7F);
+  REQUIRE(ansi_reduce_color(0x12AB7F, 4) == 0x18A878);
+  REQUIRE(ansi_reduce_color(0xFFFFFF, 1) == 0xC0C0C0);
+  REQUIRE(ansi_reduce_color(0x000000, 1) == 0x404040);
+  REQUIRE(ansi_reduce_color(0x101010, 6) == ansi_reduce_color(0x121212, 6));
+}
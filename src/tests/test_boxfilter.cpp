@@ -0,0 +1,157 @@
+#include <tmedia/image/boxfilter.h>
+
+#include <tmedia/image/pixeldata.h>
+#include <tmedia/image/color.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+static std::vector<std::uint8_t> make_image(int width, int height, int channels) {
+  std::vector<std::uint8_t> image(static_cast<std::size_t>(width) * height * channels);
+  for (std::size_t i = 0; i < image.size(); i++) {
+    image[i] = static_cast<std::uint8_t>((i * 2654435761u) >> 24);
+  }
+  return image;
+}
+
+/**
+ * Straightforward box filter with the same boxes and rounding as box_filter
+*/
+static std::vector<std::uint8_t> reference_box_filter(const std::vector<std::uint8_t>& src, int src_width, int src_height, int channels, int dst_width, int dst_height) {
+  std::vector<std::uint8_t> dst(static_cast<std::size_t>(dst_width) * dst_height * channels);
+  for (int row = 0; row < dst_height; row++) {
+    const int row_begin = std::min(src_height - 1, static_cast<int>(static_cast<std::int64_t>(row) * src_height / dst_height));
+    const int row_end = std::max(row_begin + 1, static_cast<int>(static_cast<std::int64_t>(row + 1) * src_height / dst_height));
+    for (int col = 0; col < dst_width; col++) {
+      const int col_begin = std::min(src_width - 1, static_cast<int>(static_cast<std::int64_t>(col) * src_width / dst_width));
+      const int col_end = std::max(col_begin + 1, static_cast<int>(static_cast<std::int64_t>(col + 1) * src_width / dst_width));
+      const std::uint32_t count = static_cast<std::uint32_t>((row_end - row_begin) * (col_end - col_begin));
+      for (int c = 0; c < channels; c++) {
+        std::uint32_t sum = 0;
+        for (int r = row_begin; r < row_end; r++) {
+          for (int k = col_begin; k < col_end; k++) {
+            sum += src[(static_cast<std::size_t>(r) * src_width + k) * channels + c];
+          }
+        }
+        dst[(static_cast<std::size_t>(row) * dst_width + col) * channels + c] = static_cast<std::uint8_t>((sum + count / 2) / count);
+      }
+    }
+  }
+  return dst;
+}
+
+static void require_matches_reference(int src_width, int src_height, int channels, int dst_width, int dst_height) {
+  const std::vector<std::uint8_t> src = make_image(src_width, src_height, channels);
+  std::vector<std::uint8_t> dst(static_cast<std::size_t>(dst_width) * dst_height * channels);
+  box_filter(src.data(), src_width, src_height, channels, dst.data(), dst_width, dst_height);
+  REQUIRE(dst == reference_box_filter(src, src_width, src_height, channels, dst_width, dst_height));
+}
+
+TEST_CASE("boxfilter", "[image manipulation]") {
+  SECTION("Matches the reference filter") {
+    require_matches_reference(1920, 1080, 3, 240, 67);
+    require_matches_reference(1280, 720, 1, 213, 60);
+    require_matches_reference(37, 23, 3, 5, 4); // rows shorter than the SIMD kernels
+    require_matches_reference(100, 100, 4, 33, 33);
+    require_matches_reference(10, 10, 2, 3, 3);
+  }
+
+  SECTION("Boxes too tall for 16-bit sums") {
+    require_matches_reference(20, 1200, 3, 2, 2);
+  }
+
+  SECTION("Uniform images stay uniform") {
+    const std::vector<std::uint8_t> src(97 * 61 * 3, 201);
+    std::vector<std::uint8_t> dst(13 * 7 * 3);
+    box_filter(src.data(), 97, 61, 3, dst.data(), 13, 7);
+    for (std::uint8_t value : dst) {
+      REQUIRE(value == 201);
+    }
+  }
+
+  SECTION("Enlarging repeats pixels") {
+    const std::vector<std::uint8_t> src = { 10, 20, 30, 40 };
+    std::vector<std::uint8_t> dst(4 * 4);
+    box_filter(src.data(), 2, 2, 1, dst.data(), 4, 4);
+    REQUIRE(dst == std::vector<std::uint8_t>{
+      10, 10, 20, 20,
+      10, 10, 20, 20,
+      30, 30, 40, 40,
+      30, 30, 40, 40 });
+  }
+
+  SECTION("Gray and color PixelData scale alike") {
+    const std::vector<std::uint8_t> grays = make_image(64, 48, 1);
+    std::vector<RGB24> colors;
+    for (std::uint8_t gray : grays) colors.push_back(RGB24(gray));
+
+    const PixelData gray(std::make_shared<std::vector<std::uint8_t>>(grays), 64, 48);
+    const PixelData color(colors, 64, 48);
+    const PixelData scaled_gray = gray.scale(0.3, ScalingAlgo::BOX_SAMPLING);
+    const PixelData scaled_color = color.scale(0.3, ScalingAlgo::BOX_SAMPLING);
+    REQUIRE(scaled_gray.get_width() == 19);
+    REQUIRE(scaled_gray.get_height() == 14);
+    REQUIRE(scaled_gray.equals(scaled_color));
+  }
+}
+
+/**
+ * The box sampling PixelData::scale did before box_filter, averaging each
+ * area through get_avg_color_from_area
+*/
+static PixelData scale_by_area_average(const PixelData& pixel_data, double amount) {
+  const int new_width = pixel_data.get_width() * amount;
+  const int new_height = pixel_data.get_height() * amount;
+  const double box_size = 1 / amount;
+  std::vector<RGB24> pixels;
+  pixels.reserve(new_width * new_height);
+  for (double new_row = 0; new_row < new_height; new_row++) {
+    for (double new_col = 0; new_col < new_width; new_col++) {
+      pixels.push_back(get_avg_color_from_area(pixel_data, new_row * box_size, new_col * box_size, box_size, box_size));
+    }
+  }
+  return PixelData(pixels, new_width, new_height);
+}
+
+template <typename F>
+static double megapixels_per_sec(int src_width, int src_height, int iterations, F&& scale) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) scale();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(src_width) * src_height * iterations / 1e6 / elapsed.count();
+}
+
+// Hidden, run with: tmedia_tests "[benchmark]"
+TEST_CASE("boxfilter benchmark", "[.][benchmark]") {
+  static constexpr int WIDTH = 1920;
+  static constexpr int HEIGHT = 1080;
+  static constexpr double AMOUNT = 0.125; // a 1080p frame bounded into 240x135 cells
+  static constexpr int ITERATIONS = 20;
+
+  const std::vector<std::uint8_t> bytes = make_image(WIDTH, HEIGHT, 3);
+  std::vector<RGB24> colors;
+  std::vector<std::uint8_t> grays;
+  for (std::size_t i = 0; i < bytes.size(); i += 3) {
+    colors.push_back(RGB24(bytes[i], bytes[i + 1], bytes[i + 2]));
+    grays.push_back(bytes[i]);
+  }
+  const PixelData color(colors, WIDTH, HEIGHT);
+  const PixelData gray(std::make_shared<std::vector<std::uint8_t>>(grays), WIDTH, HEIGHT);
+
+  const double before = megapixels_per_sec(WIDTH, HEIGHT, ITERATIONS, [&] { scale_by_area_average(color, AMOUNT); });
+  const double after = megapixels_per_sec(WIDTH, HEIGHT, ITERATIONS, [&] { color.scale(AMOUNT, ScalingAlgo::BOX_SAMPLING); });
+  const double after_gray = megapixels_per_sec(WIDTH, HEIGHT, ITERATIONS, [&] { gray.scale(AMOUNT, ScalingAlgo::BOX_SAMPLING); });
+
+  std::cout << fmt::format("{}x{} box sampling at {}x:\n"
+    "  area average (before): {:.1f} MP/s\n"
+    "  box filter, RGB24:     {:.1f} MP/s\n"
+    "  box filter, GRAY8:     {:.1f} MP/s\n", WIDTH, HEIGHT, AMOUNT, before, after, after_gray);
+  REQUIRE(after > 0);
+}
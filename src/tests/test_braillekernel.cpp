@@ -0,0 +1,80 @@
+#include <tmedia/tmcurses/braillekernel.h>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+#include <catch2/catch_test_macros.hpp>
+
+static int raised_dots(std::uint32_t codepoint) {
+  return static_cast<int>(std::bitset<8>(codepoint - BRAILLE_BLANK).count());
+}
+
+TEST_CASE("braillekernel", "[braillekernel]") {
+  static constexpr int WIDTH = 8;
+  const BrailleKernel kernel;
+  std::array<std::uint8_t, WIDTH * BRAILLE_CELL_HEIGHT> grays;
+  std::array<std::uint32_t, WIDTH / 2> cells;
+
+  SECTION("Black pixels raise no dots") {
+    grays.fill(0);
+    kernel.map_row(grays.data(), WIDTH, BRAILLE_CELL_HEIGHT, cells.data());
+    for (std::uint32_t cell : cells) {
+      REQUIRE(cell == BRAILLE_BLANK);
+    }
+  }
+
+  SECTION("White pixels raise every dot") {
+    grays.fill(255);
+    kernel.map_row(grays.data(), WIDTH, BRAILLE_CELL_HEIGHT, cells.data());
+    for (std::uint32_t cell : cells) {
+      REQUIRE(cell == 0x28FF);
+    }
+  }
+
+  SECTION("Single pixels map to their dot") {
+    static constexpr std::uint32_t EXPECTED[BRAILLE_CELL_HEIGHT][BRAILLE_CELL_WIDTH] = {
+      { 0x2801, 0x2808 },
+      { 0x2802, 0x2810 },
+      { 0x2804, 0x2820 },
+      { 0x2840, 0x2880 }
+    };
+
+    for (int row = 0; row < BRAILLE_CELL_HEIGHT; row++) {
+      for (int col = 0; col < BRAILLE_CELL_WIDTH; col++) {
+        grays.fill(0);
+        grays[row * WIDTH + col] = 255;
+        kernel.map_row(grays.data(), WIDTH, BRAILLE_CELL_HEIGHT, cells.data());
+        REQUIRE(cells[0] == EXPECTED[row][col]);
+        REQUIRE(cells[1] == BRAILLE_BLANK);
+      }
+    }
+  }
+
+  SECTION("Mid gray raises half of the dots") {
+    grays.fill(128);
+    kernel.map_row(grays.data(), WIDTH, BRAILLE_CELL_HEIGHT, cells.data());
+    for (std::uint32_t cell : cells) {
+      REQUIRE(raised_dots(cell) == 4);
+    }
+  }
+
+  SECTION("Brighter pixels never raise fewer dots") {
+    int last_dots = 0;
+    for (int v = 0; v < 256; v++) {
+      grays.fill(static_cast<std::uint8_t>(v));
+      kernel.map_row(grays.data(), WIDTH, BRAILLE_CELL_HEIGHT, cells.data());
+      const int dots = raised_dots(cells[0]);
+      REQUIRE(dots >= last_dots);
+      last_dots = dots;
+    }
+  }
+
+  SECTION("Missing rows and columns raise no dots") {
+    grays.fill(255);
+    std::array<std::uint32_t, 2> odd_cells;
+    kernel.map_row(grays.data(), 3, 1, odd_cells.data());
+    REQUIRE(odd_cells[0] == (BRAILLE_BLANK | 0x01 | 0x08));
+    REQUIRE(odd_cells[1] == (BRAILLE_BLANK | 0x01));
+  }
+}
@@ -0,0 +1,78 @@
+#include <tmedia/media/catchup.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("catchup", "[catchup]") {
+  static constexpr double FRAME_DURATION = 1.0 / 16.0;
+  static constexpr double BEHIND = FRAME_DURATION * 10;
+  static constexpr double ON_TIME = -FRAME_DURATION;
+  CatchupController catchup;
+  double pts = 0.0;
+  REQUIRE(catchup.level() == 0);
+
+  SECTION("On time decoding never discards") {
+    for (int i = 0; i < 100; i++) {
+      REQUIRE(catchup.update(ON_TIME, FRAME_DURATION, pts) == 0);
+      pts += FRAME_DURATION;
+    }
+  }
+
+  SECTION("Escalation waits for each level to settle") {
+    for (int i = 0; i < CatchupController::SETTLE_FRAMES - 1; i++) {
+      REQUIRE(catchup.update(BEHIND, FRAME_DURATION, pts) == 0);
+      pts += FRAME_DURATION;
+    }
+    REQUIRE(catchup.update(BEHIND, FRAME_DURATION, pts) == 1);
+    pts += FRAME_DURATION;
+    REQUIRE(catchup.update(BEHIND, FRAME_DURATION, pts) == 1);
+  }
+
+  SECTION("Escalation is bounded") {
+    for (int i = 0; i < 1000; i++) {
+      catchup.update(BEHIND, FRAME_DURATION, pts);
+      pts += FRAME_DURATION;
+    }
+    REQUIRE(catchup.level() == CatchupController::MAX_LEVEL);
+
+    SECTION("Relaxes one level per on time streak") {
+      const int streak_frames = static_cast<int>(CatchupController::RELAX_SECS / FRAME_DURATION);
+      for (int i = 0; i < streak_frames; i++) {
+        REQUIRE(catchup.update(ON_TIME, FRAME_DURATION, pts) == CatchupController::MAX_LEVEL);
+        pts += FRAME_DURATION;
+      }
+      REQUIRE(catchup.update(ON_TIME, FRAME_DURATION, pts) == CatchupController::MAX_LEVEL - 1);
+    }
+
+    SECTION("Relaxing takes as long when few frames are decoded") {
+      static constexpr double KEYFRAME_INTERVAL = 2.0;
+      REQUIRE(catchup.update(ON_TIME, FRAME_DURATION, pts) == CatchupController::MAX_LEVEL);
+      REQUIRE(catchup.update(ON_TIME, FRAME_DURATION, pts + KEYFRAME_INTERVAL) == CatchupController::MAX_LEVEL - 1);
+      REQUIRE(catchup.update(ON_TIME, FRAME_DURATION, pts + KEYFRAME_INTERVAL * 2) == CatchupController::MAX_LEVEL - 2);
+    }
+
+    SECTION("Lateness restarts the on time streak") {
+      for (int i = 0; i < 8; i++) {
+        catchup.update(ON_TIME, FRAME_DURATION, pts);
+        pts += FRAME_DURATION;
+      }
+      catchup.update(FRAME_DURATION * 2, FRAME_DURATION, pts);
+      pts += FRAME_DURATION;
+      for (int i = 0; i < 12; i++) {
+        REQUIRE(catchup.update(ON_TIME, FRAME_DURATION, pts) == CatchupController::MAX_LEVEL);
+        pts += FRAME_DURATION;
+      }
+    }
+
+    SECTION("Lag between thresholds holds the current level") {
+      for (int i = 0; i < 1000; i++) {
+        REQUIRE(catchup.update(FRAME_DURATION * 2, FRAME_DURATION, pts) == CatchupController::MAX_LEVEL);
+        pts += FRAME_DURATION;
+      }
+    }
+
+    SECTION("Reset") {
+      catchup.reset();
+      REQUIRE(catchup.level() == 0);
+    }
+  }
+}
@@ -0,0 +1,57 @@
+#include <tmedia/tmcurses/cellgrid.h>
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+  #include <curses.h>
+}
+
+TEST_CASE("cellgrid", "[cellgrid]") {
+  static constexpr int WIDTH = 20;
+  static constexpr int HEIGHT = 2;
+  CellGrid<chtype> grid;
+  std::vector<chtype> row(WIDTH, 'a');
+  std::vector<CellRun> runs;
+
+  grid.begin_frame(0, 0, WIDTH, HEIGHT);
+  REQUIRE(grid.diff_row(0, row.data(), runs) == WIDTH);
+  REQUIRE(runs.size() == 1);
+  REQUIRE(runs[0].col == 0);
+  REQUIRE(runs[0].length == WIDTH);
+  REQUIRE(grid.diff_row(1, row.data(), runs) == WIDTH);
+  REQUIRE(grid.get_frame_changed_cells() == WIDTH * HEIGHT);
+
+  SECTION("Unchanged cells are not printed again") {
+    grid.begin_frame(0, 0, WIDTH, HEIGHT);
+    REQUIRE(grid.diff_row(0, row.data(), runs) == 0);
+    REQUIRE(runs.empty());
+    REQUIRE(grid.get_frame_changed_cells() == 0);
+  }
+
+  SECTION("Nearby changes merge into one run") {
+    grid.begin_frame(0, 0, WIDTH, HEIGHT);
+    row[2] = 'b';
+    row[4] = 'b';
+    row[15] = 'b';
+    REQUIRE(grid.diff_row(0, row.data(), runs) == 3);
+    REQUIRE(runs.size() == 2);
+    REQUIRE(runs[0].col == 2);
+    REQUIRE(runs[0].length == 3);
+    REQUIRE(runs[1].col == 15);
+    REQUIRE(runs[1].length == 1);
+  }
+
+  SECTION("Invalidating or moving the grid prints every cell") {
+    grid.invalidate();
+    grid.begin_frame(0, 0, WIDTH, HEIGHT);
+    REQUIRE(grid.diff_row(0, row.data(), runs) == WIDTH);
+    grid.begin_frame(1, 0, WIDTH, HEIGHT);
+    REQUIRE(grid.diff_row(0, row.data(), runs) == WIDTH);
+    grid.begin_frame(1, 0, WIDTH, HEIGHT);
+    REQUIRE(grid.diff_row(0, row.data(), runs) == 0);
+  }
+
+  REQUIRE(grid.get_total_cells() == static_cast<std::uint64_t>(grid.get_frames() * WIDTH * HEIGHT));
+}
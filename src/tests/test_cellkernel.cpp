@@ -0,0 +1,53 @@
+#include <tmedia/tmcurses/cellkernel.h>
+
+#include <tmedia/image/ascii.h>
+#include <tmedia/image/color.h>
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+  #include <curses.h>
+}
+
+TEST_CASE("cellkernel", "[cellkernel]") {
+  static constexpr int WIDTH = 256;
+  std::array<RGB24, WIDTH> pixels;
+  std::array<std::uint8_t, WIDTH> grays;
+  std::array<chtype, WIDTH> cells;
+
+  for (int i = 0; i < WIDTH; i++) {
+    pixels[i] = RGB24((i * 7) % 256, (i * 13) % 256, (i * 31) % 256);
+    grays[i] = static_cast<std::uint8_t>(i);
+  }
+
+  SECTION("Glyphs match the gray value of each pixel") {
+    const CellKernel kernel(ASCII_STANDARD_CHAR_MAP, true, false);
+    kernel.map_row(pixels.data(), WIDTH, cells.data());
+    for (int i = 0; i < WIDTH; i++) {
+      const int gray = pixels[i].gray_val();
+      const char glyph = static_cast<char>(cells[i] & A_CHARTEXT);
+      const bool close_glyph = glyph == get_char_from_value(ASCII_STANDARD_CHAR_MAP, static_cast<std::uint8_t>(gray))
+        || glyph == get_char_from_value(ASCII_STANDARD_CHAR_MAP, static_cast<std::uint8_t>(std::max(gray - 1, 0)))
+        || glyph == get_char_from_value(ASCII_STANDARD_CHAR_MAP, static_cast<std::uint8_t>(std::min(gray + 1, 255)));
+      REQUIRE(close_glyph);
+      REQUIRE((cells[i] & A_COLOR) == 0);
+    }
+
+    kernel.map_row(grays.data(), WIDTH, cells.data());
+    for (int i = 0; i < WIDTH; i++) {
+      REQUIRE(cells[i] == static_cast<chtype>(static_cast<unsigned char>(get_char_from_value(ASCII_STANDARD_CHAR_MAP, grays[i]))));
+    }
+  }
+
+  SECTION("Cells are spaces without glyphs") {
+    const CellKernel kernel(ASCII_STANDARD_CHAR_MAP, false, false);
+    kernel.map_row(pixels.data(), WIDTH, cells.data());
+    for (int i = 0; i < WIDTH; i++) {
+      REQUIRE(cells[i] == ' ');
+    }
+  }
+}
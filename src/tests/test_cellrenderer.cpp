@@ -0,0 +1,120 @@
+#include <tmedia/tmcurses/cellrenderer.h>
+
+#include <tmedia/tmcurses/cellkernel.h>
+#include <tmedia/term/ansiframe.h>
+#include <tmedia/image/pixeldata.h>
+#include <tmedia/image/ascii.h>
+#include <tmedia/image/color.h>
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+  #include <curses.h>
+}
+
+TEST_CASE("cellrenderer", "[cellrenderer]") {
+  static constexpr int WIDTH = 7;
+  static constexpr int HEIGHT = 5;
+  std::vector<RGB24> pixels(WIDTH * HEIGHT);
+  for (std::size_t i = 0; i < pixels.size(); i++) {
+    pixels[i] = RGB24((i * 37) % 256, (i * 71) % 256, (i * 113) % 256);
+  }
+  const PixelData pixel_data(pixels, WIDTH, HEIGHT);
+  CellFramePool pool(2);
+
+  SECTION("Curses cells match the cell kernel") {
+    const std::shared_ptr<const CellRenderer> renderer = std::make_shared<const CellRenderer>(ASCII_STANDARD_CHAR_MAP, true, true);
+    REQUIRE(renderer->get_output() == CellRenderer::Output::CURSES_CELLS);
+    const CellKernel kernel(ASCII_STANDARD_CHAR_MAP, true, true);
+    std::vector<chtype> expected(WIDTH);
+
+    const std::shared_ptr<const CellFrame> frame = render_cell_frame(pool, renderer, pixel_data);
+    REQUIRE(frame->renderer == renderer);
+    REQUIRE(frame->width == WIDTH);
+    REQUIRE(frame->height == HEIGHT);
+    REQUIRE(frame->curses_cells.size() == pixels.size());
+    REQUIRE(frame->ansi_cells.empty());
+    for (int row = 0; row < HEIGHT; row++) {
+      kernel.map_row(pixels.data() + row * WIDTH, WIDTH, expected.data());
+      for (int col = 0; col < WIDTH; col++) {
+        REQUIRE(frame->curses_cells[row * WIDTH + col] == expected[col]);
+      }
+    }
+  }
+
+  SECTION("Rows can be rendered from a column") {
+    const CellRenderer renderer(ASCII_STANDARD_CHAR_MAP, true, false);
+    const CellKernel kernel(ASCII_STANDARD_CHAR_MAP, true, false);
+    std::vector<chtype> cells(3);
+    std::vector<chtype> expected(3);
+    renderer.map_row(pixel_data, 2, 4, 3, cells.data());
+    kernel.map_row(pixels.data() + 2 * WIDTH + 4, 3, expected.data());
+    REQUIRE(cells == expected);
+  }
+
+  SECTION("ANSI foreground cells") {
+    const std::shared_ptr<const CellRenderer> renderer = std::make_shared<const CellRenderer>(CellRenderer::Output::ANSI_FG, ASCII_STANDARD_CHAR_MAP, 8);
+    const std::shared_ptr<const CellFrame> frame = render_cell_frame(pool, renderer, pixel_data);
+    REQUIRE(frame->curses_cells.empty());
+    REQUIRE(frame->ansi_cells.size() == pixels.size());
+    for (std::size_t i = 0; i < pixels.size(); i++) {
+      const RGB24& pixel = pixels[i];
+      const AnsiCell& cell = frame->ansi_cells[i];
+      REQUIRE(cell.codepoint == static_cast<std::uint32_t>(get_char_from_value(ASCII_STANDARD_CHAR_MAP, pixel.gray_val())));
+      REQUIRE(cell.fg == static_cast<std::uint32_t>((pixel.r << 16) | (pixel.g << 8) | pixel.b));
+      REQUIRE(cell.bg == ANSI_DEFAULT_COLOR);
+    }
+  }
+
+  SECTION("ANSI background cells with reduced colors") {
+    const std::shared_ptr<const CellRenderer> renderer = std::make_shared<const CellRenderer>(CellRenderer::Output::ANSI_BG, ASCII_STANDARD_CHAR_MAP, 4);
+    const std::shared_ptr<const CellFrame> frame = render_cell_frame(pool, renderer, pixel_data);
+    for (std::size_t i = 0; i < pixels.size(); i++) {
+      const RGB24& pixel = pixels[i];
+      const AnsiCell& cell = frame->ansi_cells[i];
+      REQUIRE(cell.codepoint == ' ');
+      REQUIRE(cell.fg == ANSI_DEFAULT_COLOR);
+      REQUIRE(cell.bg == ansi_reduce_color((pixel.r << 16) | (pixel.g << 8) | pixel.b, 4));
+    }
+  }
+
+  SECTION("Gray frames") {
+    std::vector<std::uint8_t> grays(WIDTH * HEIGHT);
+    for (std::size_t i = 0; i < grays.size(); i++) grays[i] = static_cast<std::uint8_t>(i * 7);
+    const PixelData gray_data(std::make_shared<std::vector<std::uint8_t>>(grays), WIDTH, HEIGHT);
+    const std::shared_ptr<const CellRenderer> renderer = std::make_shared<const CellRenderer>(CellRenderer::Output::ANSI_FG, ASCII_STANDARD_CHAR_MAP, 8);
+    const std::shared_ptr<const CellFrame> frame = render_cell_frame(pool, renderer, gray_data);
+    for (std::size_t i = 0; i < grays.size(); i++) {
+      const std::uint32_t gray = grays[i];
+      REQUIRE(frame->ansi_cells[i].fg == ((gray << 16) | (gray << 8) | gray));
+    }
+  }
+
+  SECTION("Cell frames are reused once released") {
+    const std::shared_ptr<const CellRenderer> curses_renderer = std::make_shared<const CellRenderer>(ASCII_STANDARD_CHAR_MAP, true, false);
+    const std::shared_ptr<const CellRenderer> ansi_renderer = std::make_shared<const CellRenderer>(CellRenderer::Output::ANSI_BG, ASCII_STANDARD_CHAR_MAP, 8);
+    std::shared_ptr<const CellFrame> first = render_cell_frame(pool, curses_renderer, pixel_data);
+    std::shared_ptr<const CellFrame> second = render_cell_frame(pool, curses_renderer, pixel_data);
+    REQUIRE(first != second);
+    REQUIRE(pool.size() == 2);
+
+    const CellFrame* released = first.get();
+    first.reset();
+    const std::shared_ptr<const CellFrame> reused = render_cell_frame(pool, ansi_renderer, pixel_data);
+    REQUIRE(reused.get() == released);
+    REQUIRE(reused->renderer == ansi_renderer);
+    REQUIRE(reused->curses_cells.empty());
+    REQUIRE(reused->ansi_cells.size() == pixels.size());
+
+    // beyond capacity, cell frames are handed out without being kept
+    const std::shared_ptr<const CellFrame> extra = render_cell_frame(pool, curses_renderer, pixel_data);
+    REQUIRE(pool.size() == 2);
+    REQUIRE(extra != second);
+    REQUIRE(extra != reused);
+  }
+}
@@ -0,0 +1,64 @@
+#include <tmedia/util/framepacer.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+// every time below is exactly representable, so that deadlines compare exactly
+TEST_CASE("framepacer", "[framepacer]") {
+  FramePacer pacer(4.0); // 0.25 second refreshes
+
+  SECTION("Time spent refreshing is subtracted") {
+    pacer.begin_refresh(0.0);
+    REQUIRE(pacer.end_refresh(0.0625) == 0.25);
+    pacer.begin_refresh(0.25);
+    REQUIRE(pacer.end_refresh(0.375) == 0.5);
+    REQUIRE(pacer.get_refreshes() == 2);
+    REQUIRE(pacer.get_overruns() == 0);
+    REQUIRE(pacer.get_mean_slack() == 0.15625);
+    REQUIRE(pacer.get_min_slack() == 0.125);
+    REQUIRE(pacer.get_max_overrun() == 0.0);
+  }
+
+  SECTION("Late wakeups do not drift the grid") {
+    pacer.begin_refresh(0.0);
+    REQUIRE(pacer.end_refresh(0.125) == 0.25);
+    pacer.begin_refresh(0.28125);
+    REQUIRE(pacer.end_refresh(0.375) == 0.5);
+  }
+
+  SECTION("Overruns skip missed boundaries") {
+    pacer.begin_refresh(0.0);
+    REQUIRE(pacer.end_refresh(0.625) == 0.75);
+    REQUIRE(pacer.get_overruns() == 1);
+    REQUIRE(pacer.get_max_overrun() == 0.375);
+    REQUIRE(pacer.get_min_slack() == -0.375);
+
+    pacer.begin_refresh(0.75);
+    REQUIRE(pacer.end_refresh(0.875) == 1.0);
+    REQUIRE(pacer.get_overruns() == 1);
+  }
+
+  SECTION("Refreshes ending exactly on a deadline do not overrun") {
+    pacer.begin_refresh(0.0);
+    REQUIRE(pacer.end_refresh(0.25) == 0.25);
+    REQUIRE(pacer.get_overruns() == 0);
+  }
+
+  SECTION("Early refreshes move the grid") {
+    pacer.begin_refresh(0.0);
+    REQUIRE(pacer.end_refresh(0.0625) == 0.25);
+    pacer.begin_refresh(0.125);
+    REQUIRE(pacer.end_refresh(0.1875) == 0.375);
+  }
+
+  SECTION("Reset statistics") {
+    pacer.begin_refresh(0.0);
+    pacer.end_refresh(0.625);
+    pacer.reset_stats();
+    REQUIRE(pacer.get_refreshes() == 0);
+    REQUIRE(pacer.get_overruns() == 0);
+    REQUIRE(pacer.get_mean_slack() == 0.0);
+    REQUIRE(pacer.get_max_overrun() == 0.0);
+    pacer.begin_refresh(0.75);
+    REQUIRE(pacer.end_refresh(0.875) == 1.0);
+  }
+}
@@ -0,0 +1,152 @@
+#include <tmedia/media/framequeue.h>
+
+#include <tmedia/image/pixeldata.h>
+#include <tmedia/image/color.h>
+#include <tmedia/tmcurses/cellrenderer.h>
+
+#include <vector>
+#include <memory>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+static PixelData mock_frame(int size) {
+  return PixelData(std::vector<RGB24>(size * size, RGB24(0, 0, 0)), size, size);
+}
+
+TEST_CASE("framequeue", "[framequeue]") {
+  FrameQueue frame_queue(3);
+  REQUIRE(frame_queue.empty());
+  REQUIRE_FALSE(frame_queue.full());
+  REQUIRE_FALSE(frame_queue.pop_due(100.0).has_value());
+
+  const unsigned int serial = frame_queue.serial();
+  REQUIRE(frame_queue.push(mock_frame(1), 0.0, serial));
+  REQUIRE(frame_queue.push(mock_frame(2), 1.0, serial));
+  REQUIRE(frame_queue.push(mock_frame(3), 2.0, serial));
+  REQUIRE(frame_queue.full());
+  REQUIRE(frame_queue.size() == 3);
+
+  SECTION("Frames are not presented early") {
+    std::optional<PixelData> due = frame_queue.pop_due(0.5);
+    REQUIRE(due.has_value());
+    REQUIRE(due->get_width() == 1);
+    REQUIRE_FALSE(frame_queue.pop_due(0.9).has_value());
+    REQUIRE(frame_queue.size() == 2);
+  }
+
+  SECTION("Late frames are skipped") {
+    std::optional<PixelData> due = frame_queue.pop_due(1.5);
+    REQUIRE(due.has_value());
+    REQUIRE(due->get_width() == 2);
+    REQUIRE(frame_queue.size() == 1);
+  }
+
+  SECTION("Exact timestamps are due") {
+    std::optional<PixelData> due = frame_queue.pop_due(2.0);
+    REQUIRE(due.has_value());
+    REQUIRE(due->get_width() == 3);
+    REQUIRE(frame_queue.empty());
+  }
+
+  SECTION("Pop front") {
+    REQUIRE(frame_queue.pop_front().get_width() == 1);
+    REQUIRE_FALSE(frame_queue.full());
+  }
+
+  SECTION("Push past capacity") {
+    REQUIRE(frame_queue.push(mock_frame(4), 3.0, serial));
+    REQUIRE(frame_queue.size() == 4);
+    REQUIRE(frame_queue.full());
+  }
+
+  SECTION("Push past every slot") {
+    REQUIRE(frame_queue.push(mock_frame(4), 3.0, serial));
+    REQUIRE_FALSE(frame_queue.push(mock_frame(5), 4.0, serial));
+    REQUIRE(frame_queue.size() == 4);
+  }
+
+  SECTION("Clear") {
+    frame_queue.clear();
+    REQUIRE(frame_queue.empty());
+    REQUIRE_FALSE(frame_queue.pop_due(100.0).has_value());
+  }
+
+  SECTION("Frames pushed with an outdated serial are dropped") {
+    frame_queue.clear();
+    REQUIRE(frame_queue.serial() != serial);
+    REQUIRE(frame_queue.push(mock_frame(4), 3.0, serial));
+    REQUIRE(frame_queue.empty());
+
+    REQUIRE(frame_queue.push(mock_frame(5), 4.0, serial));
+    REQUIRE(frame_queue.push(mock_frame(6), 5.0, frame_queue.serial()));
+    REQUIRE_FALSE(frame_queue.empty());
+    REQUIRE(frame_queue.pop_front().get_width() == 6);
+  }
+
+  SECTION("Presented frame") {
+    REQUIRE_FALSE(frame_queue.presented().has_value());
+    REQUIRE(frame_queue.pop_due(1.0).has_value());
+    REQUIRE(frame_queue.presented().has_value());
+    REQUIRE(frame_queue.presented()->get_width() == 2);
+
+    frame_queue.clear();
+    REQUIRE(frame_queue.presented()->get_width() == 2);
+  }
+
+  SECTION("Cells are handed over with their frame") {
+    frame_queue.clear();
+    std::shared_ptr<CellFrame> cells = std::make_shared<CellFrame>();
+    cells->width = 4;
+    REQUIRE(frame_queue.push(mock_frame(4), 3.0, frame_queue.serial(), cells));
+    REQUIRE(frame_queue.push(mock_frame(5), 4.0, frame_queue.serial()));
+    REQUIRE(frame_queue.popped_cells() == nullptr);
+
+    REQUIRE(frame_queue.pop_due(3.0)->get_width() == 4);
+    REQUIRE(frame_queue.popped_cells() == cells);
+    REQUIRE(frame_queue.pop_due(4.0)->get_width() == 5);
+    REQUIRE(frame_queue.popped_cells() == nullptr);
+  }
+
+  SECTION("Presented frame is never overwritten") {
+    REQUIRE(frame_queue.pop_due(0.5).has_value());
+    frame_queue.clear();
+    for (int i = 0; i < 3; i++) {
+      REQUIRE(frame_queue.push(mock_frame(10 + i), 3.0 + i, frame_queue.serial()));
+    }
+    REQUIRE(frame_queue.full());
+    REQUIRE_FALSE(frame_queue.push(mock_frame(20), 10.0, frame_queue.serial()));
+    REQUIRE(frame_queue.presented()->get_width() == 1);
+  }
+}
+
+TEST_CASE("framequeue across threads", "[framequeue]") {
+  static constexpr int NB_FRAMES = 5000;
+  FrameQueue frame_queue(4);
+
+  std::thread producer([&frame_queue] {
+    for (int i = 1; i <= NB_FRAMES; i++) {
+      while (!frame_queue.push(mock_frame(i % 7 + 1), static_cast<double>(i), frame_queue.serial())) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int last_pts_frame = 0;
+  bool in_order = true;
+  while (last_pts_frame < NB_FRAMES) {
+    if (frame_queue.empty()) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    // frames are popped one at a time, so that every width is checked
+    const PixelData frame = frame_queue.pop_front();
+    last_pts_frame++;
+    in_order = in_order && frame.get_width() == last_pts_frame % 7 + 1;
+  }
+
+  producer.join();
+  REQUIRE(in_order);
+  REQUIRE(frame_queue.empty());
+}
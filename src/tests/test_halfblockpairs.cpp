@@ -0,0 +1,61 @@
+#include <tmedia/tmcurses/halfblockpairs.h>
+
+#include <tmedia/image/color.h>
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("halfblockpairs", "[halfblockpairs]") {
+  SECTION("Picks the largest cube that fits") {
+    REQUIRE(halfblock_nb_pairs(4) == 64 * 65);
+    REQUIRE(halfblock_side_for(32767) == 4);
+    REQUIRE(halfblock_side_for(halfblock_nb_pairs(4)) == 4);
+    REQUIRE(halfblock_side_for(halfblock_nb_pairs(4) - 1) == 3);
+    REQUIRE(halfblock_side_for(halfblock_nb_pairs(3) - 1) == 2);
+    REQUIRE(halfblock_side_for(halfblock_nb_pairs(2) - 1) == 0);
+    REQUIRE(halfblock_side_for(0) == 0);
+    REQUIRE(halfblock_side_for(-1) == 0);
+  }
+
+  SECTION("Quantizes colors to the nearest cube step") {
+    for (int side : HALFBLOCK_SIDES) {
+      const int max_step = side - 1;
+      REQUIRE(halfblock_cube_index(RGB24(0, 0, 0), side) == 0);
+      REQUIRE(halfblock_cube_index(RGB24(255, 255, 255), side) == halfblock_cube_size(side) - 1);
+      REQUIRE(halfblock_cube_index(RGB24(255, 0, 0), side) == max_step * side * side);
+      REQUIRE(halfblock_cube_index(RGB24(0, 255, 0), side) == max_step * side);
+      REQUIRE(halfblock_cube_index(RGB24(0, 0, 255), side) == max_step);
+    }
+
+    REQUIRE(halfblock_cube_index(RGB24(0, 0, 127), 2) == 0);
+    REQUIRE(halfblock_cube_index(RGB24(0, 0, 128), 2) == 1);
+    REQUIRE(halfblock_cube_index(RGB24(0, 0, 42), 4) == 0);
+    REQUIRE(halfblock_cube_index(RGB24(0, 0, 43), 4) == 1);
+  }
+
+  SECTION("Gives every pair its own offset within the layout") {
+    for (int side : HALFBLOCK_SIDES) {
+      const int cube_size = halfblock_cube_size(side);
+      std::vector<bool> used(halfblock_nb_pairs(side), false);
+
+      for (int top = 0; top < cube_size; top++) {
+        for (int bottom = 0; bottom < cube_size; bottom++) {
+          const int offset = halfblock_pair_offset(top, bottom, side);
+          REQUIRE(offset >= 0);
+          REQUIRE(offset < halfblock_nb_pairs(side));
+          REQUIRE_FALSE(used[offset]);
+          used[offset] = true;
+        }
+
+        const int offset = halfblock_default_bg_pair_offset(top, side);
+        REQUIRE(offset >= 0);
+        REQUIRE(offset < halfblock_nb_pairs(side));
+        REQUIRE_FALSE(used[offset]);
+        used[offset] = true;
+      }
+
+      for (bool offset_used : used) REQUIRE(offset_used);
+    }
+  }
+}
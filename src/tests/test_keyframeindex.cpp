@@ -0,0 +1,88 @@
+#include <tmedia/media/keyframeindex.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+
+TEST_CASE("keyframeindex", "[keyframeindex]") {
+  KeyframeIndex index;
+  REQUIRE(index.size() == 0);
+  REQUIRE_FALSE(index.is_complete());
+  REQUIRE_FALSE(index.floor(0).has_value());
+  REQUIRE(index.get_indexed_until() == INT64_MIN);
+
+  SECTION("Ascending insertion") {
+    index.insert(0);
+    index.insert(100);
+    index.insert(200);
+    REQUIRE(index.size() == 3);
+    REQUIRE(index.get_indexed_until() == INT64_MIN);
+    REQUIRE_FALSE(index.floor(0).has_value());
+    index.set_indexed_until(200);
+    REQUIRE(index.floor(0) == 0);
+    REQUIRE(index.floor(99) == 0);
+    REQUIRE(index.floor(100) == 100);
+    REQUIRE(index.floor(150) == 100);
+    REQUIRE(index.floor(200) == 200);
+
+    SECTION("Lookups past the indexed portion fail") {
+      REQUIRE(index.get_indexed_until() == 200);
+      REQUIRE_FALSE(index.floor(201).has_value());
+      index.set_indexed_until(300);
+      REQUIRE(index.get_indexed_until() == 300);
+      index.set_indexed_until(250);
+      REQUIRE(index.get_indexed_until() == 300);
+      REQUIRE(index.floor(300) == 200);
+      REQUIRE_FALSE(index.floor(301).has_value());
+      index.set_complete();
+      REQUIRE(index.floor(100000) == 200);
+    }
+
+    SECTION("Lookups before the first keyframe fail") {
+      index.clear();
+      index.insert(50);
+      index.set_indexed_until(50);
+      REQUIRE_FALSE(index.floor(49).has_value());
+      REQUIRE(index.floor(50) == 50);
+    }
+  }
+
+  SECTION("Unordered and duplicate insertion") {
+    index.insert(200);
+    index.insert(0);
+    index.insert(100);
+    index.insert(100);
+    index.insert(0);
+    REQUIRE(index.size() == 3);
+    index.set_indexed_until(200);
+    REQUIRE(index.floor(199) == 100);
+    REQUIRE(index.floor(200) == 200);
+    REQUIRE(index.floor(-1) == std::nullopt);
+  }
+
+  SECTION("Nearest") {
+    REQUIRE_FALSE(index.nearest(0).has_value());
+    index.insert(100);
+    index.insert(200);
+    index.insert(400);
+    REQUIRE_FALSE(index.nearest(0).has_value());
+    index.set_indexed_until(400);
+    REQUIRE(index.nearest(0) == 100);
+    REQUIRE(index.nearest(149) == 100);
+    REQUIRE(index.nearest(150) == 100);
+    REQUIRE(index.nearest(151) == 200);
+    REQUIRE(index.nearest(200) == 200);
+    REQUIRE(index.nearest(350) == 400);
+    REQUIRE_FALSE(index.nearest(401).has_value());
+    index.set_complete();
+    REQUIRE(index.nearest(100000) == 400);
+  }
+
+  SECTION("Clear") {
+    index.insert(10);
+    index.set_complete();
+    index.clear();
+    REQUIRE(index.size() == 0);
+    REQUIRE_FALSE(index.is_complete());
+  }
+}
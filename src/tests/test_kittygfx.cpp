@@ -0,0 +1,68 @@
+#include <tmedia/term/kittygfx.h>
+
+#include <tmedia/image/pixeldata.h>
+#include <tmedia/image/color.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <catch2/catch_test_macros.hpp>
+
+static std::string base64_str(std::string_view str) {
+  std::string out;
+  base64_encode(reinterpret_cast<const std::uint8_t*>(str.data()), str.size(), out);
+  return out;
+}
+
+TEST_CASE("kittygfx", "[kittygfx]") {
+  SECTION("Base64 encoding and padding") {
+    REQUIRE(base64_str("") == "");
+    REQUIRE(base64_str("Man") == "TWFu");
+    REQUIRE(base64_str("Ma") == "TWE=");
+    REQUIRE(base64_str("M") == "TQ==");
+    REQUIRE(base64_str("tmedia") == "dG1lZGlh");
+  }
+
+  SECTION("Deleting images") {
+    std::string out;
+    kitty_delete_image(7, out);
+    REQUIRE(out == "\x1b_Ga=d,d=I,i=7,q=2\x1b\\");
+  }
+
+  KittyEncoder encoder;
+  std::string out;
+
+#ifndef TMEDIA_ZLIB
+  SECTION("Small frames are sent in one chunk") {
+    encoder.encode(PixelData(std::vector<RGB24>{ RGB24(255, 0, 0) }, 1, 1), 7, 2, 3, out);
+    REQUIRE(out == "\x1b_Ga=T,f=24,s=1,v=1,c=2,r=3,i=7,p=1,q=2,C=1,m=0;/wAA\x1b\\");
+  }
+
+  SECTION("Large frames are split into chunks") {
+    encoder.encode(PixelData(std::vector<RGB24>(2048, RGB24(0)), 64, 32), 7, 8, 4, out);
+    const std::string chunk(4096, 'A');
+    REQUIRE(out == "\x1b_Ga=T,f=24,s=64,v=32,c=8,r=4,i=7,p=1,q=2,C=1,m=1;" + chunk + "\x1b\\"
+      + "\x1b_Gm=0;" + chunk + "\x1b\\");
+  }
+#else
+  SECTION("Frames are compressed") {
+    encoder.encode(PixelData(std::vector<RGB24>(2048, RGB24(0)), 64, 32), 7, 8, 4, out);
+    REQUIRE(out.find(",o=z,m=0;") != std::string::npos);
+  }
+#endif
+
+  SECTION("Gray frames match the equivalent color frame") {
+    std::vector<std::uint8_t> grays;
+    std::vector<RGB24> colors;
+    for (int i = 0; i < 12; i++) {
+      grays.push_back(static_cast<std::uint8_t>(i * 20));
+      colors.push_back(RGB24(static_cast<std::uint8_t>(i * 20)));
+    }
+
+    std::string gray_out;
+    encoder.encode(PixelData(std::make_shared<std::vector<std::uint8_t>>(grays), 4, 3), 1, 4, 3, gray_out);
+    encoder.encode(PixelData(colors, 4, 3), 1, 4, 3, out);
+    REQUIRE(gray_out == out);
+  }
+}
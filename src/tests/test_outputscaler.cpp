@@ -0,0 +1,87 @@
+#include <tmedia/term/outputscaler.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("outputscaler", "[outputscaler]") {
+  static constexpr double BUDGET = 1.0 / 48.0;
+  static constexpr double BLOCKED = BUDGET * 10;
+  static constexpr double FAST = 0.0;
+  OutputScaler scaler;
+  REQUIRE(scaler.level() == 0);
+  REQUIRE(scaler.get_scale() == 1.0);
+  REQUIRE(scaler.get_color_bits() == 8);
+
+  SECTION("Output within budget never scales") {
+    for (int i = 0; i < 1000; i++) {
+      REQUIRE(scaler.update(BUDGET / 2, 1000, BUDGET) == 0);
+    }
+  }
+
+  SECTION("Escalation waits for each level to settle") {
+    for (int i = 0; i < OutputScaler::SETTLE_REFRESHES - 1; i++) {
+      REQUIRE(scaler.update(BLOCKED, 1000, BUDGET) == 0);
+    }
+    REQUIRE(scaler.update(BLOCKED, 1000, BUDGET) == 1);
+    REQUIRE(scaler.update(BLOCKED, 1000, BUDGET) == 1);
+  }
+
+  SECTION("Statistics") {
+    scaler.update(0.5, 1000, BUDGET);
+    scaler.update(0.25, 24, BUDGET);
+    REQUIRE(scaler.get_refreshes() == 2);
+    REQUIRE(scaler.get_bytes() == 1024);
+    REQUIRE(scaler.get_blocked_secs() == 0.75);
+    scaler.reset_stats();
+    REQUIRE(scaler.get_refreshes() == 0);
+    REQUIRE(scaler.get_bytes() == 0);
+    REQUIRE(scaler.get_blocked_secs() == 0.0);
+  }
+
+  SECTION("Escalation is bounded") {
+    for (int i = 0; i < 1000; i++) {
+      scaler.update(BLOCKED, 1000, BUDGET);
+    }
+    REQUIRE(scaler.level() == OutputScaler::MAX_LEVEL);
+    REQUIRE(scaler.get_scale() < 1.0);
+    REQUIRE(scaler.get_scale() > 0.0);
+    REQUIRE(scaler.get_color_bits() < 8);
+
+    SECTION("Relaxes one level per streak") {
+      int refreshes = 1;
+      while (scaler.update(FAST, 1000, BUDGET) == OutputScaler::MAX_LEVEL && refreshes < 1000) {
+        refreshes++;
+      }
+      REQUIRE(scaler.level() == OutputScaler::MAX_LEVEL - 1);
+      REQUIRE(refreshes >= OutputScaler::RELAX_STREAK);
+
+      for (int i = 0; i < OutputScaler::RELAX_STREAK - 1; i++) {
+        REQUIRE(scaler.update(FAST, 1000, BUDGET) == OutputScaler::MAX_LEVEL - 1);
+      }
+      REQUIRE(scaler.update(FAST, 1000, BUDGET) == OutputScaler::MAX_LEVEL - 2);
+    }
+
+    SECTION("Does not relax into a level which would overrun the budget") {
+      for (int i = 0; i < 1000; i++) {
+        REQUIRE(scaler.update(BUDGET * 0.7, 1000, BUDGET) == OutputScaler::MAX_LEVEL);
+      }
+    }
+
+    SECTION("Reset") {
+      scaler.reset();
+      REQUIRE(scaler.level() == 0);
+      REQUIRE(scaler.get_refreshes() == 0);
+    }
+  }
+
+  SECTION("Levels never grow the output") {
+    double scale = scaler.get_scale();
+    int color_bits = scaler.get_color_bits();
+    while (scaler.level() < OutputScaler::MAX_LEVEL) {
+      scaler.update(BLOCKED, 1000, BUDGET);
+      REQUIRE(scaler.get_scale() <= scale);
+      REQUIRE(scaler.get_color_bits() <= color_bits);
+      scale = scaler.get_scale();
+      color_bits = scaler.get_color_bits();
+    }
+  }
+}
@@ -0,0 +1,44 @@
+#include <tmedia/image/pixelbufferpool.h>
+
+#include <tmedia/image/pixeldata.h>
+#include <tmedia/image/color.h>
+
+#include <vector>
+#include <memory>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("pixelbufferpool", "[pixelbufferpool]") {
+  PixelBufferPool<RGB24> pool(2);
+  REQUIRE(pool.size() == 0);
+
+  SECTION("Released buffers are reused") {
+    std::shared_ptr<std::vector<RGB24>> first = pool.acquire(16);
+    REQUIRE(first->size() == 16);
+    const std::vector<RGB24>* first_addr = first.get();
+    first.reset();
+
+    std::shared_ptr<std::vector<RGB24>> second = pool.acquire(4);
+    REQUIRE(second.get() == first_addr);
+    REQUIRE(second->size() == 4);
+    REQUIRE(pool.size() == 1);
+  }
+
+  SECTION("Buffers referenced by PixelData are not reused") {
+    std::shared_ptr<std::vector<RGB24>> buffer = pool.acquire(4);
+    (*buffer)[0] = RGB24(255, 0, 0);
+    PixelData frame(buffer, 2, 2);
+    buffer.reset();
+
+    std::shared_ptr<std::vector<RGB24>> other = pool.acquire(4);
+    REQUIRE(other.get() != &frame.data());
+    REQUIRE(frame.at(0, 0).equals(RGB24(255, 0, 0)));
+    REQUIRE(pool.size() == 2);
+  }
+
+  SECTION("Buffers past capacity are not kept") {
+    std::vector<std::shared_ptr<std::vector<RGB24>>> held;
+    for (int i = 0; i < 4; i++) held.push_back(pool.acquire(1));
+    REQUIRE(pool.size() == 2);
+  }
+}
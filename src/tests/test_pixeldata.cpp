@@ -1,5 +1,8 @@
 #include <tmedia/image/pixeldata.h>
 
+#include <vector>
+#include <memory>
+
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("pixeldata", "[image manipulation]") {
@@ -65,4 +68,61 @@ TEST_CASE("pixeldata", "[image manipulation]") {
     REQUIRE(bounded.get_height() == grayscale.get_height() / 2);
   }
 
-}
\ No newline at end of file
+}
+TEST_CASE("pixeldata gray buffer", "[image manipulation]") {
+  std::vector<std::vector<uint8_t>> grayscale_test{
+      { 255, 255, 120, 120, 0, 0 },
+      { 255, 255, 120, 120, 0, 0 },
+      { 255, 255, 120, 120, 0, 0 },
+      { 255, 255, 120, 120, 0, 0 }
+    };
+  std::shared_ptr<std::vector<uint8_t>> grays = std::make_shared<std::vector<uint8_t>>();
+  for (const std::vector<uint8_t>& row : grayscale_test)
+    grays->insert(grays->end(), row.begin(), row.end());
+
+  PixelData rgb(grayscale_test);
+  PixelData gray(grays, 6, 4);
+  REQUIRE(gray.is_gray());
+  REQUIRE_FALSE(rgb.is_gray());
+  REQUIRE(gray.at(0, 2).equals(RGB24(120)));
+  REQUIRE(gray.equals(rgb));
+
+  SECTION("copied") {
+    PixelData copied = gray;
+    REQUIRE(copied.is_gray());
+    REQUIRE(copied.equals(gray));
+  }
+
+  SECTION("scaled like rgb") {
+    for (ScalingAlgo algo : { ScalingAlgo::BOX_SAMPLING, ScalingAlgo::NEAREST_NEIGHBOR }) {
+      PixelData scaled_gray = gray.scale(0.5, algo);
+      PixelData scaled_rgb = rgb.scale(0.5, algo);
+      REQUIRE(scaled_gray.is_gray());
+      REQUIRE(scaled_gray.get_width() == 3);
+      REQUIRE(scaled_gray.get_height() == 2);
+      REQUIRE(scaled_gray.equals(scaled_rgb));
+      REQUIRE(scaled_gray.gray_data().size() == 6);
+    }
+  }
+  SECTION("cropped like rgb") {
+    PixelData cropped_gray = gray.crop(1, 2, 3, 2);
+    PixelData cropped_rgb = rgb.crop(1, 2, 3, 2);
+    REQUIRE(cropped_gray.is_gray());
+    REQUIRE(cropped_gray.get_width() == 3);
+    REQUIRE(cropped_gray.get_height() == 2);
+    REQUIRE(cropped_gray.equals(cropped_rgb));
+    REQUIRE(cropped_gray.at(0, 0).equals(RGB24(120)));
+    REQUIRE(cropped_gray.at(1, 2).equals(RGB24(0)));
+    REQUIRE_THROWS(gray.crop(2, 4, 3, 2));
+  }
+
+  SECTION("resized like rgb") {
+    PixelData resized_gray = gray.resize(3, 1);
+    PixelData resized_rgb = rgb.resize(3, 1);
+    REQUIRE(resized_gray.is_gray());
+    REQUIRE(resized_gray.get_width() == 3);
+    REQUIRE(resized_gray.get_height() == 1);
+    REQUIRE(resized_gray.equals(resized_rgb));
+    REQUIRE(resized_gray.at(0, 1).equals(RGB24(120)));
+  }
+}
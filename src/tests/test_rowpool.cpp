@@ -0,0 +1,117 @@
+#include <tmedia/util/rowpool.h>
+
+#include <tmedia/tmcurses/cellkernel.h>
+#include <tmedia/image/ascii.h>
+#include <tmedia/image/color.h>
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include <fmt/format.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+extern "C" {
+  #include <curses.h>
+}
+
+/**
+ * Runs nb_rows rows through the pool, returning how many times each row was
+ * given to a band, and checking that bands were at least min_band_rows rows
+ * except when there were fewer rows than that
+*/
+static std::vector<int> count_rows(RowPool& pool, int nb_rows, int min_band_rows, int& nb_bands) {
+  std::vector<int> counts(static_cast<std::size_t>(nb_rows), 0);
+  std::vector<int> band_sizes(static_cast<std::size_t>(nb_rows) + 1, 0);
+  nb_bands = 0;
+  pool.run(nb_rows, min_band_rows, [&] (int begin, int end) {
+    for (int row = begin; row < end; row++) counts[row]++;
+    band_sizes[begin] = end - begin; // bands never share a beginning row
+  });
+
+  for (int size : band_sizes) {
+    if (size == 0) continue;
+    nb_bands++;
+    if (nb_rows >= min_band_rows) REQUIRE(size >= min_band_rows);
+  }
+  return counts;
+}
+
+TEST_CASE("rowpool", "[rowpool]") {
+  int nb_bands = 0;
+
+  SECTION("No workers runs on the calling thread") {
+    RowPool pool(0);
+    REQUIRE(pool.get_nb_workers() == 0);
+    for (int count : count_rows(pool, 100, 1, nb_bands)) REQUIRE(count == 1);
+    REQUIRE(nb_bands == 1);
+  }
+
+  SECTION("Every row is covered exactly once") {
+    RowPool pool(3);
+    REQUIRE(pool.get_nb_workers() == 3);
+    for (int nb_rows : {1, 2, 3, 4, 5, 7, 150, 1001}) {
+      for (int count : count_rows(pool, nb_rows, 1, nb_bands)) REQUIRE(count == 1);
+      REQUIRE(nb_bands <= 4);
+    }
+  }
+
+  SECTION("Bands respect their minimum size") {
+    RowPool pool(7);
+    for (int count : count_rows(pool, 150, 40, nb_bands)) REQUIRE(count == 1);
+    REQUIRE(nb_bands == 3);
+    for (int count : count_rows(pool, 10, 40, nb_bands)) REQUIRE(count == 1);
+    REQUIRE(nb_bands == 1);
+  }
+
+  SECTION("No rows") {
+    RowPool pool(2);
+    count_rows(pool, 0, 1, nb_bands);
+    REQUIRE(nb_bands == 0);
+  }
+
+  SECTION("Repeated jobs") {
+    RowPool pool(4);
+    std::vector<int> totals(64, 0);
+    for (int i = 0; i < 2000; i++) {
+      pool.run(64, 1, [&] (int begin, int end) {
+        for (int row = begin; row < end; row++) totals[row]++;
+      });
+    }
+    for (int total : totals) REQUIRE(total == 2000);
+  }
+}
+
+// run with the [benchmark] tag, as hidden tests are skipped by default
+TEST_CASE("rowpool cell conversion scaling", "[.][benchmark][rowpool]") {
+  static constexpr int WIDTH = 600;
+  static constexpr int HEIGHT = 150;
+  static constexpr int ITERATIONS = 200;
+
+  std::vector<RGB24> pixels(static_cast<std::size_t>(WIDTH) * HEIGHT);
+  for (std::size_t i = 0; i < pixels.size(); i++) {
+    pixels[i] = RGB24((i * 7) % 256, (i * 13) % 256, (i * 31) % 256);
+  }
+  std::vector<chtype> cells(pixels.size());
+  const CellKernel kernel(ASCII_STANDARD_CHAR_MAP, true, true);
+
+  double single_secs = 0.0;
+  for (int nb_workers : {0, 1, 3, 7}) {
+    RowPool pool(nb_workers);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+      pool.run(HEIGHT, 1, [&] (int begin, int end) {
+        for (int row = begin; row < end; row++) {
+          const std::size_t offset = static_cast<std::size_t>(row) * WIDTH;
+          kernel.map_row(pixels.data() + offset, WIDTH, cells.data() + offset);
+        }
+      });
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (nb_workers == 0) single_secs = secs;
+    WARN(fmt::format("{} threads: {:.3f} ms per {}x{} frame ({:.2f}x)", nb_workers + 1,
+    secs * 1000.0 / ITERATIONS, WIDTH, HEIGHT, single_secs / secs));
+  }
+}
@@ -68,4 +68,47 @@ TEST_CASE("Scaling functions", "[image manipulation]") {
 
 
 
-}
\ No newline at end of file
+}
+TEST_CASE("Fitting frames into cells", "[image manipulation]") {
+  SECTION("fitting frame is centered") {
+    const FrameFit fit = fit_frame(10, 4, Dim2(1, 1), 20, 10);
+    REQUIRE(fit.src_row == 0);
+    REQUIRE(fit.src_col == 0);
+    REQUIRE(fit.width == 10);
+    REQUIRE(fit.height == 4);
+    REQUIRE(fit.cells_width == 10);
+    REQUIRE(fit.cells_height == 4);
+    REQUIRE(fit.col == 5);
+    REQUIRE(fit.row == 3);
+  }
+
+  SECTION("cells cover partially filled cells") {
+    const FrameFit fit = fit_frame(7, 9, Dim2(2, 4), 10, 10);
+    REQUIRE(fit.width == 7);
+    REQUIRE(fit.height == 9);
+    REQUIRE(fit.cells_width == 4);
+    REQUIRE(fit.cells_height == 3);
+    REQUIRE(fit.col == 3);
+    REQUIRE(fit.row == 3);
+  }
+
+  SECTION("oversized frame is cropped around its center") {
+    const FrameFit fit = fit_frame(30, 21, Dim2(1, 2), 20, 5);
+    REQUIRE(fit.width == 20);
+    REQUIRE(fit.height == 10);
+    REQUIRE(fit.src_col == 5);
+    REQUIRE(fit.src_row == 5);
+    REQUIRE(fit.cells_width == 20);
+    REQUIRE(fit.cells_height == 5);
+    REQUIRE(fit.col == 0);
+    REQUIRE(fit.row == 0);
+  }
+
+  SECTION("empty box shows nothing") {
+    const FrameFit fit = fit_frame(30, 20, Dim2(1, 1), -2, 0);
+    REQUIRE(fit.width == 0);
+    REQUIRE(fit.height == 0);
+    REQUIRE(fit.cells_width == 0);
+    REQUIRE(fit.cells_height == 0);
+  }
+}
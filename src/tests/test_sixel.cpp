@@ -0,0 +1,63 @@
+#include <tmedia/term/sixel.h>
+
+#include <tmedia/image/pixeldata.h>
+#include <tmedia/image/color.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("sixel", "[sixel]") {
+  SixelEncoder encoder;
+  std::string out;
+
+  SECTION("Runs of a single color are repeated") {
+    const PixelData frame(std::vector<RGB24>(8 * 6, RGB24(255)), 8, 6);
+    encoder.encode(frame, out);
+    REQUIRE(out == "\x1bP0;1;0q" "\"1;1;8;6" "#215;2;100;100;100"
+      "#215!8~" "\x1b\\");
+  }
+
+  SECTION("Short runs are written out and bands are separated") {
+    const PixelData frame(std::vector<RGB24>(3 * 7, RGB24(0)), 3, 7);
+    encoder.encode(frame, out);
+    REQUIRE(out == "\x1bP0;1;0q" "\"1;1;3;7" "#0;2;0;0;0"
+      "#0~~~" "-" "#0@@@" "\x1b\\");
+  }
+
+  SECTION("Each color of a band is overlaid from the band's start") {
+    std::vector<RGB24> pixels;
+    for (int row = 0; row < 6; row++) {
+      pixels.insert(pixels.end(), { RGB24(255), RGB24(255), RGB24(0), RGB24(0) });
+    }
+
+    encoder.encode(PixelData(pixels, 4, 6), out);
+    REQUIRE(out == "\x1bP0;1;0q" "\"1;1;4;6" "#0;2;0;0;0" "#215;2;100;100;100"
+      "#215~~" "$" "#0??~~" "\x1b\\");
+  }
+
+  SECTION("Gray frames match the equivalent color frame") {
+    std::vector<std::uint8_t> grays;
+    std::vector<RGB24> colors;
+    for (int i = 0; i < 16 * 12; i++) {
+      grays.push_back(static_cast<std::uint8_t>(i * 7));
+      colors.push_back(RGB24(static_cast<std::uint8_t>(i * 7)));
+    }
+
+    std::string gray_out;
+    encoder.encode(PixelData(std::make_shared<std::vector<std::uint8_t>>(grays), 16, 12), gray_out);
+    encoder.encode(PixelData(colors, 16, 12), out);
+    REQUIRE(gray_out == out);
+  }
+
+  SECTION("Encoders can be reused") {
+    const PixelData frame(std::vector<RGB24>(5 * 9, RGB24(10, 200, 90)), 5, 9);
+    std::string first;
+    encoder.encode(frame, first);
+    encoder.encode(frame, out);
+    REQUIRE(first == out);
+  }
+}
@@ -0,0 +1,36 @@
+#include <tmedia/term/termcaps.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("termcaps", "[termcaps]") {
+  SECTION("No replies") {
+    const TermGraphicsCaps caps = term_parse_graphics_reply("");
+    REQUIRE(caps.protocol == TermGraphics::NONE);
+    REQUIRE(caps.cell_pixels.width == 0);
+    REQUIRE(caps.cell_pixels.height == 0);
+  }
+
+  SECTION("Kitty graphics are preferred") {
+    const TermGraphicsCaps caps = term_parse_graphics_reply("\x1b_Gi=31;OK\x1b\\" "\x1b[6;20;10t" "\x1b[?62;4;22c");
+    REQUIRE(caps.protocol == TermGraphics::KITTY);
+    REQUIRE(caps.cell_pixels.width == 10);
+    REQUIRE(caps.cell_pixels.height == 20);
+  }
+
+  SECTION("Failed kitty queries are ignored") {
+    const TermGraphicsCaps caps = term_parse_graphics_reply("\x1b_Gi=31;ENOTSUPPORTED:\x1b\\" "\x1b[?62;22c");
+    REQUIRE(caps.protocol == TermGraphics::NONE);
+  }
+
+  SECTION("Sixel from the device attributes") {
+    REQUIRE(term_parse_graphics_reply("\x1b[?4c").protocol == TermGraphics::SIXEL);
+    REQUIRE(term_parse_graphics_reply("\x1b[?64;1;2;4;6;9;15;18;21;22c").protocol == TermGraphics::SIXEL);
+    REQUIRE(term_parse_graphics_reply("\x1b[?64;14;44c").protocol == TermGraphics::NONE);
+    REQUIRE(term_parse_graphics_reply("\x1b[?64;4").protocol == TermGraphics::NONE); // incomplete
+  }
+
+  SECTION("Malformed cell sizes are ignored") {
+    REQUIRE(term_parse_graphics_reply("\x1b[6;20t").cell_pixels.width == 0);
+    REQUIRE(term_parse_graphics_reply("\x1b[6;;10t").cell_pixels.width == 0);
+  }
+}
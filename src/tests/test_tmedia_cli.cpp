@@ -0,0 +1,59 @@
+#include <tmedia/tmedia.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+  TMediaCLIParseRes parse_cli(std::vector<std::string> cli_args) {
+    std::vector<char*> argv;
+    for (std::string& cli_arg : cli_args) argv.push_back(cli_arg.data());
+    argv.push_back(nullptr);
+    return tmedia_parse_cli(static_cast<int>(cli_args.size()), argv.data());
+  }
+}
+
+TEST_CASE("tmedia_cli", "[tmedia_cli]") {
+  // an empty file is enough for a media path while files are not probed
+  const fs::path media_path = fs::temp_directory_path() / "tmedia_test_cli.mp4";
+  std::ofstream(media_path).close();
+  const std::string media = media_path.string();
+
+  SECTION("--headless-size") {
+    SECTION("Defaults to 80x24") {
+      TMediaCLIParseRes res = parse_cli({"tmedia", "--no-probe", media});
+      REQUIRE(res.tmss.headless_dims.width == 80);
+      REQUIRE(res.tmss.headless_dims.height == 24);
+    }
+
+    SECTION("Parses COLSxLINES") {
+      TMediaCLIParseRes res = parse_cli({"tmedia", "--no-probe", "--headless-size", "120x40", media});
+      REQUIRE(res.tmss.headless_dims.width == 120);
+      REQUIRE(res.tmss.headless_dims.height == 40);
+    }
+
+    SECTION("Rejects a missing separator") {
+      REQUIRE_THROWS_AS(parse_cli({"tmedia", "--no-probe", "--headless-size", "120", media}), std::runtime_error);
+      REQUIRE_THROWS_AS(parse_cli({"tmedia", "--no-probe", "--headless-size", "120:40", media}), std::runtime_error);
+    }
+
+    SECTION("Rejects non-positive sizes") {
+      REQUIRE_THROWS_AS(parse_cli({"tmedia", "--no-probe", "--headless-size", "0x40", media}), std::runtime_error);
+      REQUIRE_THROWS_AS(parse_cli({"tmedia", "--no-probe", "--headless-size", "120x0", media}), std::runtime_error);
+    }
+
+    SECTION("Rejects non-integers") {
+      REQUIRE_THROWS_AS(parse_cli({"tmedia", "--no-probe", "--headless-size", "axb", media}), std::runtime_error);
+      REQUIRE_THROWS_AS(parse_cli({"tmedia", "--no-probe", "--headless-size", "120x", media}), std::runtime_error);
+      REQUIRE_THROWS_AS(parse_cli({"tmedia", "--no-probe", "--headless-size", "12.5x40", media}), std::runtime_error);
+    }
+  }
+
+  fs::remove(media_path);
+}
@@ -0,0 +1,65 @@
+#include <tmedia/media/triplebuffer.h>
+
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("triplebuffer", "[triplebuffer]") {
+  TripleBuffer<int> buffer;
+  REQUIRE_FALSE(buffer.consume());
+
+  SECTION("Latest published value is consumed") {
+    buffer.back() = 1;
+    buffer.publish();
+    buffer.back() = 2;
+    buffer.publish();
+    REQUIRE(buffer.consume());
+    REQUIRE(buffer.front() == 2);
+    REQUIRE_FALSE(buffer.consume());
+    REQUIRE(buffer.front() == 2);
+  }
+
+  SECTION("Front is kept while publishing") {
+    buffer.back() = 1;
+    buffer.publish();
+    REQUIRE(buffer.consume());
+    for (int i = 2; i < 10; i++) {
+      buffer.back() = i;
+      buffer.publish();
+      REQUIRE(buffer.front() == 1);
+    }
+    REQUIRE(buffer.consume());
+    REQUIRE(buffer.front() == 9);
+  }
+}
+
+TEST_CASE("triplebuffer across threads", "[triplebuffer]") {
+  static constexpr int NB_VALUES = 100000;
+  struct Pair { int a = 0; int b = 0; };
+  TripleBuffer<Pair> buffer;
+
+  std::thread producer([&buffer] {
+    for (int i = 1; i <= NB_VALUES; i++) {
+      buffer.back().a = i;
+      buffer.back().b = -i;
+      buffer.publish();
+    }
+  });
+
+  int last = 0;
+  bool consistent = true;
+  bool increasing = true;
+  while (last < NB_VALUES) {
+    if (!buffer.consume()) {
+      std::this_thread::yield();
+      continue;
+    }
+    consistent = consistent && buffer.front().a == -buffer.front().b;
+    increasing = increasing && buffer.front().a > last;
+    last = buffer.front().a;
+  }
+
+  producer.join();
+  REQUIRE(consistent);
+  REQUIRE(increasing);
+}
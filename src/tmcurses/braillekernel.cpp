@@ -0,0 +1,55 @@
+#include <tmedia/tmcurses/braillekernel.h>
+
+#include <cstdint>
+
+/**
+ * The bit of each dot of a braille pattern, by row and then column within the
+ * cell. Dots 1-6 run down the columns, while dots 7 and 8 were added later as
+ * the bottom row.
+*/
+static constexpr std::uint8_t BRAILLE_DOT_BITS[BRAILLE_CELL_HEIGHT][BRAILLE_CELL_WIDTH] = {
+  { 0x01, 0x08 },
+  { 0x02, 0x10 },
+  { 0x04, 0x20 },
+  { 0x40, 0x80 }
+};
+
+static constexpr int BAYER_4X4[4][4] = {
+  {  0,  8,  2, 10 },
+  { 12,  4, 14,  6 },
+  {  3, 11,  1,  9 },
+  { 15,  7, 13,  5 }
+};
+
+BrailleKernel::BrailleKernel() {
+  for (int row = 0; row < BRAILLE_CELL_HEIGHT; row++) {
+    for (int col = 0; col < 4; col++) {
+      const int threshold = BAYER_4X4[row][col] * 16 + 8;
+      const std::uint8_t bit = BRAILLE_DOT_BITS[row][col % BRAILLE_CELL_WIDTH];
+      for (int v = 0; v < 256; v++) {
+        this->m_dots[row][col][v] = v > threshold ? bit : 0;
+      }
+    }
+  }
+}
+
+void BrailleKernel::map_row(const std::uint8_t* grays, int width, int rows, std::uint32_t* cells) const noexcept {
+  const int cells_width = (width + 1) / 2;
+  for (int cell = 0; cell < cells_width; cell++) {
+    cells[cell] = 0;
+  }
+
+  // cells begin on even columns, so every other cell uses the right half of
+  // the dither matrix
+  for (int row = 0; row < rows && row < BRAILLE_CELL_HEIGHT; row++) {
+    const std::uint8_t* pixels = grays + row * width;
+    const std::array<std::array<std::uint8_t, 256>, 4>& dots = this->m_dots[row];
+    for (int col = 0; col < width; col++) {
+      cells[col / 2] |= dots[col % 4][pixels[col]];
+    }
+  }
+
+  for (int cell = 0; cell < cells_width; cell++) {
+    cells[cell] += BRAILLE_BLANK;
+  }
+}
@@ -0,0 +1,61 @@
+#include <tmedia/tmcurses/cellkernel.h>
+
+#include <tmedia/tmcurses/tmcurses.h>
+#include <tmedia/image/ascii.h>
+#include <tmedia/image/color.h>
+
+#include <string_view>
+#include <cstdint>
+
+extern "C" {
+  #include <curses.h>
+}
+
+// 0.299, 0.587, and 0.114 in 16-bit fixed point, summing to exactly 1 << 16
+static constexpr std::uint32_t GRAY_WEIGHT_R = 19595;
+static constexpr std::uint32_t GRAY_WEIGHT_G = 38470;
+static constexpr std::uint32_t GRAY_WEIGHT_B = 7471;
+static constexpr int GRAY_SHIFT = 16;
+
+CellKernel::CellKernel(std::string_view ascii_char_map, bool glyphs, bool colors) {
+  static constexpr int SIDE = TMCURSES_COLOR_MAP_SIDE;
+
+  for (int v = 0; v < 256; v++) {
+    const std::uint8_t value = static_cast<std::uint8_t>(v);
+    const int step = v * (SIDE - 1) / 255;
+    this->m_gray_r[v] = GRAY_WEIGHT_R * v;
+    this->m_gray_g[v] = GRAY_WEIGHT_G * v;
+    this->m_gray_b[v] = GRAY_WEIGHT_B * v;
+    this->m_step_r[v] = static_cast<std::uint16_t>(step * SIDE * SIDE);
+    this->m_step_g[v] = static_cast<std::uint16_t>(step * SIDE);
+    this->m_step_b[v] = static_cast<std::uint16_t>(step);
+    this->m_glyphs[v] = glyphs ? static_cast<chtype>(static_cast<unsigned char>(get_char_from_value(ascii_char_map, value))) : ' ';
+    this->m_gray_attrs[v] = colors ? COLOR_PAIR(get_closest_tmcurses_color_pair(RGB24(value))) : 0;
+  }
+
+  for (int r = 0; r < SIDE; r++) {
+    for (int g = 0; g < SIDE; g++) {
+      for (int b = 0; b < SIDE; b++) {
+        this->m_cube_attrs[r * SIDE * SIDE + g * SIDE + b] = colors ?
+          COLOR_PAIR(get_tmcurses_color_pair_at_step(r, g, b)) : 0;
+      }
+    }
+  }
+}
+
+void CellKernel::map_row(const RGB24* pixels, int width, chtype* cells) const noexcept {
+  for (int i = 0; i < width; i++) {
+    const RGB24 pixel = pixels[i];
+    const std::uint32_t gray = (this->m_gray_r[pixel.r] + this->m_gray_g[pixel.g]
+      + this->m_gray_b[pixel.b]) >> GRAY_SHIFT;
+    const int cube_index = this->m_step_r[pixel.r] + this->m_step_g[pixel.g]
+      + this->m_step_b[pixel.b];
+    cells[i] = this->m_glyphs[gray] | this->m_cube_attrs[cube_index];
+  }
+}
+
+void CellKernel::map_row(const std::uint8_t* grays, int width, chtype* cells) const noexcept {
+  for (int i = 0; i < width; i++) {
+    cells[i] = this->m_glyphs[grays[i]] | this->m_gray_attrs[grays[i]];
+  }
+}
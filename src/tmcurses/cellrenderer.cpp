@@ -0,0 +1,110 @@
+#include <tmedia/tmcurses/cellrenderer.h>
+
+#include <tmedia/image/ascii.h>
+#include <tmedia/image/color.h>
+
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+  #include <curses.h>
+}
+
+CellRenderer::CellRenderer(std::string_view ascii_char_map, bool glyphs, bool colors) {
+  this->m_output = Output::CURSES_CELLS;
+  this->m_kernel.emplace(ascii_char_map, glyphs, colors);
+  this->m_glyphs.fill(' ');
+  this->m_color_bits = 8;
+}
+
+CellRenderer::CellRenderer(Output output, std::string_view ascii_char_map, int color_bits) {
+  assert(output != Output::CURSES_CELLS);
+  this->m_output = output;
+  for (int v = 0; v < 256; v++) {
+    this->m_glyphs[v] = static_cast<unsigned char>(get_char_from_value(ascii_char_map, static_cast<std::uint8_t>(v)));
+  }
+  this->m_color_bits = color_bits;
+}
+
+void CellRenderer::map_row(const PixelData& pixel_data, int row, int col, int width, chtype* cells) const noexcept {
+  const std::size_t offset = static_cast<std::size_t>(row) * pixel_data.get_width() + col;
+  if (pixel_data.is_gray()) {
+    this->m_kernel->map_row(pixel_data.gray_data().data() + offset, width, cells);
+  } else {
+    this->m_kernel->map_row(pixel_data.data().data() + offset, width, cells);
+  }
+}
+
+void CellRenderer::map_row(const PixelData& pixel_data, int row, int col, int width, AnsiCell* cells) const noexcept {
+  const std::size_t offset = static_cast<std::size_t>(row) * pixel_data.get_width() + col;
+  const bool background = this->m_output == Output::ANSI_BG;
+  for (int i = 0; i < width; i++) {
+    std::uint32_t color;
+    std::uint8_t gray;
+    if (pixel_data.is_gray()) {
+      gray = pixel_data.gray_data()[offset + i];
+      color = (gray << 16) | (gray << 8) | gray;
+    } else {
+      const RGB24& pixel = pixel_data.data()[offset + i];
+      gray = pixel.gray_val();
+      color = (pixel.r << 16) | (pixel.g << 8) | pixel.b;
+    }
+
+    color = ansi_reduce_color(color, this->m_color_bits);
+    cells[i] = background ? AnsiCell{' ', ANSI_DEFAULT_COLOR, color}
+      : AnsiCell{this->m_glyphs[gray], color, ANSI_DEFAULT_COLOR};
+  }
+}
+
+CellFramePool::CellFramePool(std::size_t capacity) {
+  this->m_capacity = capacity;
+  this->m_frames.reserve(capacity);
+}
+
+std::shared_ptr<CellFrame> CellFramePool::acquire() {
+  for (std::shared_ptr<CellFrame>& frame : this->m_frames) {
+    if (frame.use_count() == 1) { // only referenced by the pool
+      // pairs with the release of the last reference on the thread presenting
+      // frames, as use_count is a relaxed load
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return frame;
+    }
+  }
+
+  std::shared_ptr<CellFrame> frame = std::make_shared<CellFrame>();
+  if (this->m_frames.size() < this->m_capacity) this->m_frames.push_back(frame);
+  return frame;
+}
+
+std::size_t CellFramePool::size() const noexcept {
+  return this->m_frames.size();
+}
+
+std::shared_ptr<const CellFrame> render_cell_frame(CellFramePool& pool, const std::shared_ptr<const CellRenderer>& renderer, const PixelData& pixel_data) {
+  std::shared_ptr<CellFrame> frame = pool.acquire();
+  frame->renderer = renderer;
+  frame->width = pixel_data.get_width();
+  frame->height = pixel_data.get_height();
+  const std::size_t nb_cells = static_cast<std::size_t>(frame->width) * frame->height;
+
+  // clearing keeps the capacity of the unused output for later frames
+  if (renderer->get_output() == CellRenderer::Output::CURSES_CELLS) {
+    frame->ansi_cells.clear();
+    frame->curses_cells.resize(nb_cells);
+    for (int row = 0; row < frame->height; row++) {
+      renderer->map_row(pixel_data, row, 0, frame->width, frame->curses_cells.data() + static_cast<std::size_t>(row) * frame->width);
+    }
+  } else {
+    frame->curses_cells.clear();
+    frame->ansi_cells.resize(nb_cells);
+    for (int row = 0; row < frame->height; row++) {
+      renderer->map_row(pixel_data, row, 0, frame->width, frame->ansi_cells.data() + static_cast<std::size_t>(row) * frame->width);
+    }
+  }
+
+  return frame;
+}
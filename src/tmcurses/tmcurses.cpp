@@ -1,5 +1,6 @@
 #include <tmedia/tmcurses/tmcurses.h>
 
+#include <tmedia/tmcurses/halfblockpairs.h>
 #include <tmedia/image/color.h>
 #include <tmedia/util/wmath.h>
 #include <tmedia/image/palette.h>
@@ -21,7 +22,7 @@ extern "C" {
 #include <curses.h>
 }
 
-static constexpr int COLOR_MAP_SIDE = 7;
+static constexpr int COLOR_MAP_SIDE = TMCURSES_COLOR_MAP_SIDE;
 static constexpr int MAX_TERMINAL_COLORS = 256;
 static constexpr int MAX_TERMINAL_COLOR_PAIRS = 256;
 
@@ -66,6 +67,17 @@ curses_color_t color_map[COLOR_MAP_SIDE][COLOR_MAP_SIDE][COLOR_MAP_SIDE];
 
 int available_color_palette_colors = 0;
 int available_color_palette_color_pairs = 0;
+unsigned int color_maps_generation = 0;
+
+/**
+ * Half-block color pairs are allocated from halfblock_pair_start, right after
+ * the color palette's pairs, as laid out in tmedia/tmcurses/halfblockpairs.h.
+ * halfblock_side is the side of their color cube, or 0 if they do not fit
+ * into COLOR_PAIRS.
+*/
+static constexpr int MAX_CURSES_COLOR_PAIRS = 32767; // init_pair takes a short
+int halfblock_side = 0;
+int halfblock_pair_start = 0;
 
 // --------------------------------------------------------------
 // --------------------------------------------------------------
@@ -98,12 +110,15 @@ void tmcurses_init_color() {
   tmcurses_init_color_pairs();
   tmcurses_init_color_maps();
   curses_colors_initialized = true;
+  tmcurses_init_halfblock_pairs();
 }
 
 void tmcurses_uninit_color() {
   available_color_palette_colors = 0;
   available_color_palette_color_pairs = 0;
+  halfblock_side = 0;
   curses_colors_initialized = false;
+  color_maps_generation++;
 }
 
 void tmcurses_set_color_palette(TMNCursesColorPalette colorPalette) {
@@ -117,6 +132,7 @@ void tmcurses_set_color_palette(TMNCursesColorPalette colorPalette) {
 
   tmcurses_init_color_pairs();
   tmcurses_init_color_maps();
+  tmcurses_init_halfblock_pairs();
 }
 
 void tmcurses_set_color_palette_custom(const Palette& colorPalette) {
@@ -136,7 +152,7 @@ void tmcurses_set_color_palette_custom(const Palette& colorPalette) {
 
   tmcurses_init_color_pairs();
   tmcurses_init_color_maps();
-
+  tmcurses_init_halfblock_pairs();
 }
 
 
@@ -157,6 +173,30 @@ curses_color_pair_t get_closest_tmcurses_color_pair(const RGB24& input) {
                       [static_cast<int>(input.b) * (COLOR_MAP_SIDE - 1) / 255];
 }
 
+curses_color_pair_t get_tmcurses_color_pair_at_step(int r_step, int g_step, int b_step) {
+  if (!curses_colors_initialized) return 0; // just return a default 0 to no-op
+  return color_pairs_map[r_step][g_step][b_step];
+}
+
+bool tmcurses_has_halfblock_pairs() {
+  return curses_colors_initialized && halfblock_side > 0;
+}
+
+curses_color_pair_t get_tmcurses_halfblock_pair(const RGB24& top, const RGB24& bottom) {
+  if (!tmcurses_has_halfblock_pairs()) return 0; // just return a default 0 to no-op
+  return halfblock_pair_start + halfblock_pair_offset(halfblock_cube_index(top, halfblock_side),
+    halfblock_cube_index(bottom, halfblock_side), halfblock_side);
+}
+
+curses_color_pair_t get_tmcurses_halfblock_top_pair(const RGB24& top) {
+  if (!tmcurses_has_halfblock_pairs()) return 0; // just return a default 0 to no-op
+  return halfblock_pair_start + halfblock_default_bg_pair_offset(halfblock_cube_index(top, halfblock_side), halfblock_side);
+}
+
+unsigned int tmcurses_color_maps_generation() {
+  return color_maps_generation;
+}
+
 // --------------------------------------------------------------
 // --------------------------------------------------------------
 // --------------------------------------------------------------
@@ -237,6 +277,7 @@ void tmcurses_init_color_pairs() {
 }
 
 void tmcurses_init_color_maps() {
+  color_maps_generation++;
   for (int r = 0; r < COLOR_MAP_SIDE; r++) {
     for (int g = 0; g < COLOR_MAP_SIDE; g++) {
       for (int b = 0; b < COLOR_MAP_SIDE; b++) {
@@ -248,6 +289,30 @@ void tmcurses_init_color_maps() {
   }
 }
 
+void tmcurses_init_halfblock_pairs() {
+  halfblock_pair_start = available_color_palette_color_pairs;
+  halfblock_side = halfblock_side_for(std::min(COLOR_PAIRS, MAX_CURSES_COLOR_PAIRS) - halfblock_pair_start);
+  if (halfblock_side == 0) return;
+
+  const int cube_size = halfblock_cube_size(halfblock_side);
+  std::vector<curses_color_t> cube_colors(cube_size);
+  for (int r = 0; r < halfblock_side; r++) {
+    for (int g = 0; g < halfblock_side; g++) {
+      for (int b = 0; b < halfblock_side; b++) {
+        const RGB24 color(r * 255 / (halfblock_side - 1), g * 255 / (halfblock_side - 1), b * 255 / (halfblock_side - 1));
+        cube_colors[(r * halfblock_side + g) * halfblock_side + b] = get_closest_tmcurses_color(color);
+      }
+    }
+  }
+
+  for (int top = 0; top < cube_size; top++) {
+    for (int bottom = 0; bottom < cube_size; bottom++) {
+      init_pair(halfblock_pair_start + halfblock_pair_offset(top, bottom, halfblock_side), cube_colors[top], cube_colors[bottom]);
+    }
+    init_pair(halfblock_pair_start + halfblock_default_bg_pair_offset(top, halfblock_side), cube_colors[top], -1);
+  }
+}
+
 curses_color_t tmcurses_find_best_initialized_color_number(RGB24& input) {
   curses_color_t best_color_index = -1;
   double best_distance = (double)INT32_MAX;
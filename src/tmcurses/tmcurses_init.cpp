@@ -4,12 +4,29 @@
 #include <tmedia/tmcurses/internal/tmcurses_internal.h>
 #undef TMEDIA_TMCURSES_INTERNAL_IMPLEMENTATION
 
+#include <tmedia/util/defines.h>
+
+#include <cstdio>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include <unistd.h>
+
+extern "C" {
+#include <curses.h>
+}
+
+static constexpr const char* HEADLESS_TERM_TYPE = "xterm-256color";
+
 bool tmcurses_initialized = false;
 
-void tmcurses_init() {
-  if (tmcurses_initialized) return;
-  tmcurses_initialized = true;
-  initscr();
+// the virtual screen and its discarding streams, while initialized headless
+SCREEN* headless_screen = nullptr;
+FILE* headless_out = nullptr;
+FILE* headless_in = nullptr;
+
+static void tmcurses_init_screen() {
   savetty();
   tmcurses_init_color();
 
@@ -27,6 +44,38 @@ void tmcurses_init() {
   curs_set(0);
 }
 
+void tmcurses_init() {
+  if (tmcurses_initialized) return;
+  tmcurses_initialized = true;
+  initscr();
+  tmcurses_init_screen();
+}
+
+void tmcurses_init_headless(int cols, int lines) {
+  if (tmcurses_initialized) return;
+  headless_out = fopen("/dev/null", "w");
+  headless_in = fopen("/dev/null", "r");
+  if (headless_out != nullptr && headless_in != nullptr)
+    headless_screen = newterm(HEADLESS_TERM_TYPE, headless_out, headless_in);
+
+  if (headless_screen == nullptr) {
+    if (headless_out != nullptr) fclose(headless_out);
+    if (headless_in != nullptr) fclose(headless_in);
+    headless_out = nullptr;
+    headless_in = nullptr;
+    throw std::runtime_error(fmt::format("[{}] Could not create a headless "
+    "{} screen", FUNCDINFO, HEADLESS_TERM_TYPE));
+  }
+
+  tmcurses_initialized = true;
+  resize_term(lines, cols);
+  tmcurses_init_screen();
+}
+
+int tmcurses_output_fd() {
+  return headless_out != nullptr ? fileno(headless_out) : STDOUT_FILENO;
+}
+
 bool tmcurses_is_initialized() {
   return tmcurses_initialized;
 }
@@ -42,4 +91,13 @@ void tmcurses_uninit() {
   echo();
   resetty();
   endwin();
+
+  if (headless_screen != nullptr) {
+    delscreen(headless_screen);
+    fclose(headless_out);
+    fclose(headless_in);
+    headless_screen = nullptr;
+    headless_out = nullptr;
+    headless_in = nullptr;
+  }
 }
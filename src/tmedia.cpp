@@ -9,9 +9,10 @@
 #include <tmedia/util/wmath.h>
 #include <tmedia/util/wtime.h>
 #include <tmedia/util/defines.h>
-#include <tmedia/util/sleep.h>
+#include <tmedia/util/framepacer.h>
 #include <tmedia/util/formatting.h>
 #include <tmedia/tmedia_tui_elems.h>
+#include <tmedia/term/termcaps.h>
 #include <tmedia/audio/maaudioout.h>
 #include <tmedia/image/palette.h>
 #include <tmedia/util/defines.h>
@@ -21,6 +22,7 @@
 
 #include <memory>
 #include <vector>
+#include <array>
 #include <string>
 #include <iostream>
 #include <cstddef>
@@ -32,6 +34,10 @@
 #include <algorithm>
 #include <mutex>
 #include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include <unistd.h>
 
 
 extern "C" {
@@ -43,9 +49,24 @@ static constexpr int KEY_ESCAPE = 27;
 static constexpr double VOLUME_CHANGE_AMOUNT = 0.01;
 static constexpr int MIN_RENDER_COLS = 2;
 static constexpr int MIN_RENDER_LINES = 2; 
+static constexpr int TERM_GRAPHICS_PROBE_TIMEOUT_MS = 250;
+static constexpr double SCRUB_SETTLE_SECS = 0.35; // input-free time before a scrub is made accurate
+static constexpr double OUTPUT_BUDGET_FRACTION = 0.5; // of each refresh interval, for writing to the terminal
+
+/**
+ * Returns the cells to request frames for when rendering frames into a box of
+ * the given cells, scaled down by the given scale of the OutputScaler. Frames
+ * are never produced for less than MIN_RENDER_COLS x MIN_RENDER_LINES cells,
+ * and are cropped by the renderer when the box is even smaller.
+*/
+static Dim2 req_frame_cells(Dim2 box, double scale) {
+  return Dim2(std::max(static_cast<int>(box.width * scale), MIN_RENDER_COLS),
+  std::max(static_cast<int>(box.height * scale), MIN_RENDER_LINES));
+}
 
 
 void set_global_vom(VidOutMode* current, VidOutMode next);
+bool vom_is_grayscale(VidOutMode mode);
 void init_global_video_output_mode(VidOutMode mode);
 
 
@@ -57,26 +78,60 @@ TMediaProgramState tmss_to_tmps(TMediaStartupState& tmss) {
   tmps.plist = Playlist(tmss.media_files, tmss.loop_type);
   if (tmss.shuffled) tmps.plist.shuffle(false);
   tmps.refresh_rate_fps = tmss.refresh_rate_fps;
-  tmps.scaling_algorithm = tmss.scaling_algorithm;
+  tmps.decode_threads = tmss.decode_threads;
+  tmps.lowres_decoding = tmss.lowres_decoding;
+  tmps.dump_decoders = tmss.dump_decoders;
   tmps.volume = tmss.volume;
   tmps.vom = tmss.vom;
+  tmps.headless = tmss.headless;
   tmps.quit = false;
   return tmps;
 }
 
-int tmedia_main_loop(TMediaProgramState tmps);
+int tmedia_main_loop(TMediaProgramState& tmps);
+std::string dump_media_decoder(MediaDecoder& mdec);
 
 int tmedia_run(TMediaStartupState& tmss) {
-  tmcurses_init();
+  if (tmss.headless == HeadlessMode::OFF) {
+    term_probe_graphics(TERM_GRAPHICS_PROBE_TIMEOUT_MS);
+    tmcurses_init();
+  } else {
+    tmcurses_init_headless(tmss.headless_dims.width, tmss.headless_dims.height);
+  }
   erase();
   TMediaProgramState tmps = tmss_to_tmps(tmss);
   init_global_video_output_mode(tmss.vom);
   int res = tmedia_main_loop(tmps);
   tmcurses_uninit();
+
+  for (const std::string& dump : tmps.decoder_dump)
+    std::cerr << dump;
   return res;
 }
 
-int tmedia_main_loop(TMediaProgramState tmps) {
+std::string dump_media_decoder(MediaDecoder& mdec) {
+  static constexpr std::array<enum AVMediaType, 2> dumped_streams = { AVMEDIA_TYPE_VIDEO, AVMEDIA_TYPE_AUDIO };
+  std::string dump = fmt::format("{}:\n", mdec.path.string());
+
+  for (enum AVMediaType media_type : dumped_streams) {
+    if (!mdec.has_stream_decoder(media_type)) continue;
+    StreamDecoder& sdec = mdec.get_stream_decoder(media_type);
+    dump += fmt::format("  {} stream #{}: {} (threads: {}, threading: {})\n",
+    av_get_media_type_string(media_type),
+    sdec.get_stream_index(),
+    sdec.get_codec_context()->codec->name,
+    sdec.get_thread_count(),
+    sdec.get_thread_type_str());
+    if (media_type == AVMEDIA_TYPE_VIDEO && sdec.get_lowres() > 0) {
+      dump += fmt::format("    decoding at 1/{} resolution ({}x{})\n",
+      1 << sdec.get_lowres(), mdec.get_width(), mdec.get_height());
+    }
+  }
+
+  return dump;
+}
+
+int tmedia_main_loop(TMediaProgramState& tmps) {
   TMediaRendererState tmrs;
   tmrs.req_frame_dim = Dim2(COLS, LINES);
 
@@ -88,7 +143,12 @@ int tmedia_main_loop(TMediaProgramState tmps) {
 
     try {
       const std::set<enum AVMediaType> streams = { AVMEDIA_TYPE_VIDEO, AVMEDIA_TYPE_AUDIO };
-      fetcher = std::make_unique<MediaFetcher>(tmps.plist.current(), streams);
+      const Dim2 cell_pixels = vom_cell_pixels(resolve_vom(tmps.vom, tmrs.video.truecolor_supported));
+      const std::optional<Dim2> lowres_target = tmps.lowres_decoding ?
+        std::optional<Dim2>(Dim2(std::max(COLS, MIN_RENDER_COLS) * cell_pixels.width,
+        std::max(LINES, MIN_RENDER_LINES) * cell_pixels.height))
+        : std::nullopt;
+      fetcher = std::make_unique<MediaFetcher>(tmps.plist.current(), streams, tmps.decode_threads, lowres_target);
     } catch (const std::runtime_error& err) {
       std::size_t failed_plist_index = tmps.plist.index();
 
@@ -103,16 +163,18 @@ int tmedia_main_loop(TMediaProgramState tmps) {
     }
 
 
-    fetcher->req_dims = Dim2(std::max(COLS, MIN_RENDER_COLS), std::max(LINES, MIN_RENDER_LINES));
+    if (tmps.dump_decoders) tmps.decoder_dump.push_back(dump_media_decoder(*fetcher->mdec));
+    fetcher->req_dims = req_frame_cells(Dim2(COLS, LINES), tmrs.output_scaler.get_scale());
+    fetcher->req_cell_pixels = vom_cell_pixels(resolve_vom(tmps.vom, tmrs.video.truecolor_supported));
     std::unique_ptr<MAAudioOut> audio_output;
     fetcher->begin(sys_clk_sec());
 
-    if (fetcher->has_media_stream(AVMEDIA_TYPE_AUDIO)) {
+    if (fetcher->has_media_stream(AVMEDIA_TYPE_AUDIO) && tmps.headless == HeadlessMode::OFF) {
       static constexpr int AUDIO_BUFFER_TRY_READ_MS = 5;
-      audio_output = std::make_unique<MAAudioOut>(fetcher->mdec->get_nb_channels(), fetcher->mdec->get_sample_rate(), [&fetcher] (float* float_buffer, int nb_frames) {
+      audio_output = std::make_unique<MAAudioOut>(fetcher->audio_buffer->get_nb_channels(), fetcher->audio_buffer->get_sample_rate(), [&fetcher] (float* float_buffer, int nb_frames) {
         bool success = fetcher->audio_buffer->try_read_into(nb_frames, float_buffer, AUDIO_BUFFER_TRY_READ_MS);
         if (!success)
-          for (int i = 0; i < nb_frames * fetcher->mdec->get_nb_channels(); i++)
+          for (int i = 0; i < nb_frames * fetcher->audio_buffer->get_nb_channels(); i++)
             float_buffer[i] = 0.0f;
       });
 
@@ -122,23 +184,67 @@ int tmedia_main_loop(TMediaProgramState tmps) {
     }
     
 
+    // While seeking keys are being pressed, playback only scrubs to the
+    // nearest keyframe. scrub_offset is how far the requested time is ahead of
+    // where the scrub actually landed, and is made up for with an accurate
+    // jump once seeking input settles.
+    double scrub_offset = NAN; // NAN while not scrubbing
+    double last_scrub_systime = 0.0;
+
+    // refreshes are paced to deadlines on the monotonic clock, but begin early
+    // whenever the video thread has a new frame ready
+    FramePacer pacer(static_cast<double>(tmps.refresh_rate_fps));
+    const double refresh_interval = 1.0 / static_cast<double>(tmps.refresh_rate_fps);
+
+    // what headless playback measures, reported once the media ends
+    const double start_systime = sys_clk_sec();
+    double render_secs = 0.0;
+    std::uint64_t refreshes = 0;
+    double end_medtime = 0.0;
+
     try {
       while (!fetcher->should_exit() && !INTERRUPT_RECEIVED) { // never break without using dispatch_exit on fetcher to false
+        if (tmps.headless != HeadlessMode::MAX_SPEED) pacer.begin_refresh(sys_clk_sec());
         PixelData frame;
+        std::shared_ptr<const CellFrame> frame_cells;
         double curr_systime, req_jumptime, curr_medtime;
         bool req_jump = false;
+        bool req_scrub = false;
 
+        const VidOutMode shown_vom = resolve_vom(tmps.vom, tmrs.video.truecolor_supported);
+        std::shared_ptr<const CellRenderer> cell_renderer = vom_cell_renderer(shown_vom, tmps.ascii_display_chars, tmrs.video.color_bits);
         {
           static constexpr double MAX_AUDIO_DESYNC_SECS = 0.6;  
           std::lock_guard<std::mutex> lock(fetcher->alter_mutex);
           curr_systime = sys_clk_sec(); // set in here, since locking the mutex could take an undetermined amount of time
+          if (tmps.headless == HeadlessMode::MAX_SPEED && fetcher->is_playing())
+            fetcher->skip_to_next_frame(curr_systime, refresh_interval);
           curr_medtime = fetcher->get_time(curr_systime);
           req_jumptime = curr_medtime;
+          fetcher->present_frame(curr_systime);
           frame = fetcher->frame;
-          fetcher->req_dims = tmrs.req_frame_dim;
-          req_jump = fetcher->get_desync_time(curr_systime) > MAX_AUDIO_DESYNC_SECS;
+          frame_cells = fetcher->frame_cells;
+          fetcher->cell_renderer = std::move(cell_renderer);
+          fetcher->req_dims = req_frame_cells(tmrs.req_frame_dim, tmrs.output_scaler.get_scale());
+          fetcher->req_cell_pixels = vom_cell_pixels(shown_vom);
+          if (tmps.headless == HeadlessMode::OFF) {
+            req_jump = fetcher->get_desync_time(curr_systime) > MAX_AUDIO_DESYNC_SECS;
+          } else if (fetcher->has_media_stream(AVMEDIA_TYPE_AUDIO)) {
+            // nothing plays the audio, so it is discarded in step with the clock
+            if (!fetcher->audio_buffer->try_set_time_in_bounds(curr_medtime, 0))
+              fetcher->audio_buffer->clear(curr_medtime);
+          }
+        }
+
+        // video can be converted to gray only when brightness is all that's shown
+        if (vom_is_grayscale(shown_vom)) {
+          fetcher->flags |= MediaFetcher::GRAYSCALE_VIDEO;
+        } else {
+          fetcher->flags &= ~MediaFetcher::GRAYSCALE_VIDEO;
         }
 
+        if (std::isfinite(scrub_offset)) req_jumptime += scrub_offset;
+
         int input = ERR;
         while ((input = getch()) != ERR) { // Go through and process all the batched input
           switch (input) {
@@ -153,10 +259,12 @@ int tmedia_main_loop(TMediaProgramState tmps) {
             } break;
             case KEY_RESIZE: {
               erase();
+              tmrs.video.invalidate();
             } break;
             case 'r':
             case 'R': {
               erase();
+              tmrs.video.invalidate();
               if (audio_output && audio_output->playing()) {
                 audio_output->stop();
                 audio_output->start();
@@ -170,6 +278,11 @@ int tmedia_main_loop(TMediaProgramState tmps) {
                 case VidOutMode::COLOR_BG: set_global_vom(&tmps.vom, VidOutMode::PLAIN); break;
                 case VidOutMode::GRAY_BG: set_global_vom(&tmps.vom, VidOutMode::COLOR_BG); break;
                 case VidOutMode::PLAIN: set_global_vom(&tmps.vom, VidOutMode::COLOR); break;
+                case VidOutMode::TRUECOLOR: set_global_vom(&tmps.vom, VidOutMode::PLAIN); break;
+                case VidOutMode::TRUECOLOR_BG: set_global_vom(&tmps.vom, VidOutMode::PLAIN); break;
+                case VidOutMode::HALFBLOCK: set_global_vom(&tmps.vom, VidOutMode::PLAIN); break;
+                case VidOutMode::BRAILLE: set_global_vom(&tmps.vom, VidOutMode::COLOR); break;
+                case VidOutMode::GRAPHICS: set_global_vom(&tmps.vom, VidOutMode::PLAIN); break;
               }
             } break;
             case 'g':
@@ -180,17 +293,70 @@ int tmedia_main_loop(TMediaProgramState tmps) {
                 case VidOutMode::COLOR_BG: set_global_vom(&tmps.vom, VidOutMode::GRAY_BG); break;
                 case VidOutMode::GRAY_BG: set_global_vom(&tmps.vom, VidOutMode::PLAIN); break;
                 case VidOutMode::PLAIN: set_global_vom(&tmps.vom, VidOutMode::GRAY); break;
+                case VidOutMode::TRUECOLOR: set_global_vom(&tmps.vom, VidOutMode::GRAY); break;
+                case VidOutMode::TRUECOLOR_BG: set_global_vom(&tmps.vom, VidOutMode::GRAY_BG); break;
+                case VidOutMode::HALFBLOCK: set_global_vom(&tmps.vom, VidOutMode::GRAY); break;
+                case VidOutMode::BRAILLE: set_global_vom(&tmps.vom, VidOutMode::GRAY); break;
+                case VidOutMode::GRAPHICS: set_global_vom(&tmps.vom, VidOutMode::GRAY); break;
+              }
+            } break;
+            case 't':
+            case 'T': {
+              switch (tmps.vom) {
+                case VidOutMode::COLOR: set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR); break;
+                case VidOutMode::GRAY: set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR); break;
+                case VidOutMode::COLOR_BG: set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR_BG); break;
+                case VidOutMode::GRAY_BG: set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR_BG); break;
+                case VidOutMode::PLAIN: set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR); break;
+                case VidOutMode::TRUECOLOR: set_global_vom(&tmps.vom, VidOutMode::COLOR); break;
+                case VidOutMode::TRUECOLOR_BG: set_global_vom(&tmps.vom, VidOutMode::COLOR_BG); break;
+                case VidOutMode::HALFBLOCK: set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR); break;
+                case VidOutMode::BRAILLE: set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR); break;
+                case VidOutMode::GRAPHICS: set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR); break;
+              }
+            } break;
+            case 'h':
+            case 'H': {
+              if (tmps.vom == VidOutMode::HALFBLOCK) {
+                set_global_vom(&tmps.vom, VidOutMode::COLOR);
+              } else {
+                set_global_vom(&tmps.vom, VidOutMode::HALFBLOCK);
+              }
+            } break;
+            case 'd':
+            case 'D': {
+              if (tmps.vom == VidOutMode::BRAILLE) {
+                set_global_vom(&tmps.vom, VidOutMode::PLAIN);
+              } else {
+                set_global_vom(&tmps.vom, VidOutMode::BRAILLE);
+              }
+            } break;
+            case 'i':
+            case 'I': {
+              if (tmps.vom == VidOutMode::GRAPHICS) {
+                set_global_vom(&tmps.vom, VidOutMode::COLOR);
+              } else {
+                set_global_vom(&tmps.vom, VidOutMode::GRAPHICS);
               }
             } break;
             case 'b':
             case 'B': {
-              if (tmcurses_has_colors() && tmcurses_can_change_colors()) {
+              if (tmps.vom == VidOutMode::TRUECOLOR) {
+                set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR_BG);
+              } else if (tmps.vom == VidOutMode::TRUECOLOR_BG) {
+                set_global_vom(&tmps.vom, VidOutMode::TRUECOLOR);
+              } else if (tmcurses_has_colors() && tmcurses_can_change_colors()) {
                 switch (tmps.vom) {
                   case VidOutMode::COLOR: set_global_vom(&tmps.vom, VidOutMode::COLOR_BG); break;
                   case VidOutMode::GRAY: set_global_vom(&tmps.vom, VidOutMode::GRAY_BG); break;
                   case VidOutMode::COLOR_BG: set_global_vom(&tmps.vom, VidOutMode::COLOR); break;
                   case VidOutMode::GRAY_BG: set_global_vom(&tmps.vom, VidOutMode::GRAY); break;
                   case VidOutMode::PLAIN: break; //no-op
+                  case VidOutMode::TRUECOLOR: break; // handled above
+                  case VidOutMode::TRUECOLOR_BG: break;
+                  case VidOutMode::HALFBLOCK: break; //no-op, there are no characters
+                  case VidOutMode::BRAILLE: break; //no-op, there are no colors
+                  case VidOutMode::GRAPHICS: break; //no-op, there are no characters
                 }
               }
             } break;
@@ -207,6 +373,7 @@ int tmedia_main_loop(TMediaProgramState tmps) {
             case 'f':
             case 'F': {
               erase();
+              tmrs.video.invalidate();
               tmps.fullscreen = !tmps.fullscreen;
             } break;
             case KEY_UP: {
@@ -260,13 +427,13 @@ int tmedia_main_loop(TMediaProgramState tmps) {
             } break;
             case KEY_LEFT: {
               if (fetcher->media_type == MediaType::VIDEO || fetcher->media_type == MediaType::AUDIO) {
-                req_jump = true;
+                req_scrub = true;
                 req_jumptime -= 5.0;
               }
             } break;
             case KEY_RIGHT: {
               if (fetcher->media_type == MediaType::VIDEO || fetcher->media_type == MediaType::AUDIO) {
-                req_jump = true;
+                req_scrub = true;
                 req_jumptime += 5.0;
               }
             } break;
@@ -281,18 +448,30 @@ int tmedia_main_loop(TMediaProgramState tmps) {
             case '8':
             case '9': {
               if (fetcher->media_type == MediaType::VIDEO || fetcher->media_type == MediaType::AUDIO) {
-                req_jump = true;
+                req_scrub = true;
                 req_jumptime = fetcher->get_duration() * (static_cast<double>(input - static_cast<int>('0')) / 10.0);
               }
             } break;
           }
         } // Ending of "while (input != ERR)"
 
-        if (req_jump) {
+        if (!req_scrub && std::isfinite(scrub_offset) && curr_systime - last_scrub_systime >= SCRUB_SETTLE_SECS) {
+          req_jump = true;
+        }
+
+        if (req_scrub || req_jump) {
           if (audio_output && fetcher->is_playing()) audio_output->stop();
           {
             std::scoped_lock<std::mutex> total_lock{fetcher->alter_mutex};
-            fetcher->jump_to_time(clamp(req_jumptime, 0.0, fetcher->get_duration()), sys_clk_sec());
+            const double target_time = clamp(req_jumptime, 0.0, fetcher->get_duration());
+            if (req_scrub) {
+              const double landed_time = fetcher->scrub_to_time(target_time, sys_clk_sec());
+              scrub_offset = landed_time != target_time ? target_time - landed_time : NAN;
+              last_scrub_systime = curr_systime;
+            } else {
+              fetcher->jump_to_time(target_time, sys_clk_sec());
+              scrub_offset = NAN;
+            }
           }
           if (audio_output && fetcher->is_playing()) audio_output->start();
         }
@@ -300,6 +479,7 @@ int tmedia_main_loop(TMediaProgramState tmps) {
         TMediaProgramSnapshot snapshot;
         snapshot.currently_playing = currently_playing;
         snapshot.frame = frame;
+        snapshot.frame_cells = frame_cells;
         snapshot.playing = fetcher->is_playing();
         snapshot.has_audio_output = audio_output ? true : false;
         snapshot.media_time_secs = curr_medtime;
@@ -307,14 +487,42 @@ int tmedia_main_loop(TMediaProgramState tmps) {
         snapshot.media_type = fetcher->media_type;
 
         Dim2 req_frame_dims_before = tmrs.req_frame_dim;
+        const double render_start_systime = sys_clk_sec();
         render_tui(tmps, snapshot, tmrs);
         if (req_frame_dims_before != tmrs.req_frame_dim) {
           std::lock_guard<std::mutex> alter_lock(fetcher->alter_mutex);
-          fetcher->req_dims = Dim2(tmrs.req_frame_dim);
+          fetcher->req_dims = req_frame_cells(tmrs.req_frame_dim, tmrs.output_scaler.get_scale());
         }
 
+        // bytes written by curses cannot be counted, but writing them
+        // blocks all the same once the terminal falls behind
+        const std::size_t ansi_bytes = tmrs.video.ansi_frame.get_nb_cells() > 0
+          || tmrs.video.ansi_frame.get_nb_images() > 0 ? tmrs.video.ansi_frame.size() : 0;
+        const double output_start_systime = sys_clk_sec();
         refresh();
-        sleep_for_sec(1.0 / static_cast<double>(tmps.refresh_rate_fps));
+        tmrs.video.ansi_frame.flush(tmcurses_output_fd());
+        const double output_end_systime = sys_clk_sec();
+        render_secs += output_end_systime - render_start_systime;
+        refreshes++;
+        end_medtime = curr_medtime;
+
+        // headless output never falls behind, and is kept at full scale to be comparable
+        if (snapshot.playing && tmps.headless == HeadlessMode::OFF) { // paused output says nothing about keeping up with playback
+          tmrs.output_scaler.update(output_end_systime - output_start_systime, ansi_bytes,
+          OUTPUT_BUDGET_FRACTION * refresh_interval);
+          tmrs.video.color_bits = tmrs.output_scaler.get_color_bits();
+        }
+
+        // images never end on their own, so headless playback moves on once one is shown
+        if (tmps.headless != HeadlessMode::OFF && snapshot.media_type == MediaType::IMAGE && frame.get_width() > 0) {
+          fetcher->dispatch_exit();
+        }
+
+        if (tmps.headless == HeadlessMode::MAX_SPEED) {
+          fetcher->wait_for_queued_frame(sys_clk_sec() + refresh_interval);
+        } else {
+          fetcher->wait_for_frame(pacer.end_refresh(sys_clk_sec()));
+        }
       }
     } catch (const std::exception& err) {
       std::lock_guard<std::mutex> lock(fetcher->alter_mutex);
@@ -324,7 +532,48 @@ int tmedia_main_loop(TMediaProgramState tmps) {
     fetcher->dispatch_exit();
     if (audio_output) audio_output->stop();
     fetcher->join(sys_clk_sec());
+    if (tmps.dump_decoders && fetcher->has_media_stream(AVMEDIA_TYPE_VIDEO)) {
+      tmps.decoder_dump.push_back(fmt::format("  video frames dropped late: {}, "
+      "skipped by decoder: {}\n", fetcher->get_dropped_frames(),
+      fetcher->get_skipped_frames()));
+      const std::uint64_t total_cells = tmrs.video.curses_cells.get_total_cells()
+        + tmrs.video.ansi_cells.get_total_cells();
+      const std::uint64_t changed_cells = tmrs.video.curses_cells.get_total_changed_cells()
+        + tmrs.video.ansi_cells.get_total_changed_cells();
+      const std::uint64_t frames = tmrs.video.curses_cells.get_frames()
+        + tmrs.video.ansi_cells.get_frames();
+      if (total_cells > 0) {
+        tmps.decoder_dump.push_back(fmt::format("  terminal cells changed: {} of "
+        "{} over {} frames\n", changed_cells, total_cells, frames));
+      }
+    }
+    if (tmps.dump_decoders && tmrs.output_scaler.get_refreshes() > 0) {
+      const OutputScaler& oscaler = tmrs.output_scaler;
+      tmps.decoder_dump.push_back(fmt::format("  output: {} ANSI bytes, blocked "
+      "{:.1f} ms per refresh, ended at {}% scale with {}-bit color\n",
+      oscaler.get_bytes(), oscaler.get_blocked_secs() * 1000.0 / static_cast<double>(oscaler.get_refreshes()),
+      static_cast<int>(oscaler.get_scale() * 100), oscaler.get_color_bits() * 3));
+    }
+    tmrs.output_scaler.reset_stats();
+    if (tmps.dump_decoders && pacer.get_refreshes() > 0) {
+      tmps.decoder_dump.push_back(fmt::format("  refreshes: {} at {} fps, "
+      "overran: {} (worst {:.1f} ms), slack: mean {:.1f} ms, min {:.1f} ms\n",
+      pacer.get_refreshes(), tmps.refresh_rate_fps, pacer.get_overruns(),
+      pacer.get_max_overrun() * 1000.0, pacer.get_mean_slack() * 1000.0,
+      pacer.get_min_slack() * 1000.0));
+    }
+    if (tmps.headless != HeadlessMode::OFF && refreshes > 0) {
+      const double wall_secs = sys_clk_sec() - start_systime;
+      if (!tmps.dump_decoders) tmps.decoder_dump.push_back(fmt::format("{}:\n", currently_playing));
+      tmps.decoder_dump.push_back(fmt::format("  headless: {} refreshes in {:.2f} s "
+      "({:.1f} per second) over {:.2f} s of media, rendering {:.2f} ms per "
+      "refresh\n", refreshes, wall_secs, static_cast<double>(refreshes) / wall_secs,
+      end_medtime, render_secs * 1000.0 / static_cast<double>(refreshes)));
+    }
+    tmrs.video.curses_cells.reset_counters();
+    tmrs.video.ansi_cells.reset_counters();
     if (fetcher->has_error()) {
+      tmrs.video.clear_graphics();
       throw std::runtime_error(fmt::format("[{}]: Media Fetcher Error: {}",
       FUNCDINFO, fetcher->get_error()));
     }
@@ -332,24 +581,47 @@ int tmedia_main_loop(TMediaProgramState tmps) {
     //flush getch
     while (getch() != ERR) getch(); 
     erase();
+    tmrs.video.invalidate();
     if (!tmps.plist.can_move(move_cmd)) break;
     tmps.plist.move(move_cmd);
   }
 
+  tmrs.video.clear_graphics();
   return EXIT_SUCCESS;
 }
 
 void init_global_video_output_mode(VidOutMode mode) {
   switch (mode) {
     case VidOutMode::COLOR:
-    case VidOutMode::COLOR_BG: tmcurses_set_color_palette(TMNCursesColorPalette::RGB); break;
+    case VidOutMode::COLOR_BG:
+    case VidOutMode::TRUECOLOR: // for the fallback to curses colors
+    case VidOutMode::TRUECOLOR_BG:
+    case VidOutMode::HALFBLOCK:
+    case VidOutMode::GRAPHICS: tmcurses_set_color_palette(TMNCursesColorPalette::RGB); break;
     case VidOutMode::GRAY:
     case VidOutMode::GRAY_BG: tmcurses_set_color_palette(TMNCursesColorPalette::GRAYSCALE); break;
-    case VidOutMode::PLAIN: break;
+    case VidOutMode::PLAIN:
+    case VidOutMode::BRAILLE: break;
   }
 }
 
 void set_global_vom(VidOutMode* current, VidOutMode next) {
   init_global_video_output_mode(next);
   *current = next;
+}
+
+bool vom_is_grayscale(VidOutMode mode) {
+  switch (mode) {
+    case VidOutMode::GRAY:
+    case VidOutMode::GRAY_BG:
+    case VidOutMode::PLAIN:
+    case VidOutMode::BRAILLE: return true;
+    case VidOutMode::COLOR:
+    case VidOutMode::COLOR_BG:
+    case VidOutMode::TRUECOLOR:
+    case VidOutMode::TRUECOLOR_BG:
+    case VidOutMode::HALFBLOCK:
+    case VidOutMode::GRAPHICS: return false;
+  }
+  return false;
 }
\ No newline at end of file
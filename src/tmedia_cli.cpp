@@ -57,12 +57,17 @@ const char* TMEDIA_CONTROLS_USAGE = ""
   "- Escape or Backspace or 'q' - Quit Program\n"
   "- '0' - Restart Playback\n"
   "- '1' through '9' - Skip To n/10 of the Media's Duration\n"
+  "  (Skips land on the nearest keyframe until skipping stops)\n"
   "- 'L' - Switch looping type of playback\n"
   "- 'M' - Mute/Unmute Audio\n"
   "Video, Audio, and Image Controls\n"
   "- 'C' - Color Mode (OST)\n"
   "- 'G' - Gray Mode (OST)\n"
   "- 'B' - Display no Characters (OST) (in Color or Gray mode)\n"
+  "- 'T' - Switch between Color and 24-bit Truecolor Mode (OST)\n"
+  "- 'H' - Switch Half-Block Mode, with two pixels per character (OST)\n"
+  "- 'D' - Switch Braille Mode, with eight dots per character (OST)\n"
+  "- 'I' - Switch Graphics Mode, with Sixel or kitty images (OST)\n"
   "- 'N' - Skip to Next Media File\n"
   "- 'P' - Rewind to Previous Media File\n"
   "- 'R' - Fully Refresh the Screen\n"
@@ -88,9 +93,28 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
   "  Video Output: \n"
   "    -c, --color            Play the video with color \n"
   "    -g, --gray             Play the video in grayscale \n"
+  "    --truecolor            Play the video with 24-bit color written directly\n"
+  "                           to the terminal, if COLORTERM advertises it\n"
+  "    --halfblock            Play the video with two colored pixels stacked\n"
+  "                           in each character cell\n"
+  "    --braille              Play the video as dithered braille dots, with\n"
+  "                           2x4 pixels in each character cell\n"
+  "    --graphics             Play the video as real pixels, through the Sixel\n"
+  "                           or kitty graphics protocol the terminal supports\n"
   "    -b, --background       Do not show characters, only the background \n"
   "    -f, --fullscreen       Begin the player in fullscreen mode\n"
   "    --refresh-rate         Set the refresh rate of tmedia\n"
+  "    --decode-threads [UINT]\n"
+  "                           Threads used to decode each stream (0 for auto)\n"
+  "    --lowres               Decode video at a reduced resolution when the\n"
+  "                           codec supports it, and decimate otherwise\n"
+  "    --dump-decoders        Print the decoders and threading mode used for\n"
+  "                           each played file once tmedia exits\n"
+  "    --headless             Play without a terminal and print how long\n"
+  "                           rendering took for each played file\n"
+  "    --headless-max         Play without a terminal as fast as possible\n"
+  "    --headless-size [COLSxLINES]\n"
+  "                           The screen size to play on headless\n"
   "    --chars [STRING]       The displayed characters from darkest to lightest\n"
   "\n"
   "  Audio Output: \n"
@@ -169,6 +193,10 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
 
     MediaPathSearchOptions srch_opts;
     bool colored = false;
+    bool truecolor = false;
+    bool halfblock = false;
+    bool braille = false;
+    bool graphics = false;
     bool grayscale = false;
     bool background = false;
   };
@@ -191,6 +219,10 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
   void cli_arg_background(CLIParseState& ps, const tmedia::CLIArg arg);
   void cli_arg_chars(CLIParseState& ps, const tmedia::CLIArg arg);
   void cli_arg_color(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_truecolor(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_halfblock(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_braille(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_graphics(CLIParseState& ps, const tmedia::CLIArg arg);
   void cli_arg_fullscreen(CLIParseState& ps, const tmedia::CLIArg arg);
   void cli_arg_grayscale(CLIParseState& ps, const tmedia::CLIArg arg);
   void cli_arg_no_repeat(CLIParseState& ps, const tmedia::CLIArg arg);
@@ -198,6 +230,12 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
   void cli_arg_repeat_one(CLIParseState& ps, const tmedia::CLIArg arg);
   void cli_arg_mute(CLIParseState& ps, const tmedia::CLIArg arg);
   void cli_arg_refresh_rate(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_decode_threads(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_lowres(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_dump_decoders(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_headless(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_headless_max(CLIParseState& ps, const tmedia::CLIArg arg);
+  void cli_arg_headless_size(CLIParseState& ps, const tmedia::CLIArg arg);
   void cli_arg_shuffle(CLIParseState& ps, const tmedia::CLIArg arg);
   void cli_arg_volume(CLIParseState& ps, const tmedia::CLIArg arg);
 
@@ -222,7 +260,11 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
     CLIParseState ps;
     ps.tmss.muted = false;
     ps.tmss.refresh_rate_fps = 24;
-    ps.tmss.scaling_algorithm = ScalingAlgo::BOX_SAMPLING;
+    ps.tmss.decode_threads = 0;
+    ps.tmss.lowres_decoding = false;
+    ps.tmss.dump_decoders = false;
+    ps.tmss.headless = HeadlessMode::OFF;
+    ps.tmss.headless_dims = Dim2(80, 24);
     ps.tmss.loop_type = LoopType::NO_LOOP;
     ps.tmss.vom = VidOutMode::PLAIN;
     ps.tmss.volume = 1.0;
@@ -236,7 +278,7 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
     }
 
     std::vector<tmedia::CLIArg> parsed_cli = tmedia::cli_parse(argc, argv, "",
-    {"volume", "chars", "refresh-rate", "repeat-path", "repeat-paths"});
+    {"volume", "chars", "refresh-rate", "decode-threads", "repeat-path", "repeat-paths", "headless-size"});
 
 
     static const ArgParseMap short_exiting_opt_map{
@@ -276,11 +318,22 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
       {"shuffle", cli_arg_shuffle},
       {"shuffled", cli_arg_shuffle},
       {"refresh-rate", cli_arg_refresh_rate},
+      {"decode-threads", cli_arg_decode_threads},
+      {"lowres", cli_arg_lowres},
+      {"dump-decoders", cli_arg_dump_decoders},
+      {"headless", cli_arg_headless},
+      {"headless-max", cli_arg_headless_max},
+      {"headless-size", cli_arg_headless_size},
       {"chars", cli_arg_chars},
       {"color", cli_arg_color},
       {"colour", cli_arg_color},
       {"colored", cli_arg_color},
       {"coloured", cli_arg_color},
+      {"truecolor", cli_arg_truecolor},
+      {"truecolour", cli_arg_truecolor},
+      {"halfblock", cli_arg_halfblock},
+      {"braille", cli_arg_braille},
+      {"graphics", cli_arg_graphics},
       {"gray", cli_arg_grayscale},
       {"grey", cli_arg_grayscale},
       {"greyscale", cli_arg_grayscale},
@@ -400,7 +453,15 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
       throw std::runtime_error(fmt::format("[{}] No media files found.", FUNCDINFO));
     }
 
-    if (ps.colored)
+    if (ps.graphics)
+      ps.tmss.vom = VidOutMode::GRAPHICS;
+    else if (ps.braille)
+      ps.tmss.vom = VidOutMode::BRAILLE;
+    else if (ps.halfblock)
+      ps.tmss.vom = VidOutMode::HALFBLOCK;
+    else if (ps.truecolor)
+      ps.tmss.vom = ps.background ? VidOutMode::TRUECOLOR_BG : VidOutMode::TRUECOLOR;
+    else if (ps.colored)
       ps.tmss.vom = ps.background ? VidOutMode::COLOR_BG : VidOutMode::COLOR;
     else if (ps.grayscale)
       ps.tmss.vom = ps.background ? VidOutMode::GRAY_BG : VidOutMode::GRAY;
@@ -477,6 +538,26 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
     (void)arg;
   }
 
+  void cli_arg_truecolor(CLIParseState& ps, const tmedia::CLIArg arg) {
+    ps.truecolor = true;
+    (void)arg;
+  }
+
+  void cli_arg_halfblock(CLIParseState& ps, const tmedia::CLIArg arg) {
+    ps.halfblock = true;
+    (void)arg;
+  }
+
+  void cli_arg_braille(CLIParseState& ps, const tmedia::CLIArg arg) {
+    ps.braille = true;
+    (void)arg;
+  }
+
+  void cli_arg_graphics(CLIParseState& ps, const tmedia::CLIArg arg) {
+    ps.graphics = true;
+    (void)arg;
+  }
+
   void cli_arg_fullscreen(CLIParseState& ps, const tmedia::CLIArg arg) {
     ps.tmss.fullscreen = true;
     (void)arg;
@@ -524,6 +605,66 @@ const char* TMEDIA_CLI_OPTIONS_DESC = ""
     ps.tmss.refresh_rate_fps = res;
   }
 
+  void cli_arg_decode_threads(CLIParseState& ps, const tmedia::CLIArg arg) {
+    int res = 0;
+
+    try {
+      res = strtoi32(arg.param);
+      if (res < 0) {
+        ps.argerrs.push_back(fmt::format("[{}] decode thread count must be "
+        "0 (auto) or greater. (got {})", FUNCDINFO, res));
+      }
+    } catch (const std::runtime_error& err) {
+      ps.argerrs.push_back(fmt::format("[{}] Could not parse param {} as "
+      "integer: \n\t{}", FUNCDINFO, arg.param, err.what()));
+    }
+
+    ps.tmss.decode_threads = res;
+  }
+
+  void cli_arg_lowres(CLIParseState& ps, const tmedia::CLIArg arg) {
+    ps.tmss.lowres_decoding = true;
+    (void)arg;
+  }
+
+  void cli_arg_dump_decoders(CLIParseState& ps, const tmedia::CLIArg arg) {
+    ps.tmss.dump_decoders = true;
+    (void)arg;
+  }
+
+  void cli_arg_headless(CLIParseState& ps, const tmedia::CLIArg arg) {
+    ps.tmss.headless = HeadlessMode::REALTIME;
+    (void)arg;
+  }
+
+  void cli_arg_headless_max(CLIParseState& ps, const tmedia::CLIArg arg) {
+    ps.tmss.headless = HeadlessMode::MAX_SPEED;
+    (void)arg;
+  }
+
+  void cli_arg_headless_size(CLIParseState& ps, const tmedia::CLIArg arg) {
+    const std::size_t sep = arg.param.find('x');
+    if (sep == std::string_view::npos) {
+      ps.argerrs.push_back(fmt::format("[{}] Could not parse param {} as "
+      "COLSxLINES", FUNCDINFO, arg.param));
+      return;
+    }
+
+    try {
+      const int cols = strtoi32(arg.param.substr(0, sep));
+      const int lines = strtoi32(arg.param.substr(sep + 1));
+      if (cols <= 0 || lines <= 0) {
+        ps.argerrs.push_back(fmt::format("[{}] headless screen size must be "
+        "greater than 0x0. (got {})", FUNCDINFO, arg.param));
+      } else {
+        ps.tmss.headless_dims = Dim2(cols, lines);
+      }
+    } catch (const std::runtime_error& err) {
+      ps.argerrs.push_back(fmt::format("[{}] Could not parse param {} as "
+      "COLSxLINES: \n\t{}", FUNCDINFO, arg.param, err.what()));
+    }
+  }
+
   void cli_arg_shuffle(CLIParseState& ps, const tmedia::CLIArg arg) {
     ps.tmss.shuffled = true;
     (void)arg;
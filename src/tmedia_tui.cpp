@@ -1,12 +1,18 @@
 #include <tmedia/tmedia.h>
 
 #include <tmedia/tmcurses/tmcurses.h>
+#include <tmedia/tmcurses/braillekernel.h>
+#include <tmedia/tmcurses/cellrenderer.h>
+#include <tmedia/term/termcaps.h>
 #include <tmedia/tmedia_tui_elems.h>
 #include <tmedia/util/formatting.h>
 #include <tmedia/media/metadata.h>
 #include <tmedia/util/defines.h>
 
 #include <stdexcept>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <fmt/format.h>
 
 extern "C" {
@@ -16,7 +22,7 @@ extern "C" {
 
 const char* loop_type_cstr_short(LoopType loop_type);
 std::string get_media_file_display_name(const std::string& abs_path, MetadataCache& mchc);
-void render_pixel_data(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VidOutMode output_mode, const ScalingAlgo scaling_algorithm, std::string_view ascii_char_map);
+void render_pixel_data(const PixelData& pixel_data, const CellFrame* frame_cells, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VidOutMode output_mode, std::string_view ascii_char_map, VideoSurface& surface);
 
 void render_tui(const TMediaProgramState& tmps, const TMediaProgramSnapshot& sshot, TMediaRendererState& tmrs) {
   static constexpr int MIN_RENDER_COLS = 2;
@@ -25,10 +31,12 @@ void render_tui(const TMediaProgramState& tmps, const TMediaProgramSnapshot& ssh
   if (sshot.frame.get_width() != tmrs.last_frame_dims.width ||
       sshot.frame.get_height() != tmrs.last_frame_dims.height) {
     erase();
+    tmrs.video.invalidate();
   }
 
   if (COLS < MIN_RENDER_COLS || LINES < MIN_RENDER_LINES) {
     erase();
+    tmrs.video.invalidate();
   } else if (COLS <= 20 || LINES < 10 || tmps.fullscreen) {
     render_tui_fullscreen(tmps, sshot, tmrs);
   } else if (COLS < 60) {
@@ -41,14 +49,14 @@ void render_tui(const TMediaProgramState& tmps, const TMediaProgramSnapshot& ssh
 }
 
 void render_tui_fullscreen(const TMediaProgramState& tmps, const TMediaProgramSnapshot& sshot, TMediaRendererState& tmrs) {
-  render_pixel_data(sshot.frame, 0, 0, COLS, LINES, tmps.vom, tmps.scaling_algorithm, tmps.ascii_display_chars);
+  render_pixel_data(sshot.frame, sshot.frame_cells.get(), 0, 0, COLS, LINES, tmps.vom, tmps.ascii_display_chars, tmrs.video);
   tmrs.req_frame_dim = Dim2(COLS, LINES);
   (void)tmrs;
 }
 
 void render_tui_compact(const TMediaProgramState& tmps, const TMediaProgramSnapshot& sshot, TMediaRendererState& tmrs) {
   static constexpr int CURRENT_FILE_NAME_MARGIN = 5;
-  render_pixel_data(sshot.frame, 2, 0, COLS, LINES - 4, tmps.vom, tmps.scaling_algorithm, tmps.ascii_display_chars);
+  render_pixel_data(sshot.frame, sshot.frame_cells.get(), 2, 0, COLS, LINES - 4, tmps.vom, tmps.ascii_display_chars, tmrs.video);
   tmrs.req_frame_dim = Dim2(COLS, LINES - 4);
 
   wfill_box(stdscr, 1, 0, COLS, 1, '~');
@@ -80,11 +88,14 @@ void render_tui_compact(const TMediaProgramState& tmps, const TMediaProgramSnaps
     const std::string_view loop_str = loop_type_cstr_short(tmps.plist.loop_type()); 
     const std::string volume_str = tmps.muted ? "M" : (fmt::format("{}%", static_cast<int>(tmps.volume * 100)));
     const std::string_view shuffled_str = tmps.plist.shuffled() ? "S" : "NS";
+    const int scale_percent = static_cast<int>(tmrs.output_scaler.get_scale() * 100);
+    const std::string scale_str = fmt::format("x{}%", scale_percent);
 
     bottom_labels.push_back(playing_str);
     if (tmps.plist.size() > 1) bottom_labels.push_back(shuffled_str);
     bottom_labels.push_back(loop_str);
     if (sshot.has_audio_output) bottom_labels.push_back(volume_str);
+    if (scale_percent < 100) bottom_labels.push_back(scale_str);
     werasebox(stdscr, LINES - 1, 0, COLS, 1);
     wprint_labels(stdscr, bottom_labels, LINES - 1, 0, COLS);
   }
@@ -93,7 +104,7 @@ void render_tui_compact(const TMediaProgramState& tmps, const TMediaProgramSnaps
 
 void render_tui_large(const TMediaProgramState& tmps, const TMediaProgramSnapshot& sshot, TMediaRendererState& tmrs) {
   static constexpr int CURRENT_FILE_NAME_MARGIN = 5;
-  render_pixel_data(sshot.frame, 2, 0, COLS, LINES - 4, tmps.vom, tmps.scaling_algorithm, tmps.ascii_display_chars);
+  render_pixel_data(sshot.frame, sshot.frame_cells.get(), 2, 0, COLS, LINES - 4, tmps.vom, tmps.ascii_display_chars, tmrs.video);
   tmrs.req_frame_dim = Dim2(COLS, LINES - 4);
   
   werasebox(stdscr, 0, 0, COLS, 2);
@@ -136,11 +147,14 @@ void render_tui_large(const TMediaProgramState& tmps, const TMediaProgramSnapsho
     const std::string loop_str = str_capslock(loop_type_cstr(tmps.plist.loop_type())); 
     const std::string volume_str = tmps.muted ? "MUTED" : fmt::format("VOLUME: {}%", static_cast<int>(tmps.volume * 100));
     const std::string_view shuffled_str = tmps.plist.shuffled() ? "SHUFFLED" : "NOT SHUFFLED";
+    const int scale_percent = static_cast<int>(tmrs.output_scaler.get_scale() * 100);
+    const std::string scale_str = fmt::format("SCALE: {}%", scale_percent);
 
     bottom_labels.push_back(playing_str);
     if (tmps.plist.size() > 1) bottom_labels.push_back(shuffled_str);
     bottom_labels.push_back(loop_str);
     if (sshot.has_audio_output) bottom_labels.push_back(volume_str);
+    if (scale_percent < 100) bottom_labels.push_back(scale_str);
     werasebox(stdscr, LINES - 1, 0, COLS, 1);
     wprint_labels(stdscr, bottom_labels, LINES - 1, 0, COLS);
   }
@@ -169,15 +183,124 @@ std::string get_media_file_display_name(const std::string& abs_path, MetadataCac
   return std::filesystem::path(abs_path).filename().string();
 }
 
-void render_pixel_data(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VidOutMode output_mode, const ScalingAlgo scaling_algorithm, std::string_view ascii_char_map) {
+VidOutMode resolve_vom(VidOutMode mode, bool truecolor_supported) {
+  if (!truecolor_supported) { // fall back to the curses color pairs
+    if (mode == VidOutMode::TRUECOLOR) mode = VidOutMode::COLOR;
+    if (mode == VidOutMode::TRUECOLOR_BG) mode = VidOutMode::COLOR_BG;
+  }
+
+  if (mode == VidOutMode::GRAPHICS) {
+    const Dim2 cell_pixels = term_cell_pixels();
+    if (term_graphics_caps().protocol != TermGraphics::NONE && cell_pixels.width > 0 && cell_pixels.height > 0)
+      return mode;
+    mode = VidOutMode::HALFBLOCK;
+  }
+
+  if (mode == VidOutMode::HALFBLOCK) {
+    if (truecolor_supported || curses_halfblock_supported()) return mode;
+    mode = VidOutMode::COLOR_BG;
+  }
+
+  if (mode == VidOutMode::TRUECOLOR || mode == VidOutMode::TRUECOLOR_BG || mode == VidOutMode::BRAILLE)
+    return mode;
+
   if (!tmcurses_has_colors()) // if there are no colors, just don't print colors :)
-    output_mode = VidOutMode::PLAIN;
+    return VidOutMode::PLAIN;
+  return mode;
+}
 
+void render_pixel_data(const PixelData& pixel_data, const CellFrame* frame_cells, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VidOutMode output_mode, std::string_view ascii_char_map, VideoSurface& surface) {
+  output_mode = resolve_vom(output_mode, surface.truecolor_supported);
+
+  const bool ansi = output_mode == VidOutMode::TRUECOLOR || output_mode == VidOutMode::TRUECOLOR_BG
+    || (output_mode == VidOutMode::HALFBLOCK && surface.truecolor_supported)
+    || (output_mode == VidOutMode::BRAILLE && !curses_wide_supported())
+    || output_mode == VidOutMode::GRAPHICS;
+  if (output_mode != surface.vom || ansi != surface.ansi_active) {
+    surface.invalidate();
+    if (ansi && !surface.ansi_active) { // curses must not print over the ANSI output
+      werasebox(stdscr, bounds_row, bounds_col, bounds_width, bounds_height);
+    }
+    surface.ansi_active = ansi;
+    surface.vom = output_mode;
+  }
+
+  const std::shared_ptr<const CellRenderer> renderer = vom_cell_renderer(output_mode, ascii_char_map, surface.color_bits);
   switch (output_mode) {
-    case VidOutMode::PLAIN: return render_pixel_data_plain(pixel_data, bounds_row, bounds_col, bounds_width, bounds_height, scaling_algorithm, ascii_char_map);
+    case VidOutMode::PLAIN:
     case VidOutMode::COLOR:
-    case VidOutMode::GRAY: return render_pixel_data_color(pixel_data, bounds_row, bounds_col, bounds_width, bounds_height, scaling_algorithm, ascii_char_map);
+    case VidOutMode::GRAY:
     case VidOutMode::COLOR_BG:
-    case VidOutMode::GRAY_BG: return render_pixel_data_bg(pixel_data, bounds_row, bounds_col, bounds_width, bounds_height, scaling_algorithm);
+    case VidOutMode::GRAY_BG: return render_pixel_data_cells(pixel_data, frame_cells, bounds_row, bounds_col, bounds_width, bounds_height, renderer, surface.curses_cells);
+    case VidOutMode::TRUECOLOR:
+    case VidOutMode::TRUECOLOR_BG: return render_pixel_data_truecolor(pixel_data, frame_cells, bounds_row, bounds_col, bounds_width, bounds_height, renderer, surface);
+    case VidOutMode::HALFBLOCK: return render_pixel_data_halfblock(pixel_data, bounds_row, bounds_col, bounds_width, bounds_height, surface);
+    case VidOutMode::BRAILLE: return render_pixel_data_braille(pixel_data, bounds_row, bounds_col, bounds_width, bounds_height, surface);
+    case VidOutMode::GRAPHICS: return render_pixel_data_graphics(pixel_data, bounds_row, bounds_col, bounds_width, bounds_height, surface);
   }
+}
+
+Dim2 vom_cell_pixels(VidOutMode mode) {
+  switch (mode) {
+    case VidOutMode::HALFBLOCK: return Dim2(1, 2);
+    case VidOutMode::BRAILLE: return Dim2(BRAILLE_CELL_WIDTH, BRAILLE_CELL_HEIGHT);
+    case VidOutMode::GRAPHICS: {
+      const Dim2 cell_pixels = term_cell_pixels();
+      return cell_pixels.width > 0 && cell_pixels.height > 0 ? cell_pixels : Dim2(1, 1);
+    }
+    case VidOutMode::PLAIN:
+    case VidOutMode::COLOR:
+    case VidOutMode::GRAY:
+    case VidOutMode::COLOR_BG:
+    case VidOutMode::GRAY_BG:
+    case VidOutMode::TRUECOLOR:
+    case VidOutMode::TRUECOLOR_BG: return Dim2(1, 1);
+  }
+  return Dim2(1, 1);
+}
+
+
+std::shared_ptr<const CellRenderer> vom_cell_renderer(VidOutMode mode, std::string_view ascii_char_map, int color_bits) {
+  static std::shared_ptr<const CellRenderer> renderer;
+  static VidOutMode renderer_mode{};
+  static std::string renderer_char_map;
+  static int renderer_color_bits = 0;
+  static unsigned int renderer_generation = 0;
+
+  switch (mode) {
+    case VidOutMode::PLAIN:
+    case VidOutMode::COLOR:
+    case VidOutMode::GRAY:
+    case VidOutMode::COLOR_BG:
+    case VidOutMode::GRAY_BG:
+    case VidOutMode::TRUECOLOR:
+    case VidOutMode::TRUECOLOR_BG: break;
+    case VidOutMode::HALFBLOCK:
+    case VidOutMode::BRAILLE:
+    case VidOutMode::GRAPHICS: return nullptr;
+  }
+
+  const unsigned int generation = tmcurses_color_maps_generation();
+  if (renderer && renderer_mode == mode && renderer_char_map == ascii_char_map
+    && renderer_color_bits == color_bits && renderer_generation == generation)
+    return renderer;
+
+  switch (mode) {
+    case VidOutMode::PLAIN: renderer = std::make_shared<const CellRenderer>(ascii_char_map, true, false); break;
+    case VidOutMode::COLOR:
+    case VidOutMode::GRAY: renderer = std::make_shared<const CellRenderer>(ascii_char_map, true, true); break;
+    case VidOutMode::COLOR_BG:
+    case VidOutMode::GRAY_BG: renderer = std::make_shared<const CellRenderer>(ASCII_STANDARD_CHAR_MAP, false, true); break;
+    case VidOutMode::TRUECOLOR: renderer = std::make_shared<const CellRenderer>(CellRenderer::Output::ANSI_FG, ascii_char_map, color_bits); break;
+    case VidOutMode::TRUECOLOR_BG: renderer = std::make_shared<const CellRenderer>(CellRenderer::Output::ANSI_BG, ascii_char_map, color_bits); break;
+    case VidOutMode::HALFBLOCK:
+    case VidOutMode::BRAILLE:
+    case VidOutMode::GRAPHICS: return nullptr;
+  }
+
+  renderer_mode = mode;
+  renderer_char_map = ascii_char_map;
+  renderer_color_bits = color_bits;
+  renderer_generation = generation;
+  return renderer;
 }
\ No newline at end of file
@@ -2,17 +2,35 @@
 
 #include <tmedia/image/ascii.h>
 #include <tmedia/image/pixeldata.h>
+#include <tmedia/image/scale.h>
 #include <tmedia/util/defines.h>
 #include <tmedia/util/formatting.h>
 #include <tmedia/tmcurses/tmcurses.h>
+#include <tmedia/tmcurses/cellrenderer.h>
+#include <tmedia/tmcurses/braillekernel.h>
+#include <tmedia/term/termcaps.h>
+#include <tmedia/term/sixel.h>
+#include <tmedia/term/kittygfx.h>
+#include <tmedia/tmcurses/cellgrid.h>
 #include <tmedia/util/defines.h>
+#include <tmedia/util/rowpool.h>
 
 #include <fmt/format.h>
 
 
 #include <stdexcept>
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <thread>
+
+#include <unistd.h>
 
 extern "C" {
   #include <curses.h>
@@ -41,57 +59,340 @@ void wprint_playback_bar(WINDOW* window, int y, int x, int width, double time_in
     wprint_progress_bar(window, y, x + current_time_string.length() + PADDING_BETWEEN_ELEMENTS, progress_bar_width, 1,time_in_seconds / duration_in_seconds);
 }
 
-void render_pixel_data_plain(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const ScalingAlgo scaling_algorithm, std::string_view ascii_char_map) {
-  const PixelData bounded = pixel_data.bound(bounds_width, bounds_height, scaling_algorithm);
-  const int image_start_row = bounds_row + std::abs(bounded.get_height() - bounds_height) / 2;
-  const int image_start_col = bounds_col + std::abs(bounded.get_width() - bounds_width) / 2; 
+// below this many cells for each band of rows, handing bands to the render
+// pool's workers costs more than converting them on the rendering thread
+static constexpr int MIN_RENDER_BAND_CELLS = 16384;
+static constexpr int MAX_RENDER_THREADS = 8;
 
-  const std::vector<RGB24>& pixels = bounded.data();
-  const int width = bounded.get_width(); 
+/**
+ * Returns the pool which converts bands of pixel rows into cells, with one
+ * worker for every core past the first, created on first use. Only to be
+ * called from the rendering thread.
+*/
+static RowPool& get_render_pool() {
+  static RowPool pool(std::min(static_cast<int>(std::thread::hardware_concurrency()), MAX_RENDER_THREADS) - 1);
+  return pool;
+}
 
-  for (int row = 0; row < bounded.get_height(); row++) {
-    move(image_start_row + row, image_start_col);
-    const int row_offset = row * width;
-    for (int col = 0; col < width; col++) {
-      addch(get_char_from_rgb(ascii_char_map, pixels[row_offset + col]));
+static int min_render_band_rows(int width) {
+  return MIN_RENDER_BAND_CELLS / std::max(width, 1) + 1;
+}
+
+void render_pixel_data_cells(const PixelData& pixel_data, const CellFrame* frame_cells, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const std::shared_ptr<const CellRenderer>& renderer, CellGrid<chtype>& grid) {
+  static std::vector<chtype> mapped_cells;
+  static std::vector<CellRun> runs;
+
+  const FrameFit fit = fit_frame(pixel_data.get_width(), pixel_data.get_height(), Dim2(1, 1), bounds_width, bounds_height);
+  const int image_start_row = bounds_row + fit.row;
+  const int image_start_col = bounds_col + fit.col;
+  const int width = fit.width;
+  grid.begin_frame(image_start_row, image_start_col, width, fit.height);
+
+  const chtype* cells;
+  std::size_t stride;
+  if (frame_cells != nullptr && frame_cells->renderer == renderer) {
+    cells = frame_cells->curses_cells.data() + static_cast<std::size_t>(fit.src_row) * frame_cells->width + fit.src_col;
+    stride = static_cast<std::size_t>(frame_cells->width);
+  } else {
+    mapped_cells.resize(static_cast<std::size_t>(width) * fit.height);
+    get_render_pool().run(fit.height, min_render_band_rows(width), [&] (int begin, int end) {
+      for (int row = begin; row < end; row++) {
+        renderer->map_row(pixel_data, fit.src_row + row, fit.src_col, width, mapped_cells.data() + static_cast<std::size_t>(row) * width);
+      }
+    });
+    cells = mapped_cells.data();
+    stride = static_cast<std::size_t>(width);
+  }
+
+  for (int row = 0; row < fit.height; row++) {
+    const chtype* row_cells = cells + static_cast<std::size_t>(row) * stride;
+    grid.diff_row(row, row_cells, runs);
+    for (const CellRun& run : runs) {
+      mvaddchnstr(image_start_row + row, image_start_col + run.col, row_cells + run.col, run.length);
     }
   }
 }
 
-void render_pixel_data_bg(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const ScalingAlgo scaling_algorithm) {
-  const PixelData bounded = pixel_data.bound(bounds_width, bounds_height, scaling_algorithm);
-  const int image_start_row = bounds_row + std::abs(bounded.get_height() - bounds_height) / 2;
-  const int image_start_col = bounds_col + std::abs(bounded.get_width() - bounds_width) / 2; 
-  const std::vector<RGB24>& pixels = bounded.data();
-  const int width = bounded.get_width();
+void VideoSurface::invalidate() {
+  this->curses_cells.invalidate();
+  this->halfblock_cells.invalidate();
+  this->braille_cells.invalidate();
+  this->ansi_cells.invalidate();
+  this->graphics_shown = false;
+  this->clear_graphics();
+  if (this->ansi_active) clearok(stdscr, TRUE);
+}
 
-  for (int row = 0; row < bounded.get_height(); row++) {
-    move(image_start_row + row, image_start_col);
-    const int row_offset = row * width;
-    for (int col = 0; col < width; col++) {
-      const int color_pair = get_closest_tmcurses_color_pair(pixels[row_offset + col]);
-      addch(' ' | COLOR_PAIR(color_pair));
+// "tmed", to not collide with the images of other programs in the terminal
+static constexpr std::uint32_t KITTY_IMAGE_ID = 0x746D6564;
+
+// places the cursor to the right of sixel images instead of below them, so
+// that images reaching the bottom of the screen do not scroll it
+static constexpr std::string_view SIXEL_CURSOR_RIGHT = "\x1b[?8452h";
+static constexpr std::string_view SIXEL_CURSOR_BELOW = "\x1b[?8452l"; // the terminal's default
+
+void VideoSurface::clear_graphics() {
+  std::string command;
+  if (this->kitty_image_shown) {
+    kitty_delete_image(KITTY_IMAGE_ID, command);
+    this->kitty_image_shown = false;
+  }
+
+  if (this->sixel_cursor_right) {
+    command.append(SIXEL_CURSOR_BELOW);
+    this->sixel_cursor_right = false;
+  }
+
+  if (!command.empty()) term_write_all(tmcurses_output_fd(), command.data(), command.size());
+}
+
+void render_pixel_data_truecolor(const PixelData& pixel_data, const CellFrame* frame_cells, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const std::shared_ptr<const CellRenderer>& renderer, VideoSurface& surface) {
+  static std::vector<AnsiCell> mapped_cells;
+  static std::vector<CellRun> runs;
+
+  const FrameFit fit = fit_frame(pixel_data.get_width(), pixel_data.get_height(), Dim2(1, 1), bounds_width, bounds_height);
+  const int image_start_row = bounds_row + fit.row;
+  const int image_start_col = bounds_col + fit.col;
+  const int width = fit.width;
+  surface.ansi_cells.begin_frame(image_start_row, image_start_col, width, fit.height);
+  surface.ansi_frame.begin_frame(surface.synchronized_update);
+
+  const AnsiCell* cells;
+  std::size_t stride;
+  if (frame_cells != nullptr && frame_cells->renderer == renderer) {
+    cells = frame_cells->ansi_cells.data() + static_cast<std::size_t>(fit.src_row) * frame_cells->width + fit.src_col;
+    stride = static_cast<std::size_t>(frame_cells->width);
+  } else {
+    mapped_cells.resize(static_cast<std::size_t>(width) * fit.height);
+    get_render_pool().run(fit.height, min_render_band_rows(width), [&] (int begin, int end) {
+      for (int row = begin; row < end; row++) {
+        renderer->map_row(pixel_data, fit.src_row + row, fit.src_col, width, mapped_cells.data() + static_cast<std::size_t>(row) * width);
+      }
+    });
+    cells = mapped_cells.data();
+    stride = static_cast<std::size_t>(width);
+  }
+
+  for (int row = 0; row < fit.height; row++) {
+    const AnsiCell* row_cells = cells + static_cast<std::size_t>(row) * stride;
+    surface.ansi_cells.diff_row(row, row_cells, runs);
+    for (const CellRun& run : runs) {
+      surface.ansi_frame.put_cells(image_start_row + row, image_start_col + run.col, row_cells + run.col, run.length);
     }
   }
+
+  surface.ansi_frame.end_frame();
+}
+
+static constexpr std::uint32_t UPPER_HALF_BLOCK = 0x2580;
+
+bool curses_halfblock_supported() {
+#ifdef TMEDIA_WIDE_CURSES
+  return tmcurses_has_halfblock_pairs();
+#else
+  return false;
+#endif
 }
 
-void render_pixel_data_color(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, const ScalingAlgo scaling_algorithm, std::string_view ascii_char_map) {
-  const PixelData bounded = pixel_data.bound(bounds_width, bounds_height, scaling_algorithm);
-  const int image_start_row = bounds_row + std::abs(bounded.get_height() - bounds_height) / 2;
-  const int image_start_col = bounds_col + std::abs(bounded.get_width() - bounds_width) / 2; 
-  const std::vector<RGB24>& pixels = bounded.data();
-  const int width = bounded.get_width();
+void render_pixel_data_halfblock(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VideoSurface& surface) {
+  static std::vector<AnsiCell> ansi_cells;
+  static std::vector<CellRun> runs;
+
+  const FrameFit fit = fit_frame(pixel_data.get_width(), pixel_data.get_height(), Dim2(1, 2), bounds_width, bounds_height);
+  const int width = fit.width;
+  const int height = fit.cells_height;
+  const int image_start_row = bounds_row + fit.row;
+  const int image_start_col = bounds_col + fit.col;
+
+  if (surface.ansi_active) {
+    ansi_cells.resize(width);
+    surface.ansi_cells.begin_frame(image_start_row, image_start_col, width, height);
+    surface.ansi_frame.begin_frame(surface.synchronized_update);
+
+    for (int row = 0; row < height; row++) {
+      const int bottom_row = row * 2 + 1;
+      for (int col = 0; col < width; col++) {
+        const RGB24 top = pixel_data.at(fit.src_row + row * 2, fit.src_col + col);
+        ansi_cells[col].codepoint = UPPER_HALF_BLOCK;
+        ansi_cells[col].fg = ansi_reduce_color((top.r << 16) | (top.g << 8) | top.b, surface.color_bits);
+        ansi_cells[col].bg = ANSI_DEFAULT_COLOR;
+        if (bottom_row < fit.height) {
+          const RGB24 bottom = pixel_data.at(fit.src_row + bottom_row, fit.src_col + col);
+          ansi_cells[col].bg = ansi_reduce_color((bottom.r << 16) | (bottom.g << 8) | bottom.b, surface.color_bits);
+        }
+      }
+
+      surface.ansi_cells.diff_row(row, ansi_cells.data(), runs);
+      for (const CellRun& run : runs) {
+        surface.ansi_frame.put_cells(image_start_row + row, image_start_col + run.col, ansi_cells.data() + run.col, run.length);
+      }
+    }
+
+    surface.ansi_frame.end_frame();
+    return;
+  }
+
+#ifdef TMEDIA_WIDE_CURSES
+  static constexpr wchar_t UPPER_HALF_BLOCK_WSTR[] = { static_cast<wchar_t>(UPPER_HALF_BLOCK), L'\0' };
+  static std::vector<curses_color_pair_t> pair_cells;
+  static std::vector<cchar_t> wide_cells;
+  pair_cells.resize(width);
+  wide_cells.resize(width);
+  surface.halfblock_cells.begin_frame(image_start_row, image_start_col, width, height);
 
-  for (int row = 0; row < bounded.get_height(); row++) {
-    move(image_start_row + row, image_start_col);
-    const int row_offset = row * width;
+  for (int row = 0; row < height; row++) {
+    const int bottom_row = row * 2 + 1;
     for (int col = 0; col < width; col++) {
-      const RGB24 target_color = pixels[row_offset + col];
-      const char target_char = get_char_from_rgb(ascii_char_map, target_color);
-      const int color_pair = get_closest_tmcurses_color_pair(target_color);
-      addch(target_char | COLOR_PAIR(color_pair));
+      const RGB24 top = pixel_data.at(fit.src_row + row * 2, fit.src_col + col);
+      // like the ANSI path, a missing bottom pixel shows the default background
+      pair_cells[col] = bottom_row < fit.height
+        ? get_tmcurses_halfblock_pair(top, pixel_data.at(fit.src_row + bottom_row, fit.src_col + col))
+        : get_tmcurses_halfblock_top_pair(top);
+    }
+
+    surface.halfblock_cells.diff_row(row, pair_cells.data(), runs);
+    for (const CellRun& run : runs) {
+      for (int i = 0; i < run.length; i++) {
+        setcchar(&wide_cells[i], UPPER_HALF_BLOCK_WSTR, A_NORMAL, pair_cells[run.col + i], nullptr);
+      }
+      mvadd_wchnstr(image_start_row + row, image_start_col + run.col, wide_cells.data(), run.length);
+    }
+  }
+#endif
+}
+
+/**
+ * Returns if both PixelData hold exactly the same pixels
+*/
+static bool same_pixels(const PixelData& a, const PixelData& b) {
+  if (a.get_width() != b.get_width() || a.get_height() != b.get_height() || a.is_gray() != b.is_gray())
+    return false;
+  const std::size_t nb_pixels = static_cast<std::size_t>(a.get_width()) * a.get_height();
+  if (a.is_gray()) return std::memcmp(a.gray_data().data(), b.gray_data().data(), nb_pixels) == 0;
+  return std::memcmp(a.data().data(), b.data().data(), nb_pixels * sizeof(RGB24)) == 0;
+}
+
+void render_pixel_data_graphics(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VideoSurface& surface) {
+  const TermGraphics protocol = term_graphics_caps().protocol;
+  const Dim2 cell_pixels = term_cell_pixels();
+  if (protocol == TermGraphics::NONE || cell_pixels.width <= 0 || cell_pixels.height <= 0) return;
+
+  const FrameFit fit = fit_frame(pixel_data.get_width(), pixel_data.get_height(), cell_pixels, bounds_width, bounds_height);
+  const int width = fit.cells_width;
+  const int height = fit.cells_height;
+  const int image_start_row = bounds_row + fit.row;
+  const int image_start_col = bounds_col + fit.col;
+
+  // only frames produced before the bounds changed need cropping
+  const bool cropped = fit.width != pixel_data.get_width() || fit.height != pixel_data.get_height();
+  const PixelData shown = cropped ? pixel_data.crop(fit.src_row, fit.src_col, fit.width, fit.height) : pixel_data;
+
+  if (surface.graphics_shown && surface.graphics_row == image_start_row
+    && surface.graphics_col == image_start_col && same_pixels(shown, surface.graphics_frame)) {
+    return;
+  }
+
+  surface.graphics_bytes.clear();
+  if (protocol == TermGraphics::KITTY) {
+    surface.kitty_encoder.encode(shown, KITTY_IMAGE_ID, width, height, surface.graphics_bytes);
+    surface.kitty_image_shown = true;
+  } else {
+    surface.graphics_bytes.append(SIXEL_CURSOR_RIGHT);
+    surface.sixel_cursor_right = true;
+    surface.sixel_encoder.encode(shown, surface.graphics_bytes);
+  }
+
+  surface.ansi_frame.begin_frame(surface.synchronized_update);
+  surface.ansi_frame.put_image(image_start_row, image_start_col, surface.graphics_bytes);
+  surface.ansi_frame.end_frame();
+
+  // copied, since the video thread reuses the buffers of presented frames
+  surface.graphics_frame = shown.is_gray() ?
+    PixelData(std::make_shared<std::vector<std::uint8_t>>(shown.gray_data()), shown.get_width(), shown.get_height())
+    : PixelData(shown.data(), shown.get_width(), shown.get_height());
+  surface.graphics_row = image_start_row;
+  surface.graphics_col = image_start_col;
+  surface.graphics_shown = true;
+}
+
+bool curses_wide_supported() {
+#ifdef TMEDIA_WIDE_CURSES
+  return true;
+#else
+  return false;
+#endif
+}
+
+void render_pixel_data_braille(const PixelData& pixel_data, int bounds_row, int bounds_col, int bounds_width, int bounds_height, VideoSurface& surface) {
+  static const BrailleKernel kernel;
+  static std::vector<std::uint8_t> grays;
+  static std::vector<std::uint32_t> row_cells;
+  static std::vector<CellRun> runs;
+
+  const FrameFit fit = fit_frame(pixel_data.get_width(), pixel_data.get_height(), Dim2(BRAILLE_CELL_WIDTH, BRAILLE_CELL_HEIGHT), bounds_width, bounds_height);
+  const int pixel_width = fit.width;
+  const int pixel_height = fit.height;
+  const int width = fit.cells_width;
+  const int height = fit.cells_height;
+  const int image_start_row = bounds_row + fit.row;
+  const int image_start_col = bounds_col + fit.col;
+
+  const std::uint8_t* gray_pixels = nullptr;
+  if (pixel_data.is_gray() && pixel_width == pixel_data.get_width()) {
+    gray_pixels = pixel_data.gray_data().data() + static_cast<std::size_t>(fit.src_row) * pixel_width;
+  } else { // only given color or oversized frames until the video thread has caught up
+    grays.resize(static_cast<std::size_t>(pixel_width) * pixel_height);
+    for (int row = 0; row < pixel_height; row++) {
+      for (int col = 0; col < pixel_width; col++) {
+        grays[static_cast<std::size_t>(row) * pixel_width + col] = pixel_data.at(fit.src_row + row, fit.src_col + col).gray_val();
+      }
+    }
+    gray_pixels = grays.data();
+  }
+
+  row_cells.resize(width);
+  if (surface.ansi_active) {
+    static std::vector<AnsiCell> ansi_cells;
+    ansi_cells.resize(width);
+    surface.ansi_cells.begin_frame(image_start_row, image_start_col, width, height);
+    surface.ansi_frame.begin_frame(surface.synchronized_update);
+
+    for (int row = 0; row < height; row++) {
+      const int pixel_row = row * BRAILLE_CELL_HEIGHT;
+      kernel.map_row(gray_pixels + pixel_row * pixel_width, pixel_width, std::min(BRAILLE_CELL_HEIGHT, pixel_height - pixel_row), row_cells.data());
+      for (int col = 0; col < width; col++) {
+        ansi_cells[col] = AnsiCell{row_cells[col], ANSI_DEFAULT_COLOR, ANSI_DEFAULT_COLOR};
+      }
+
+      surface.ansi_cells.diff_row(row, ansi_cells.data(), runs);
+      for (const CellRun& run : runs) {
+        surface.ansi_frame.put_cells(image_start_row + row, image_start_col + run.col, ansi_cells.data() + run.col, run.length);
+      }
+    }
+
+    surface.ansi_frame.end_frame();
+    return;
+  }
+
+#ifdef TMEDIA_WIDE_CURSES
+  static std::vector<cchar_t> wide_cells;
+  wide_cells.resize(width);
+  surface.braille_cells.begin_frame(image_start_row, image_start_col, width, height);
+
+  for (int row = 0; row < height; row++) {
+    const int pixel_row = row * BRAILLE_CELL_HEIGHT;
+    kernel.map_row(gray_pixels + pixel_row * pixel_width, pixel_width, std::min(BRAILLE_CELL_HEIGHT, pixel_height - pixel_row), row_cells.data());
+
+    surface.braille_cells.diff_row(row, row_cells.data(), runs);
+    for (const CellRun& run : runs) {
+      for (int i = 0; i < run.length; i++) {
+        const wchar_t wstr[] = { static_cast<wchar_t>(row_cells[run.col + i]), L'\0' };
+        setcchar(&wide_cells[i], wstr, A_NORMAL, 0, nullptr);
+      }
+      mvadd_wchnstr(image_start_row + row, image_start_col + run.col, wide_cells.data(), run.length);
     }
   }
+#endif
 }
 
 void wprint_labels(WINDOW* window, std::vector<std::string_view>& labels, int y, int x, int width) {
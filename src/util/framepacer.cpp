@@ -0,0 +1,62 @@
+#include <tmedia/util/framepacer.h>
+
+#include <cmath>
+#include <algorithm>
+
+FramePacer::FramePacer(double fps) {
+  this->m_interval = 1.0 / fps;
+  this->m_deadline = NAN;
+  this->reset_stats();
+}
+
+void FramePacer::begin_refresh(double currsystime) {
+  if (!std::isfinite(this->m_deadline) || currsystime < this->m_deadline) {
+    this->m_deadline = currsystime;
+  }
+}
+
+double FramePacer::end_refresh(double currsystime) {
+  if (!std::isfinite(this->m_deadline)) this->m_deadline = currsystime;
+
+  double next_deadline = this->m_deadline + this->m_interval;
+  const double slack = next_deadline - currsystime;
+  if (slack < 0.0) {
+    this->m_overruns++;
+    this->m_max_overrun = std::max(this->m_max_overrun, -slack);
+    next_deadline += std::ceil(-slack / this->m_interval) * this->m_interval;
+  }
+
+  this->m_min_slack = this->m_refreshes == 0 ? slack : std::min(this->m_min_slack, slack);
+  this->m_total_slack += slack;
+  this->m_refreshes++;
+  this->m_deadline = next_deadline;
+  return next_deadline;
+}
+
+void FramePacer::reset_stats() {
+  this->m_refreshes = 0;
+  this->m_overruns = 0;
+  this->m_total_slack = 0.0;
+  this->m_min_slack = 0.0;
+  this->m_max_overrun = 0.0;
+}
+
+std::uint64_t FramePacer::get_refreshes() const noexcept {
+  return this->m_refreshes;
+}
+
+std::uint64_t FramePacer::get_overruns() const noexcept {
+  return this->m_overruns;
+}
+
+double FramePacer::get_mean_slack() const noexcept {
+  return this->m_refreshes > 0 ? this->m_total_slack / static_cast<double>(this->m_refreshes) : 0.0;
+}
+
+double FramePacer::get_min_slack() const noexcept {
+  return this->m_min_slack;
+}
+
+double FramePacer::get_max_overrun() const noexcept {
+  return this->m_max_overrun;
+}
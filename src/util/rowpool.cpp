@@ -0,0 +1,87 @@
+#include <tmedia/util/rowpool.h>
+
+#include <algorithm>
+
+RowPool::RowPool(int nb_workers) {
+  this->m_band_fn = nullptr;
+  this->m_nb_rows = 0;
+  this->m_nb_bands = 0;
+  this->m_next_band = 0;
+  this->m_bands_done = 0;
+  this->m_generation = 0;
+  this->m_stopping = false;
+
+  for (int i = 0; i < nb_workers; i++) {
+    this->m_workers.emplace_back(&RowPool::worker_func, this);
+  }
+}
+
+RowPool::~RowPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    this->m_stopping = true;
+  }
+  this->m_work_cond.notify_all();
+  for (std::thread& worker : this->m_workers) {
+    worker.join();
+  }
+}
+
+int RowPool::get_nb_workers() const noexcept {
+  return static_cast<int>(this->m_workers.size());
+}
+
+void RowPool::run(int nb_rows, int min_band_rows, const std::function<void(int, int)>& band_fn) {
+  if (nb_rows <= 0) return;
+  min_band_rows = std::max(min_band_rows, 1);
+  const int nb_bands = std::min(this->get_nb_workers() + 1, nb_rows / min_band_rows);
+  if (nb_bands <= 1) {
+    band_fn(0, nb_rows);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    this->m_band_fn = &band_fn;
+    this->m_nb_rows = nb_rows;
+    this->m_nb_bands = nb_bands;
+    this->m_next_band = 0;
+    this->m_bands_done = 0;
+    this->m_generation++;
+  }
+  this->m_work_cond.notify_all();
+
+  this->work_bands();
+  std::unique_lock<std::mutex> lock(this->m_mutex);
+  this->m_done_cond.wait(lock, [this] { return this->m_bands_done == this->m_nb_bands; });
+  this->m_band_fn = nullptr;
+}
+
+void RowPool::work_bands() {
+  std::unique_lock<std::mutex> lock(this->m_mutex);
+  while (this->m_band_fn != nullptr && this->m_next_band < this->m_nb_bands) {
+    const std::function<void(int, int)>& band_fn = *this->m_band_fn;
+    const int band = this->m_next_band++;
+    const int begin = static_cast<int>(static_cast<long long>(band) * this->m_nb_rows / this->m_nb_bands);
+    const int end = static_cast<int>(static_cast<long long>(band + 1) * this->m_nb_rows / this->m_nb_bands);
+    lock.unlock();
+    band_fn(begin, end);
+    lock.lock();
+    if (++this->m_bands_done == this->m_nb_bands) this->m_done_cond.notify_all();
+  }
+}
+
+void RowPool::worker_func() {
+  unsigned int seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(this->m_mutex);
+      this->m_work_cond.wait(lock, [this, seen_generation] {
+        return this->m_stopping || this->m_generation != seen_generation;
+      });
+      if (this->m_stopping) return;
+      seen_generation = this->m_generation;
+    }
+    this->work_bands();
+  }
+}